@@ -0,0 +1,27 @@
+#!/usr/bin/env bash
+
+set -e
+
+# sweeps thread counts for shawBench, pinning threads to cores
+# usage: ./run_shaw_bench.sh <path-to-shawBench> "<thread counts>" [extra shawBench args]
+# e.g.:  ./run_shaw_bench.sh ./build/shawBench "1 2 4 8" --nr 200 --nth 800 --fsizes 1 4 8
+
+EXE=$1
+THREADS=$2
+shift 2
+
+export OMP_PROC_BIND=spread
+export OMP_PLACES=threads
+
+for nt in ${THREADS}; do
+    echo "--- running with ${nt} threads ---"
+    OMP_NUM_THREADS=${nt} ${EXE} "$@" \
+		   --outfile shaw_bench_t${nt}.csv --kokkos-threads=${nt}
+done
+
+# merge all results into a single csv with a single header
+head -n 1 shaw_bench_t$(echo ${THREADS} | awk '{print $1}').csv > shaw_bench_all.csv
+for nt in ${THREADS}; do
+    tail -n +2 shaw_bench_t${nt}.csv >> shaw_bench_all.csv
+done
+echo "merged results in shaw_bench_all.csv"
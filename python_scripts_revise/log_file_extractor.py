@@ -6,29 +6,30 @@ import shutil, subprocess
 from constants import *
 
 # impl
-def _extractMemBw(logFilePath, key):
-  reg = re.compile(r''+key+'Bandwidth(\D+)\d+.\d+')
+def _extractValueOrNone(logFilePath, key):
+  # value printed as "<key><unit> = <value>", None if printed as n/a:
+  # the persistent time loop does not time steps nor data collection
+  reg = re.compile(key + r'\S* =\s*(n/a|[-+]?\d+\.?\d*(?:[eE][-+]?\d+)?)')
   file1 = open(logFilePath, 'r')
   strings = re.search(reg, file1.read())
   file1.close()
   assert(strings)
-  return np.float64(strings.group().split()[2])
+  if strings.group(1) == 'n/a':
+    return None
+  return np.float64(strings.group(1))
+
+def _extractMemBw(logFilePath, key):
+  return _extractValueOrNone(logFilePath, key+'Bandwidth')
 
 def _extractGflops(logFilePath, key):
-  reg = re.compile(r''+key+'GFlop(\D+)\d+.\d+')
-  file1 = open(logFilePath, 'r')
-  strings = re.search(reg, file1.read())
-  file1.close()
-  assert(strings)
-  return np.float64(strings.group().split()[2])
+  return _extractValueOrNone(logFilePath, key+'GFlop')
 
 def _extractPerfTime(logFilePath, key):
-  reg = re.compile(r''+key+'Time(\D+)\d+.\d+')
-  file1 = open(logFilePath, 'r')
-  strings = re.search(reg, file1.read())
-  file1.close()
-  assert(strings)
-  return np.float64(strings.group().split()[2])
+  return _extractValueOrNone(logFilePath, key+'Time')
+
+def _toArray(values):
+  # values that were not measured become nan
+  return np.array([np.nan if v is None else v for v in values], dtype=np.float64)
 
 # usable
 def extractNumDofs(logFilePath, dof):
@@ -56,19 +57,19 @@ def extractMemBw(logFilePath):
   aveV = _extractMemBw(logFilePath, "ave")
   minV = _extractMemBw(logFilePath, "min")
   maxV = _extractMemBw(logFilePath, "max")
-  return np.array([aveV, minV, maxV])
+  return _toArray([aveV, minV, maxV])
 
 def extractGflops(logFilePath):
   aveV = _extractGflops(logFilePath, "ave")
   minV = _extractGflops(logFilePath, "min")
   maxV = _extractGflops(logFilePath, "max")
-  return np.array([aveV, minV, maxV])
+  return _toArray([aveV, minV, maxV])
 
 def extractPerfTimes(logFilePath):
   aveV = _extractPerfTime(logFilePath, "ave")
   minV = _extractPerfTime(logFilePath, "min")
   maxV = _extractPerfTime(logFilePath, "max")
-  return np.array([aveV, minV, maxV])
+  return _toArray([aveV, minV, maxV])
 
 def extractLoopTime(logFilePath):
   reg = re.compile(r'loopTime(\D+)\d+.\d+')
@@ -79,12 +80,8 @@ def extractLoopTime(logFilePath):
   return np.float64(strings.group().split()[2])
 
 def extractDataIoTime(logFilePath):
-  reg = re.compile(r'dataCollectionTime(\D+)\d+.\d+')
-  file1 = open(logFilePath, 'r')
-  strings = re.search(reg, file1.read())
-  file1.close()
-  assert(strings)
-  return np.float64(strings.group().split()[2])
+  # None for runs that do not time the data collection
+  return _extractValueOrNone(logFilePath, 'dataCollectionTime')
 
 def extractRomJacobianTime(logFilePath):
   reg = re.compile(r'romJac time(\D+)\d+.\d+')
@@ -121,3 +118,14 @@ def extractRankTwoFlag(logFilePath):
     return True
   else:
     return False
+
+def loadPerfReport(reportFilePath):
+  # json report written when the performance section is in the input file
+  import json
+  with open(reportFilePath, 'r') as f:
+    return json.load(f)
+
+def extractPhaseLatencies(reportFilePath, phase):
+  # returns [p50, p99, max] in seconds of a phase, e.g. "step" or "velocityUpdate"
+  p = loadPerfReport(reportFilePath)['phases'][phase]
+  return np.array([p['p50'], p['p99'], p['max']])
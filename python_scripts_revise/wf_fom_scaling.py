@@ -201,7 +201,8 @@ def extractData(workDir, meshList, threads, dataFileFullPath, fSizes):
         data[iR][10:13] = extractPerfTimes(fomLogFile)
         # get loop times
         data[iR][13] = extractLoopTime(fomLogFile)
-        data[iR][14] = extractDataIoTime(fomLogFile)
+        ioTime = extractDataIoTime(fomLogFile)
+        data[iR][14] = np.nan if ioTime is None else ioTime
         # get final time
         data[iR][15] = extractFinalTime(fomLogFile)
         # get numSteps
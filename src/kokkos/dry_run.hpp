@@ -0,0 +1,268 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// dry_run.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef SHAXIPP_KOKKOS_DRY_RUN_HPP_
+#define SHAXIPP_KOKKOS_DRY_RUN_HPP_
+
+#include "fom_complexities.hpp"
+#include "rom_run_rank_one.hpp"
+#include "output_buffer_pool.hpp"
+
+namespace kokkosapp{
+
+/*
+ * Predicts memory and run time of the problem described by the
+ * input file using only the parser and mesh_info.dat, nothing
+ * is allocated. Sizes follow the allocations done by ShWavePP,
+ * the problem classes, observer, seismogram and forcing.
+ *
+ * The jacobian nnz are those of the structured meshes built by
+ * our mesh generator: a vp row has 2 radial and 2 angular entries,
+ * reduced to 1 at the boundaries, and every sp row has 2 entries.
+ *
+ * The step time is the modeled memory traffic of a step divided by
+ * the STREAM bandwidth set in the performance section, so it is a
+ * lower bound for a memory-bound step.
+ *
+ * Returns the predicted memory in bytes of each component.
+ */
+template <typename types_t, typename parser_t, typename mesh_info_t>
+std::vector<std::pair<std::string, double>> dryRun(const parser_t & parser, const mesh_info_t & meshInfo)
+{
+  using sc_t	 = typename types_t::scalar_type;
+  using ord_t	 = typename types_t::jacobian_ord_type;
+  using size_type = typename types_t::jacobian_d_type::size_type;
+  using mesh_ord_t = typename mesh_info_t::ordinal_type;
+
+  // if device is host, mirrors do not allocate
+  constexpr bool deviceIsHost =
+    std::is_same<typename types_t::device_mem_space, Kokkos::HostSpace>::value;
+  const double mirrorFactor = deviceIsHost ? 1. : 2.;
+
+  const std::size_t nVp = meshInfo.getNumVpPts();
+  const std::size_t nSp = meshInfo.getNumSpPts();
+  const std::size_t nr  = meshInfo.getNumPtsAlongR();
+  const std::size_t nth = meshInfo.getNumPtsAlongTheta();
+  const std::size_t numSteps = parser.getNumSteps();
+
+  const std::size_t nnzVp = 2*nth*(nr-1) + 2*nr*(nth-1);
+  const std::size_t nnzSp = 2*nSp;
+
+  const bool romOn = parser.enableRom();
+  const std::size_t fSize = (!romOn and parser.rank2Enabled()) ? parser.getForcingSize() : 1;
+
+  // number of samples and of runs (batches of fSize samples for rank-2)
+  std::size_t numSamples = 1;
+  if (parser.multiForcing() and !romOn){
+    numSamples = parser.viewDepths().size() * parser.viewPeriods().size()
+      * parser.viewAngles().size() * parser.viewDelays().size();
+  }
+
+  // rank-1 multi-forcing samples can run as an ensemble: each member has
+  // its own states, forcing, observer and seismogram, and a run is a group
+  std::size_t ensembleSize = 1;
+  if (!romOn and !parser.rank2Enabled() and parser.multiForcing() and parser.getEnsembleSize() > 1){
+    ensembleSize = std::min<std::size_t>(parser.getEnsembleSize(), numSamples);
+  }
+  const std::size_t samplesPerRun = fSize*ensembleSize;
+  const std::size_t numRuns = (numSamples + samplesPerRun - 1)/samplesPerRun;
+
+  std::cout << std::endl;
+  std::cout << "*** Dry run: predicting memory and time ***" << std::endl;
+  std::cout << "formulation = "
+	    << (romOn ? "rom" : (parser.rank2Enabled() ? "fom rank-2" : "fom rank-1"))
+	    << std::endl;
+  std::cout << "forcingSize = " << fSize << std::endl;
+  if (ensembleSize > 1){
+    std::cout << "ensembleSize = " << ensembleSize << std::endl;
+  }
+  if (!romOn and parser.autoForcingSize()){
+    std::cout << "warning: forcingSize is auto, it is only known after calibration" << std::endl;
+  }
+  std::cout << "numSamples = " << numSamples << std::endl;
+  std::cout << "numRuns = " << numRuns << std::endl;
+  if (numSamples % samplesPerRun != 0){
+    std::cout << "last run has " << numSamples % samplesPerRun << " samples" << std::endl;
+  }
+
+  // memory in bytes of each component
+  std::vector<std::pair<std::string, double>> mem;
+
+  // mesh graphs, labels and coordinates are kept on host,
+  // graphs use the jacobian ordinal type
+  mem.emplace_back("mesh",
+		   1.*(nVp*5 + nSp*3)*sizeof(ord_t) + 1.*nSp*sizeof(mesh_ord_t)
+		   + 2.*(nVp + nSp)*sizeof(sc_t));
+
+  // inverse density at vp and shear modulus at sp points
+  mem.emplace_back("material", mirrorFactor*(nVp + nSp)*sizeof(sc_t));
+
+  // the shared-sparsity operator keeps the two columns of each stress row,
+  // one value per entry for each operator and the stress rows sorted by color
+  if (!romOn and parser.getOperatorBackend() == operatorBackendKind::sharedSparsity){
+    mem.emplace_back("jacobians",
+		     1.*nnzSp*(2*sizeof(sc_t) + sizeof(ord_t)) + 1.*nSp*sizeof(ord_t));
+  }
+  else{
+    mem.emplace_back("jacobians",
+		     1.*(nnzVp + nnzSp)*(sizeof(sc_t) + sizeof(ord_t))
+		     + 1.*(nVp + nSp + 2)*sizeof(size_type));
+  }
+
+  // with the rom, the observer and states have the size of the rom
+  const std::size_t nVpState = romOn ? parser.getRomSize(dofId::vp) : nVp;
+  const std::size_t nSpState = romOn ? parser.getRomSize(dofId::sp) : nSp;
+  // an ensemble allocates its states next to those of the problem
+  const std::size_t numStateColumns = ensembleSize > 1 ? 1 + ensembleSize : fSize;
+  mem.emplace_back("states", mirrorFactor*(nVpState + nSpState)*numStateColumns*sizeof(sc_t));
+
+  // rank-1 keeps the full time series on host and a vector over the mesh,
+  // rank-2 only the current value of each realization
+  if (fSize == 1){
+    mem.emplace_back("forcing", 1.*(numSteps + nVp)*ensembleSize*sizeof(sc_t));
+  }
+  else{
+    mem.emplace_back("forcing", mirrorFactor*fSize*(sizeof(sc_t) + sizeof(std::size_t)));
+  }
+
+  // bytes of a single observer and seismogram
+  double observerBytes = 0.;
+  double seismoBytes = 0.;
+  if (parser.enableSnapshotMatrix()){
+    const auto freqVp = parser.getSnapshotFreq(dofId::vp);
+    const auto freqSp = parser.getSnapshotFreq(dofId::sp);
+    if (numSteps % freqVp != 0 or numSteps % freqSp != 0){
+      std::cout << "warning: snapshot frequency is not a divisor of steps" << std::endl;
+    }
+    // the region and gid list need the grid, so restricted
+    // snapshots are only bounded using the stride
+    const std::size_t stride = parser.restrictSnapshots() ? parser.getSnapshotStride() : 1;
+    if (parser.restrictSnapshots()){
+      std::cout << "note: snapshots are restricted, observer memory is an upper bound" << std::endl;
+    }
+    const double nVpSnap = (nVpState + stride - 1)/stride;
+    const double nSpSnap = (nSpState + stride - 1)/stride;
+    observerBytes = (nVpSnap*(numSteps/freqVp) + nSpSnap*(numSteps/freqSp))
+      * fSize * sizeof(sc_t);
+  }
+
+  if (parser.enableSeismogram() and !romOn){
+    const auto freq = parser.getSeismoFreq();
+    if (numSteps % freq != 0){
+      std::cout << "warning: seismogram frequency is not a divisor of steps" << std::endl;
+    }
+    seismoBytes = 1.*parser.getSeismoReceiversAnglesDeg().size()
+      * (numSteps/freq) * fSize * sizeof(sc_t);
+  }
+
+  // an ensemble has one observer and seismogram per member, while rank-2
+  // and rank-1 multi-forcing runs have as many as the output buffers
+  std::size_t numOutputCopies = ensembleSize;
+  if (!romOn and ensembleSize == 1 and (parser.rank2Enabled() or parser.multiForcing())){
+    numOutputCopies = numOutputBuffers(parser,
+				       static_cast<std::size_t>(observerBytes + seismoBytes),
+				       parser.enableCheckpoint());
+  }
+  if (parser.enableSnapshotMatrix()){
+    mem.emplace_back("observer", observerBytes*numOutputCopies);
+  }
+  if (parser.enableSeismogram() and !romOn){
+    mem.emplace_back("seismogram", seismoBytes*numOutputCopies);
+  }
+
+  if (romOn){
+    const double romVp = nVpState;
+    const double romSp = nSpState;
+    mem.emplace_back("romBasis", mirrorFactor*(nVp*romVp + nSp*romSp)*sizeof(sc_t));
+    mem.emplace_back("romOperators", 2.*romVp*romSp*sizeof(sc_t));
+  }
+
+  constexpr double bytesToGB = 1./(1024.*1024.*1024.);
+  double totalBytes = 0.;
+  for (const auto & it : mem){
+    std::cout << "predictedMem: " << it.first << " [GB] = " << it.second*bytesToGB << std::endl;
+    totalBytes += it.second;
+  }
+  std::cout << "predictedMem: total [GB] = " << totalBytes*bytesToGB << std::endl;
+
+  // modeled traffic and flops of one step
+  double memCostMB = 0.;
+  double flopsCost = 0.;
+  if (romOn){
+    complexityRankOneForcing<sc_t>(nVpState, nSpState, memCostMB, flopsCost);
+  }
+  else if (fSize == 1){
+    // an ensemble step costs as much as one rank-1 step per member
+    complexityFomRankOne<sc_t, ord_t>(nVp, nSp, nnzVp, nnzSp, memCostMB, flopsCost);
+    memCostMB *= ensembleSize;
+    flopsCost *= ensembleSize;
+  }
+  else{
+    complexityFomRankTwo<sc_t, ord_t>(nVp, nSp, fSize, nnzVp, nnzSp, memCostMB, flopsCost);
+  }
+  std::cout << "memMB = " << memCostMB << std::endl;
+  std::cout << "flops = " << flopsCost << std::endl;
+
+  const double bandwidthGBs = parser.getStreamBandwidth();
+  if (bandwidthGBs > 0.){
+    const double stepTimeSec = memCostMB/1024./bandwidthGBs;
+    const double runTimeSec  = stepTimeSec*numSteps;
+    std::cout << "predictedStepTime(ms) = " << stepTimeSec*1000. << std::endl;
+    std::cout << "predictedRunTime(s) = " << runTimeSec << std::endl;
+    std::cout << "predictedCampaignTime(s) = " << runTimeSec*numRuns << std::endl;
+  }
+  else{
+    std::cout << "set streamBandwidthGBs in the performance section to predict times"
+	      << std::endl;
+  }
+
+  return mem;
+}
+
+}//end namespace kokkosapp
+#endif
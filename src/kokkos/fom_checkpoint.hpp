@@ -0,0 +1,286 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// fom_checkpoint.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef FOM_CHECKPOINT_HPP_
+#define FOM_CHECKPOINT_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace kokkosapp{
+
+/*
+ * Binary checkpoint of a FOM run. Each checkpoint file contains:
+ *   - a header: magic, sample id, step, time, dt, numSteps, extents
+ *     of the states, the size of the forcing sets and a fingerprint of the forcing
+ *   - the velocity and stress states
+ *   - the observer and seismogram counters and the data collected so far
+ *
+ * A checkpoint is written to a temporary file which is then renamed,
+ * so a run killed while writing never leaves a partial checkpoint behind.
+ *
+ * Restart is bit-for-bit: the time loop only depends on the states,
+ * the step index and on the forcing, which is stateless in time.
+ */
+template <typename sc_t>
+class FomCheckpoint
+{
+  static constexpr char magic_[9] = "SHAWCKP2";
+
+  struct header_t
+  {
+    std::uint64_t sampleID = 0;
+    std::uint64_t step = 0;
+    std::uint64_t numSteps = 0;
+    std::uint64_t nVp = 0;
+    std::uint64_t nSp = 0;
+    std::uint64_t fSize = 0;
+    // num of realizations per set used to split the samples, the last set can be smaller
+    std::uint64_t setSize = 1;
+    std::uint64_t forcingFingerprint = 0;
+    sc_t time = {};
+    sc_t dt = {};
+  };
+
+  std::size_t interval_ = 0;
+  std::string fileName_ = {};
+  // realizations per set, sample ids of rank-2 runs are set indices
+  std::size_t setSize_ = 1;
+
+  // restart info: restartPending_ becomes false once the restart has been used
+  bool restartPending_ = false;
+  std::string restartFileName_ = {};
+  header_t restartHeader_ = {};
+
+public:
+  // a default-constructed checkpoint does nothing
+  FomCheckpoint() = default;
+
+  template <typename parser_t>
+  FomCheckpoint(const parser_t & parser)
+    : interval_(parser.getCheckpointInterval()),
+      fileName_(parser.getCheckpointFileName()),
+      restartPending_(parser.enableRestart()),
+      restartFileName_(parser.getRestartFileName())
+  {
+    if (restartPending_){
+      std::ifstream is(restartFileName_, std::ios::in | std::ios::binary);
+      if (!is){
+	throw std::runtime_error("Restart file: " + restartFileName_ + " not found");
+      }
+      readHeader(is, restartHeader_);
+      std::cout << "Restarting from checkpoint " << restartFileName_
+		<< " at sample = " << restartHeader_.sampleID
+		<< " step = " << restartHeader_.step << std::endl;
+    }
+  }
+
+  bool enabled() const{
+    return interval_ > 0;
+  }
+
+  bool restartPending() const{
+    return restartPending_;
+  }
+
+  // set size of the run the restart checkpoint was written by
+  std::size_t getRestartSetSize() const{
+    return restartHeader_.setSize;
+  }
+
+  /*
+   * must be called before any sample is skipped: sets completed before
+   * the restart are skipped by index, which is only valid with the
+   * same split of the samples as the run that wrote the checkpoint
+   */
+  void setSetSize(const std::size_t setSize)
+  {
+    if (restartPending_ and setSize != restartHeader_.setSize){
+      throw std::runtime_error
+	("Checkpoint " + restartFileName_ + " was written with forcingSize = "
+	 + std::to_string(restartHeader_.setSize) + ", cannot restart with "
+	 + std::to_string(setSize));
+    }
+    setSize_ = setSize;
+  }
+
+  // true if the sample was completed before the checkpoint we restart from was written
+  bool isCompletedBeforeRestart(const std::size_t sampleID) const{
+    return restartPending_ and sampleID < restartHeader_.sampleID;
+  }
+
+  bool isDue(const std::size_t step, const std::size_t numSteps) const{
+    // no need to checkpoint at the last step since the run is done
+    return enabled() and step % interval_ == 0 and step < numSteps;
+  }
+
+  /*
+   * if a restart is pending for this sample, load states and collected
+   * data from the checkpoint and return the step it was written at.
+   * Otherwise returns 0 and leaves everything untouched.
+   */
+  template <typename forcing_t, typename observer_t, typename seismo_t, typename state_d_t>
+  std::size_t restore(const std::size_t sampleID,
+		      const std::size_t numSteps,
+		      const sc_t dt,
+		      const forcing_t & forcingObj,
+		      observer_t & observerObj,
+		      seismo_t & seismoObj,
+		      state_d_t xVp_d,
+		      state_d_t xSp_d)
+  {
+    if (!restartPending_ or sampleID != restartHeader_.sampleID){
+      return 0;
+    }
+
+    std::ifstream is(restartFileName_, std::ios::in | std::ios::binary);
+    header_t h;
+    readHeader(is, h);
+
+    // make sure the checkpoint belongs to this run
+    const bool match =
+      h.numSteps == numSteps and h.dt == dt and
+      h.nVp == xVp_d.extent(0) and h.nSp == xSp_d.extent(0) and
+      h.fSize == fSizeOf(xVp_d) and h.setSize == setSize_ and
+      h.forcingFingerprint == forcingObj.fingerprint();
+    if (!match){
+      throw std::runtime_error
+	("Checkpoint " + restartFileName_ + " does not match the current run setup");
+    }
+
+    readState(is, xVp_d);
+    readState(is, xSp_d);
+    observerObj.readCheckpoint(is);
+    seismoObj.readCheckpoint(is);
+
+    restartPending_ = false;
+    std::cout << "Resuming sample " << sampleID << " from step " << h.step << std::endl;
+    return h.step;
+  }
+
+  template <typename forcing_t, typename observer_t, typename seismo_t, typename state_d_t>
+  void write(const std::size_t sampleID,
+	     const std::size_t step,
+	     const std::size_t numSteps,
+	     const sc_t time,
+	     const sc_t dt,
+	     const forcing_t & forcingObj,
+	     const observer_t & observerObj,
+	     const seismo_t & seismoObj,
+	     const state_d_t xVp_d,
+	     const state_d_t xSp_d) const
+  {
+    header_t h;
+    h.sampleID = sampleID;
+    h.step = step;
+    h.numSteps = numSteps;
+    h.nVp = xVp_d.extent(0);
+    h.nSp = xSp_d.extent(0);
+    h.fSize = fSizeOf(xVp_d);
+    h.setSize = setSize_;
+    h.forcingFingerprint = forcingObj.fingerprint();
+    h.time = time;
+    h.dt = dt;
+
+    const std::string tmpFileName = fileName_ + ".tmp";
+    {
+      std::ofstream os(tmpFileName, std::ios::out | std::ios::binary | std::ios::trunc);
+      os.write(magic_, sizeof(magic_)-1);
+      impl::write_pod_to_binary(os, h);
+      writeState(os, xVp_d);
+      writeState(os, xSp_d);
+      observerObj.writeCheckpoint(os);
+      seismoObj.writeCheckpoint(os);
+      if (!os){
+	throw std::runtime_error("Failed writing checkpoint to " + tmpFileName);
+      }
+    }
+    if (std::rename(tmpFileName.c_str(), fileName_.c_str()) != 0){
+      throw std::runtime_error("Failed renaming checkpoint " + tmpFileName);
+    }
+  }
+
+private:
+  static void readHeader(std::istream & is, header_t & h)
+  {
+    char magic[sizeof(magic_)] = {};
+    is.read(magic, sizeof(magic_)-1);
+    if (!is or std::strncmp(magic, magic_, sizeof(magic_)-1) != 0){
+      throw std::runtime_error("Invalid checkpoint file");
+    }
+    impl::read_pod_from_binary(is, h);
+  }
+
+  template <typename state_d_t>
+  static std::size_t fSizeOf(const state_d_t & x){
+    return (state_d_t::traits::rank == 1) ? 1 : x.extent(1);
+  }
+
+  template <typename state_d_t>
+  static void writeState(std::ostream & os, const state_d_t & x_d)
+  {
+    auto x_h = Kokkos::create_mirror_view(x_d);
+    Kokkos::deep_copy(x_h, x_d);
+    impl::write_array_to_binary(os, x_h.data(), x_h.span());
+  }
+
+  template <typename state_d_t>
+  static void readState(std::istream & is, state_d_t & x_d)
+  {
+    auto x_h = Kokkos::create_mirror_view(x_d);
+    impl::read_array_from_binary(is, x_h.data(), x_h.span());
+    Kokkos::deep_copy(x_d, x_h);
+  }
+};
+
+template <typename sc_t>
+constexpr char FomCheckpoint<sc_t>::magic_[9];
+
+}//end namespace kokkosapp
+#endif
@@ -52,23 +52,19 @@
 namespace kokkosapp{
 
 /*
-  rank-1 forcing
+  rank-1 forcing, from the sizes only so that it can also
+  be used to predict the cost before anything is allocated
 */
-template <typename sc_t, typename state_d_t, typename app_t, typename forcing_t>
-typename std::enable_if< is_kokkos_1dview<state_d_t>::value >::type
-complexityFom(const state_d_t xVp,
-	      const state_d_t xSp,
-	      const app_t & fomObj,
-	      const forcing_t & forcingObj,
-	      double & memCostMB,
-	      double & flopsCost)
+template <typename sc_t, typename ord_t>
+void complexityFomRankOne(const std::size_t nVp,
+			  const std::size_t nSp,
+			  const std::size_t nnz_j_vp,
+			  const std::size_t nnz_j_sp,
+			  double & memCostMB,
+			  double & flopsCost)
 {
-  using ord_t = typename app_t::jacobian_ord_type;
   using comp_t = Complexity<sc_t>;
 
-  const auto nVp = xVp.extent(0);
-  const auto nSp = xSp.extent(0);
-
   std::array<double, 3> memMB = {};
   std::array<double, 3> flops = {};
 
@@ -76,7 +72,6 @@ complexityFom(const state_d_t xVp,
   // forcingObj.complexityOfEvaluateMethod(memMB[0], flops[0]);
 
   // spmv: xVp = xVp + dt * Jvp * xSp
-  const auto nnz_j_vp = fomObj.getJacobianNNZ(dofId::vp);
   comp_t::template spmv<ord_t>(nnz_j_vp, nVp, memMB[0], flops[0]);
 
   // mult: xVp = xVp + dt * rhoInv * f
@@ -84,19 +79,14 @@ complexityFom(const state_d_t xVp,
   comp_t::mult_beta_one(nVp, memMB[1], flops[1]);
 
   // spmv: xSp = xSp + dt * Jsp * xVp
-  const auto nnz_j_sp = fomObj.getJacobianNNZ(dofId::sp);
   comp_t::template spmv<ord_t>(nnz_j_sp, nSp, memMB[2], flops[2]);
 
   memCostMB = std::accumulate(memMB.begin(), memMB.end(), 0.);
   flopsCost = std::accumulate(flops.begin(), flops.end(), 0.);
 }
 
-
-/*
-   rank-2 forcing
-*/
 template <typename sc_t, typename state_d_t, typename app_t, typename forcing_t>
-typename std::enable_if< is_kokkos_2dview<state_d_t>::value >::type
+typename std::enable_if< is_kokkos_1dview<state_d_t>::value >::type
 complexityFom(const state_d_t xVp,
 	      const state_d_t xSp,
 	      const app_t & fomObj,
@@ -105,12 +95,26 @@ complexityFom(const state_d_t xVp,
 	      double & flopsCost)
 {
   using ord_t = typename app_t::jacobian_ord_type;
-  using comp_t = Complexity<sc_t>;
+  complexityFomRankOne<sc_t, ord_t>(xVp.extent(0), xSp.extent(0),
+				    fomObj.getJacobianNNZ(dofId::vp),
+				    fomObj.getJacobianNNZ(dofId::sp),
+				    memCostMB, flopsCost);
+}
 
-  assert( xVp.extent(1) == xSp.extent(1) );
-  const auto nVp    = xVp.extent(0);
-  const auto nSp    = xSp.extent(0);
-  const auto fSize = xVp.extent(1);
+
+/*
+   rank-2 forcing
+*/
+template <typename sc_t, typename ord_t>
+void complexityFomRankTwo(const std::size_t nVp,
+			  const std::size_t nSp,
+			  const std::size_t fSize,
+			  const std::size_t nnz_j_vp,
+			  const std::size_t nnz_j_sp,
+			  double & memCostMB,
+			  double & flopsCost)
+{
+  using comp_t = Complexity<sc_t>;
 
   std::array<double, 3> memMB = {};
   std::array<double, 3> flops = {};
@@ -119,7 +123,6 @@ complexityFom(const state_d_t xVp,
   // forcingObj.complexityOfEvaluateMethod(memMB[0], flops[0]);
 
   // xVp = xVp + dt * Jvp * xSp
-  const auto nnz_j_vp = fomObj.getJacobianNNZ(dofId::vp);
   comp_t::template spmm<ord_t>(nnz_j_vp, nVp, fSize, memMB[0], flops[0]);
 
   // for rank-2 we do a parallel for over number of forcing realizations
@@ -129,12 +132,29 @@ complexityFom(const state_d_t xVp,
   flops[1] = 3.*fSize;
 
   // spmm: xSp = xSp + dt * Jsp * xVp
-  const auto nnz_j_sp = fomObj.getJacobianNNZ(dofId::sp);
   comp_t::template spmm<ord_t>(nnz_j_sp, nSp, fSize, memMB[2], flops[2]);
 
   memCostMB = std::accumulate(memMB.begin(), memMB.end(), 0.);
   flopsCost = std::accumulate(flops.begin(), flops.end(), 0.);
 }
 
+template <typename sc_t, typename state_d_t, typename app_t, typename forcing_t>
+typename std::enable_if< is_kokkos_2dview<state_d_t>::value >::type
+complexityFom(const state_d_t xVp,
+	      const state_d_t xSp,
+	      const app_t & fomObj,
+	      const forcing_t & forcingObj,
+	      double & memCostMB,
+	      double & flopsCost)
+{
+  using ord_t = typename app_t::jacobian_ord_type;
+
+  assert( xVp.extent(1) == xSp.extent(1) );
+  complexityFomRankTwo<sc_t, ord_t>(xVp.extent(0), xSp.extent(0), xVp.extent(1),
+				    fomObj.getJacobianNNZ(dofId::vp),
+				    fomObj.getJacobianNNZ(dofId::sp),
+				    memCostMB, flopsCost);
+}
+
 }//end namespace kokkosapp
 #endif
@@ -0,0 +1,251 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// fom_operator_autotune.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef FOM_OPERATOR_AUTOTUNE_HPP_
+#define FOM_OPERATOR_AUTOTUNE_HPP_
+
+#include "fom_update_kernels.hpp"
+#include <sstream>
+
+namespace kokkosapp{
+
+template <typename jac_d_t>
+std::uint64_t hashOperatorSparsity(const jac_d_t & A, std::uint64_t seed)
+{
+  const auto rowMap_h  = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), A.graph.row_map);
+  const auto entries_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), A.graph.entries);
+  seed = fnv1aHashValue(A.numRows(), seed);
+  seed = fnv1aHashValue(A.numCols(), seed);
+  seed = fnv1aHash(rowMap_h.data(), rowMap_h.span()*sizeof(rowMap_h(0)), seed);
+  seed = fnv1aHash(entries_h.data(), entries_h.span()*sizeof(entries_h(0)), seed);
+  return seed;
+}
+
+// trial states used to time the backends, rank-1 specialize
+template <typename state_d_t>
+typename std::enable_if<is_kokkos_1dview<state_d_t>::value, state_d_t>::type
+createTrialState(const std::string & name, const std::size_t numRows, const std::size_t)
+{
+  return state_d_t(name, numRows);
+}
+
+// rank-2 specialize
+template <typename state_d_t>
+typename std::enable_if<is_kokkos_2dview<state_d_t>::value, state_d_t>::type
+createTrialState(const std::string & name, const std::size_t numRows, const std::size_t fSize)
+{
+  return state_d_t(name, numRows, fSize);
+}
+
+/*
+ * The fastest way to apply the jacobians depends on the mesh,
+ * the number of threads and the forcing size. This times a few
+ * steps (velocity plus stress operator) with each backend on the
+ * actual operators and returns the fastest.
+ * The decision is cached in a text file, one line per entry:
+ *
+ *	meshHash executionSpace numThreads forcingSize backend secondsPerStep
+ *
+ * so that later runs with the same key skip the trials.
+ */
+template <typename state_d_t, typename app_t>
+operatorBackendKind autotuneOperatorBackend(const app_t & appObj,
+					    const std::size_t fSize,
+					    const std::size_t numTrialSteps,
+					    const std::string & cacheFile)
+{
+  using sc_t = typename app_t::scalar_type;
+
+  const auto jacVp_d = appObj.viewJacobianDevice(dofId::vp);
+  const auto jacSp_d = appObj.viewJacobianDevice(dofId::sp);
+
+  std::uint64_t meshHash = 14695981039346656037ULL;
+  meshHash = hashOperatorSparsity(jacVp_d, meshHash);
+  meshHash = hashOperatorSparsity(jacSp_d, meshHash);
+  const std::string execSpace = Kokkos::DefaultExecutionSpace::name();
+  const int numThreads = Kokkos::DefaultExecutionSpace().concurrency();
+
+  std::cout << std::endl;
+  std::cout << "*** Autotuning operator backend ***" << std::endl;
+  std::cout << "meshHash = " << meshHash << " numThreads = " << numThreads
+	    << " forcingSize = " << fSize << std::endl;
+
+  // look for a cached decision, the last matching entry wins
+  operatorBackendKind cached = operatorBackendKind::unknown;
+  std::ifstream cacheIn(cacheFile);
+  std::string line;
+  while (std::getline(cacheIn, line)){
+    std::istringstream ss(line);
+    std::uint64_t h = {};
+    std::string es, name;
+    int nt = {};
+    std::size_t fs = {};
+    if ((ss >> h >> es >> nt >> fs >> name) and
+	h == meshHash and es == execSpace and nt == numThreads and fs == fSize){
+      cached = stringToOperatorBackendKind(name);
+    }
+  }
+  if (cached == operatorBackendKind::kokkosSparse or
+      cached == operatorBackendKind::crsFunctor){
+    std::cout << "using cached backend = " << operatorBackendKindToString(cached) << std::endl;
+    return cached;
+  }
+
+  auto xVp_d = createTrialState<state_d_t>("xVpTrial", jacVp_d.numRows(), fSize);
+  auto xSp_d = createTrialState<state_d_t>("xSpTrial", jacSp_d.numRows(), fSize);
+  const sc_t alpha = static_cast<sc_t>(1e-3);
+
+  const std::array<operatorBackendKind, 2> candidates =
+    {operatorBackendKind::kokkosSparse, operatorBackendKind::crsFunctor};
+
+  operatorBackendKind best = operatorBackendKind::kokkosSparse;
+  double bestTime = std::numeric_limits<double>::max();
+  Kokkos::Timer timer;
+  for (const auto backend : candidates)
+  {
+    // one untimed step to exclude first-touch and setup costs
+    applyOperator(backend, alpha, jacVp_d, xSp_d, xVp_d);
+    applyOperator(backend, alpha, jacSp_d, xVp_d, xSp_d);
+    Kokkos::fence();
+
+    timer.reset();
+    for (std::size_t iStep=0; iStep<numTrialSteps; ++iStep){
+      applyOperator(backend, alpha, jacVp_d, xSp_d, xVp_d);
+      applyOperator(backend, alpha, jacSp_d, xVp_d, xSp_d);
+    }
+    Kokkos::fence();
+    const double timePerStep = timer.seconds()/numTrialSteps;
+
+    std::cout << operatorBackendKindToString(backend) << " = "
+	      << timePerStep << " s/step" << std::endl;
+    if (timePerStep < bestTime){
+      bestTime = timePerStep;
+      best = backend;
+    }
+  }
+  std::cout << "selected backend = " << operatorBackendKindToString(best) << std::endl;
+
+  std::ofstream cacheOut(cacheFile, std::ios::app);
+  if (cacheOut){
+    cacheOut << meshHash << " " << execSpace << " " << numThreads << " "
+	     << fSize << " " << operatorBackendKindToString(best) << " "
+	     << std::setprecision(dblFmt) << bestTime << "\n";
+  }
+  else{
+    std::cout << "warning: cannot write autotune cache file " << cacheFile << std::endl;
+  }
+
+  return best;
+}
+
+/*
+ * Picks the number of forcing realizations of a rank-2 batch by timing
+ * a few steps (velocity plus stress operator) at widths 1,2,4,...
+ * up to maxSize, plus maxSize itself, and returning the width with
+ * the highest throughput, i.e. realizations times steps per second.
+ * Wider batches reuse each loaded nonzero for more realizations but
+ * stop paying off once the states no longer fit in cache.
+ */
+template <typename state_d_t, typename app_t>
+std::size_t calibrateForcingSize(const app_t & appObj,
+				 const operatorBackendKind backend,
+				 const std::size_t maxSize,
+				 const std::size_t numTrialSteps)
+{
+  using sc_t = typename app_t::scalar_type;
+
+  const auto jacVp_d = appObj.viewJacobianDevice(dofId::vp);
+  const auto jacSp_d = appObj.viewJacobianDevice(dofId::sp);
+  const sc_t alpha = static_cast<sc_t>(1e-3);
+
+  std::vector<std::size_t> candidates;
+  for (std::size_t w=1; w<maxSize; w*=2){
+    candidates.push_back(w);
+  }
+  candidates.push_back(maxSize);
+
+  std::cout << std::endl;
+  std::cout << "*** Calibrating forcing size ***" << std::endl;
+
+  std::size_t best = 1;
+  double bestThroughput = 0.;
+  Kokkos::Timer timer;
+  for (const auto w : candidates)
+  {
+    auto xVp_d = createTrialState<state_d_t>("xVpTrial", jacVp_d.numRows(), w);
+    auto xSp_d = createTrialState<state_d_t>("xSpTrial", jacSp_d.numRows(), w);
+
+    // one untimed step to exclude first-touch and setup costs
+    applyOperator(backend, alpha, jacVp_d, xSp_d, xVp_d);
+    applyOperator(backend, alpha, jacSp_d, xVp_d, xSp_d);
+    Kokkos::fence();
+
+    timer.reset();
+    for (std::size_t iStep=0; iStep<numTrialSteps; ++iStep){
+      applyOperator(backend, alpha, jacVp_d, xSp_d, xVp_d);
+      applyOperator(backend, alpha, jacSp_d, xVp_d, xSp_d);
+    }
+    Kokkos::fence();
+    const double timePerStep = timer.seconds()/numTrialSteps;
+    const double throughput  = w/timePerStep;
+
+    std::cout << "forcingSize = " << w
+	      << " timePerStep(s) = " << timePerStep
+	      << " realizationSteps/s = " << throughput << std::endl;
+    if (throughput > bestThroughput){
+      bestThroughput = throughput;
+      best = w;
+    }
+  }
+  std::cout << "selected forcingSize = " << best << std::endl;
+
+  return best;
+}
+
+}//end namespace kokkosapp
+#endif
@@ -63,6 +63,8 @@ public:
   using observer_type   = typename T::observer_type;
   using seismogram_type = typename T::seismogram_type;
   using mesh_ord_type	= typename mesh_info_type::ordinal_type;
+  using ensemble_state_d_type = typename T::ensemble_state_d_type;
+  using layout_type	= InterleavedStateLayout<scalar_type, typename T::jacobian_d_type>;
 
 private:
   // parser with inputs
@@ -84,6 +86,16 @@ private:
   state_d_type xSp_d_;
   // observer object to monitor the time evolution
   observer_type observerObj_;
+  // checkpoint/restart handler
+  FomCheckpoint<scalar_type> checkpoint_;
+  // machine-readable performance report
+  PerfReport perfReport_;
+  // true if samples are run with the persistent time loop
+  bool persistentTimeLoop_ = false;
+  // cell-interleaved placement of the states, only set with stateLayout: interleaved
+  std::unique_ptr<layout_type> interleavedLayout_;
+  // single-file output of all samples, only set with io: container
+  std::unique_ptr<SampleContainerWriter> container_;
 
 public:
   FomProblemRankOneForcing() = delete;
@@ -95,22 +107,97 @@ public:
       meshInfo_(meshInfo),
       nVp_(meshInfo_.getNumVpPts()),
       nSp_(meshInfo_.getNumSpPts()),
-      appObj_(meshInfo_, materialObj),
-      xVp_d_("xVp_d", nVp_),
-      xSp_d_("xSp_d", nSp_),
-      observerObj_(nVp_, nSp_, parser)
-  {}
+      appObj_(meshInfo_, materialObj, parser.hugePages()),
+      xVp_d_(allocateWithPlacement<state_d_type>(parser, "xVp_d", nVp_)),
+      xSp_d_(allocateWithPlacement<state_d_type>(parser, "xSp_d", nSp_)),
+      observerObj_(nVp_, nSp_, parser, 1, selectSnapshotRows(parser, appObj_)),
+      checkpoint_(parser),
+      perfReport_(parser)
+  {
+    perfReport_.addInfo("executionSpace", Kokkos::DefaultExecutionSpace::name());
+    perfReport_.addInfo("concurrency", Kokkos::DefaultExecutionSpace().concurrency());
+    perfReport_.addInfo("numVpPts", nVp_);
+    perfReport_.addInfo("numSpPts", nSp_);
+    perfReport_.addInfo("indexBits", 8*sizeof(typename T::jacobian_ord_type));
+    perfReport_.addInfo("forcingSize", 1);
+    perfReport_.addInfo("numSteps", parser.getNumSteps());
+    perfReport_.addInfo("dt", parser.getTimeStepSize());
+    for (const auto & it : appObj_.viewSetupTimes()){
+      perfReport_.accumulateTime(it.first, it.second);
+    }
+
+    selectOperatorBackend();
+
+    // the other time loops apply the CRS matrices directly
+    const bool sharedSparsity = appObj_.getOperatorBackend() == operatorBackendKind::sharedSparsity;
+    if (sharedSparsity and (parser.snapshotsZeroCopy() or parser.interleavedStates() or
+			    (parser.multiForcing() and parser.getEnsembleSize() > 1))){
+      throw std::runtime_error("operatorBackend: sharedSparsity only supports the kernels time loop");
+    }
+
+    // the stress coordinates are only written next to the snapshots
+    if (parser.leanMemory()){
+      appObj_.releaseAssemblyData(parser.enableSnapshotMatrix());
+    }
+
+    std::size_t footprintBytes = appObj_.footprintBytes();
+    if (parser.interleavedStates()){
+      checkInterleavedStatesSupported();
+      interleavedLayout_.reset(new layout_type(appObj_.viewJacobianDevice(dofId::vp),
+					       appObj_.viewJacobianDevice(dofId::sp)));
+      footprintBytes += interleavedLayout_->footprintBytes();
+    }
+    perfReport_.addInfo("stateLayout", parser.interleavedStates() ? "interleaved" : "separate");
+    perfReport_.addInfo("footprintMB", footprintBytes/1024./1024.);
+
+    if (parser.numaFirstTouch()){
+      reportPagePlacement();
+    }
+
+    if (parser.snapshotsZeroCopy() and (checkpoint_.enabled() or parser.enableRestart())){
+      throw std::runtime_error("Zero-copy snapshots cannot be used with checkpoint/restart");
+    }
+    if (parser.snapshotsZeroCopy() and parser.multiForcing() and parser.getEnsembleSize() > 1){
+      throw std::runtime_error("Zero-copy snapshots cannot be used with ensembleSize > 1");
+    }
+    // each team of an ensemble sweeps all the rows of its own column
+    if (parser.numaFirstTouch() and parser.multiForcing() and parser.getEnsembleSize() > 1){
+      throw std::runtime_error("numaFirstTouch cannot be used with ensembleSize > 1");
+    }
+
+    persistentTimeLoop_ = selectPersistentTimeLoop();
+    perfReport_.addInfo("timeLoop", timeLoopKindToString(persistentTimeLoop_ ?
+							  timeLoopKind::persistent :
+							  timeLoopKind::kernels));
+
+    if (parser.enableContainer()){
+      openContainer();
+    }
+  }
 
 public:
   void operator()()
   {
-    if (parser_.multiForcing())
+    if (parser_.multiForcing() and parser_.getEnsembleSize() > 1)
+    {
+      ensembleRun();
+    }
+    else if (parser_.multiForcing())
     {
       multiForcingRun();
     }
     else{
       singleForcingRun();
     }
+
+    // the index is written when the container is closed
+    if (container_){
+      container_->close();
+    }
+
+    if (perfReport_.enabled()){
+      perfReport_.write();
+    }
   }
 
 private:
@@ -126,10 +213,11 @@ private:
     checkCflCondition();
     checkDispersion(forcing.getMaxFreq());
 
+    addSampleToContainer(0, parser_.viewDepths()[0], parser_.viewPeriods()[0],
+			 parser_.viewAngles()[0], parser_.viewDelays()[0]);
+
     // run fom
-    runFom(parser_.getNumSteps(), parser_.getTimeStepSize(),
-	   appObj_, forcing, observerObj_, seismoObj,
-	   xVp_d_, xSp_d_);
+    runSample(forcing, observerObj_, seismoObj, 0);
 
     processCoordinates();
     processCollectedData(seismoObj);
@@ -139,8 +227,22 @@ private:
   {
     std::cout << "Doing FOM with sampling" << std::endl;
 
-    // seismogram
-    seismogram_type seismoObj(parser_, meshInfo_, appObj_);
+    // buffers to collect data, with asyncWrite a sample is written
+    // in the background while the next one runs with other buffers.
+    // The first observer is a shallow copy of observerObj_.
+    std::vector<observer_type> observers(1, observerObj_);
+    std::vector<seismogram_type> seismos;
+    seismos.emplace_back(parser_, meshInfo_, appObj_);
+    const auto numBuffers = numOutputBuffers(parser_,
+					     observers[0].sizeInBytes() + seismos[0].sizeInBytes(),
+					     checkpoint_.enabled());
+    for (std::size_t k=1; k<numBuffers; ++k){
+      observers.emplace_back(nVp_, nSp_, parser_, 1, observerObj_.viewSnapshotRows());
+      seismos.emplace_back(parser_, meshInfo_, appObj_);
+    }
+    OutputBufferPool<observer_type, seismogram_type> buffers(std::move(observers),
+							     std::move(seismos),
+							     perfReport_);
 
     // create vector of signals using target samples
     const auto & depths  = parser_.viewDepths();
@@ -166,30 +268,220 @@ private:
 	{
 	  for (const auto & idel : delays)
 	  {
+	    // samples completed before the restart point are not rerun
+	    if (checkpoint_.isCompletedBeforeRestart(iSample)){
+	      ++iSample;
+	      continue;
+	    }
+
 	    Signal<scalar_type> signal(parser_.getSourceSignalKind(), idel, iT);
 
 	    forcing_type forcing(signal, parser_, meshInfo_, appObj_, iD, ia);
 
 	    // reset observer and seismogram
-	    observerObj_.prepForNewRun(iSample);
-	    seismoObj.prepForNewRun(iSample);
+	    auto & observerObj = buffers.observer();
+	    auto & seismoObj   = buffers.seismogram();
+	    observerObj.prepForNewRun(iSample, iSample);
+	    seismoObj.prepForNewRun(iSample, iSample);
+	    addSampleToContainer(iSample, iD, iT, ia, idel);
 
 	    // run fom
-	    runFom(parser_.getNumSteps(), parser_.getTimeStepSize(),
-		   appObj_, forcing, observerObj_, seismoObj,
-		   xVp_d_, xSp_d_);
+	    runSample(forcing, observerObj, seismoObj, iSample);
 
-	    processCollectedData(seismoObj, iSample);
+	    buffers.writeAndAdvance([this](const observer_type & o, const seismogram_type & s){
+				      return writeCollectedData(o, s);
+				    });
 	    ++iSample;
 	  }
 	}
       }
     }
 
+    buffers.waitAll();
+
     // coordinates only need to be written once
     processCoordinates();
   }
 
+  void selectOperatorBackend()
+  {
+    auto backend = parser_.getOperatorBackend();
+    if (parser_.autotuneOperatorBackend()){
+      ProfilingRegion region("shaw::autotune");
+      const auto startTime = std::chrono::high_resolution_clock::now();
+      backend = autotuneOperatorBackend<state_d_type>(appObj_, 1,
+						      parser_.getAutotuneSteps(),
+						      parser_.getAutotuneCacheFile());
+      const std::chrono::duration<double> elapsed =
+	std::chrono::high_resolution_clock::now() - startTime;
+      perfReport_.accumulateTime("autotune", elapsed.count());
+    }
+    appObj_.setOperatorBackend(backend);
+    perfReport_.addInfo("operatorBackend", operatorBackendKindToString(backend));
+  }
+
+  // with zero-copy snapshots the updates are written into the snapshot matrix
+  template <typename observer_t, typename seismo_t>
+  void runSample(forcing_type & forcing,
+		 observer_t & observerObj,
+		 seismo_t & seismoObj,
+		 const std::size_t iSample)
+  {
+    if (observerObj.zeroCopy()){
+      runFomZeroCopy(parser_.getNumSteps(), parser_.getTimeStepSize(),
+		     appObj_, forcing, observerObj, seismoObj,
+		     xVp_d_, xSp_d_, perfReport_);
+    }
+    else if (interleavedLayout_){
+      runFomInterleaved(parser_.getNumSteps(), parser_.getTimeStepSize(),
+			appObj_, *interleavedLayout_, forcing, observerObj, seismoObj,
+			xVp_d_, xSp_d_, perfReport_);
+    }
+    else if (persistentTimeLoop_){
+      runFomPersistent(parser_.getNumSteps(), parser_.getTimeStepSize(),
+		       appObj_, forcing, observerObj, seismoObj,
+		       xVp_d_, xSp_d_, perfReport_);
+    }
+    else{
+      runFom(parser_.getNumSteps(), parser_.getTimeStepSize(),
+	     appObj_, forcing, observerObj, seismoObj,
+	     xVp_d_, xSp_d_, checkpoint_, perfReport_, iSample);
+    }
+  }
+
+  // the persistent time loop runs all steps in one parallel region,
+  // with auto it is used for small meshes when nothing needs per-step control
+  bool selectPersistentTimeLoop() const
+  {
+    constexpr bool onHost =
+      std::is_same<typename state_d_type::memory_space, Kokkos::HostSpace>::value;
+    const bool supported = onHost and !checkpoint_.enabled() and !parser_.enableRestart()
+      and !parser_.interleavedStates() and !parser_.restrictSnapshots()
+      and !parser_.snapshotsZeroCopy()
+      and !(parser_.multiForcing() and parser_.getEnsembleSize() > 1)
+      and appObj_.getOperatorBackend() != operatorBackendKind::sharedSparsity;
+
+    switch (parser_.getTimeLoop()){
+    case timeLoopKind::persistent:
+      if (!supported){
+	throw std::runtime_error("timeLoop: persistent needs a host build, no checkpoint/restart, "
+				 "stateLayout: separate, a CRS operatorBackend, unrestricted "
+				 "snapshots without zeroCopy and ensembleSize 1");
+      }
+      return true;
+    case timeLoopKind::automatic:
+      return supported and !parser_.enableFencedTiming()
+	and static_cast<std::size_t>(nVp_ + nSp_) <= parser_.getPersistentMaxDofs();
+    default:
+      return false;
+    }
+  }
+
+  // the interleaved layout has its own kernels time loop, which does
+  // not write checkpoints nor the states into the snapshot matrix
+  void checkInterleavedStatesSupported() const
+  {
+    if (checkpoint_.enabled() or parser_.enableRestart()){
+      throw std::runtime_error("stateLayout: interleaved cannot be used with checkpoint/restart");
+    }
+    if (parser_.snapshotsZeroCopy()){
+      throw std::runtime_error("stateLayout: interleaved cannot be used with zero-copy snapshots");
+    }
+    if (parser_.multiForcing() and parser_.getEnsembleSize() > 1){
+      throw std::runtime_error("stateLayout: interleaved cannot be used with ensembleSize > 1");
+    }
+  }
+
+  void ensembleRun()
+  {
+    std::cout << "Doing FOM with sampling, ensemble of samples" << std::endl;
+    if (checkpoint_.enabled() or parser_.enableRestart()){
+      throw std::runtime_error("Checkpoint/restart is not supported with ensembleSize > 1");
+    }
+
+    // need to run checks
+    checkCflCondition();
+    for (const auto & iT : parser_.viewPeriods()){
+      const auto freq = static_cast<scalar_type>(1)/iT;
+      checkDispersion(freq);
+    }
+
+    // samples in the same order as multiForcingRun: depth, period, angle, delay
+    std::vector<std::array<scalar_type, 4>> samples;
+    for (const auto & iD : parser_.viewDepths()){
+      for (const auto & iT : parser_.viewPeriods()){
+	for (const auto & ia : parser_.viewAngles()){
+	  for (const auto & idel : parser_.viewDelays()){
+	    samples.push_back({iD, iT, ia, idel});
+	  }
+	}
+      }
+    }
+
+    // each member has its own states, observer and seismogram,
+    // these are reused by all groups of samples. The first observer
+    // is a shallow copy of observerObj_ so it shares its storage.
+    const std::size_t ensembleSize = std::min<std::size_t>(parser_.getEnsembleSize(),
+							   samples.size());
+    ensemble_state_d_type xVp_d("xVpEnsemble_d", nVp_, ensembleSize);
+    ensemble_state_d_type xSp_d("xSpEnsemble_d", nSp_, ensembleSize);
+    std::vector<observer_type> observers(1, observerObj_);
+    std::vector<seismogram_type> seismos;
+    for (std::size_t k=0; k<ensembleSize; ++k){
+      if (k > 0) observers.emplace_back(nVp_, nSp_, parser_, 1, observerObj_.viewSnapshotRows());
+      seismos.emplace_back(parser_, meshInfo_, appObj_);
+    }
+
+    for (std::size_t start=0; start<samples.size(); start+=ensembleSize)
+    {
+      const auto end = std::min(start+ensembleSize, samples.size());
+      std::vector<forcing_type> forcings;
+      for (std::size_t iSample=start; iSample<end; ++iSample){
+	const auto & p = samples[iSample];
+	Signal<scalar_type> signal(parser_.getSourceSignalKind(), p[3], p[1]);
+	forcings.emplace_back(signal, parser_, meshInfo_, appObj_, p[0], p[2]);
+
+	observers[iSample-start].prepForNewRun(iSample, iSample);
+	seismos[iSample-start].prepForNewRun(iSample, iSample);
+	addSampleToContainer(iSample, p[0], p[1], p[2], p[3]);
+      }
+
+      runFomEnsemble(parser_.getNumSteps(), parser_.getTimeStepSize(),
+		     appObj_, forcings, observers, seismos,
+		     xVp_d, xSp_d, perfReport_);
+
+      for (std::size_t k=0; k<forcings.size(); ++k){
+	processCollectedData(observers[k], seismos[k]);
+      }
+    }
+
+    // coordinates only need to be written once
+    processCoordinates();
+  }
+
+  // a restart would have to append to the container of the first run
+  void openContainer()
+  {
+    if (checkpoint_.enabled() or parser_.enableRestart()){
+      throw std::runtime_error("io: container cannot be used with checkpoint/restart");
+    }
+    container_.reset(new SampleContainerWriter(parser_.getContainerFileName(),
+					       parser_.getContainerTileRows(),
+					       parser_.getContainerTileCols()));
+  }
+
+  void addSampleToContainer(const std::size_t iSample,
+			    const scalar_type depth,
+			    const scalar_type period,
+			    const scalar_type angle,
+			    const scalar_type delay)
+  {
+    if (container_){
+      container_->addSample({iSample, depth, period, angle, delay,
+			     signalKindToString(parser_.getSourceSignalKind())});
+    }
+  }
+
   void checkDispersion(const scalar_type & freq)
   {
     if (parser_.checkDispersion()){
@@ -204,32 +496,68 @@ private:
     }
   }
 
+  void reportPagePlacement() const
+  {
+    PagePlacementReport report;
+    appObj_.addToPlacementReport(report);
+    report.add("xVp", xVp_d_);
+    report.add("xSp", xSp_d_);
+    observerObj_.addToPlacementReport(report);
+    report.print();
+  }
+
   void processCoordinates()
   {
+    ProfilingRegion region("shaw::write");
     if(parser_.enableSnapshotMatrix()){
       appObj_.writeCoordinatesToFile(dofId::vp);
       appObj_.writeCoordinatesToFile(dofId::sp);
+      observerObj_.writeSnapshotRowsToFile();
     }
   }
 
   template <typename seismo_t>
-  void processCollectedData(const seismo_t & seismoObj, std::size_t iSample = 0)
+  void processCollectedData(const seismo_t & seismoObj)
+  {
+    processCollectedData(observerObj_, seismoObj);
+  }
+
+  template <typename observer_t, typename seismo_t>
+  void processCollectedData(const observer_t & observerObj, const seismo_t & seismoObj)
+  {
+    ProfilingRegion region("shaw::write");
+    const double elapsed = writeCollectedData(observerObj, seismoObj);
+    perfReport_.accumulateTime("write", elapsed);
+    std::cout << "\nfinalProcessTime = " << std::fixed << std::setprecision(10) << elapsed;
+    std::cout << "\n";
+  }
+
+  // writes the collected data and returns the seconds it took,
+  // it only reads the parser so that it can run on the background writer
+  template <typename observer_t, typename seismo_t>
+  double writeCollectedData(const observer_t & observerObj, const seismo_t & seismoObj) const
   {
     const auto startTime  = std::chrono::high_resolution_clock::now();
 
-    if(parser_.enableSnapshotMatrix()){
-      observerObj_.writeSnapshotMatrixToFile(dofId::vp);
-      observerObj_.writeSnapshotMatrixToFile(dofId::sp);
+    if (container_){
+      observerObj.writeSnapshotMatrixToContainer(dofId::vp, *container_);
+      observerObj.writeSnapshotMatrixToContainer(dofId::sp, *container_);
+      seismoObj.writeReceiversToContainer(*container_);
     }
+    else{
+      if(parser_.enableSnapshotMatrix()){
+	observerObj.writeSnapshotMatrixToFile(dofId::vp);
+	observerObj.writeSnapshotMatrixToFile(dofId::sp);
+      }
 
-    if(parser_.enableSeismogram()){
-      seismoObj.writeReceiversToFile();
+      if(parser_.enableSeismogram()){
+	seismoObj.writeReceiversToFile();
+      }
     }
 
     const auto finishTime = std::chrono::high_resolution_clock::now();
     const std::chrono::duration<double> elapsed = finishTime - startTime;
-    std::cout << "\nfinalProcessTime = " << std::fixed << std::setprecision(10) << elapsed.count();
-    std::cout << "\n";
+    return elapsed.count();
   }
 };
 
@@ -71,8 +71,9 @@ private:
   // object with info about the mesh
   const mesh_info_type & meshInfo_;
 
-  // how many forcing realization to handle simultaneously
-  const int fSize_;
+  // how many forcing realization to handle simultaneously,
+  // picked by calibration if the input has forcingSize: auto
+  int fSize_;
 
   // number of velocity DOFs
   const mesh_ord_type nVp_;
@@ -87,6 +88,12 @@ private:
   state_d_type xSp_d_;
   // observer object to monitor the time evolution
   observer_type observerObj_;
+  // checkpoint/restart handler
+  FomCheckpoint<scalar_type> checkpoint_;
+  // machine-readable performance report
+  PerfReport perfReport_;
+  // single-file output of all samples, only set with io: container
+  std::unique_ptr<SampleContainerWriter> container_;
 
 public:
   FomProblemRankTwoForcing() = delete;
@@ -99,17 +106,81 @@ public:
       fSize_(parser.getForcingSize()),
       nVp_(meshInfo_.getNumVpPts()),
       nSp_(meshInfo_.getNumSpPts()),
-      appObj_(meshInfo_, materialObj),
-      xVp_d_("xVp_d", nVp_, fSize_),
-      xSp_d_("xSp_d", nSp_, fSize_),
-      observerObj_(nVp_, nSp_, parser, fSize_)
-  {}
+      appObj_(meshInfo_, materialObj, parser.hugePages()),
+      xVp_d_(allocateWithPlacement<state_d_type>(parser, "xVp_d", nVp_, fSize_)),
+      xSp_d_(allocateWithPlacement<state_d_type>(parser, "xSp_d", nSp_, fSize_)),
+      observerObj_(nVp_, nSp_, parser, fSize_, selectSnapshotRows(parser, appObj_)),
+      checkpoint_(parser),
+      perfReport_(parser)
+  {
+    if (parser.interleavedStates()){
+      throw std::runtime_error("stateLayout: interleaved is only supported for rank-1 states");
+    }
+    if (parser.getTimeLoop() == timeLoopKind::persistent){
+      throw std::runtime_error("timeLoop: persistent is only supported for rank-1 states");
+    }
+    if (parser.snapshotsZeroCopy()){
+      throw std::runtime_error("Zero-copy snapshots are only supported for rank-1 states");
+    }
+
+    perfReport_.addInfo("executionSpace", Kokkos::DefaultExecutionSpace::name());
+    perfReport_.addInfo("concurrency", Kokkos::DefaultExecutionSpace().concurrency());
+    perfReport_.addInfo("numVpPts", nVp_);
+    perfReport_.addInfo("numSpPts", nSp_);
+    perfReport_.addInfo("indexBits", 8*sizeof(typename T::jacobian_ord_type));
+    perfReport_.addInfo("numSteps", parser.getNumSteps());
+    perfReport_.addInfo("dt", parser.getTimeStepSize());
+    for (const auto & it : appObj_.viewSetupTimes()){
+      perfReport_.accumulateTime(it.first, it.second);
+    }
+
+    // on restart, the samples must be split in the same sets as the first run
+    if (parser.autoForcingSize() and checkpoint_.restartPending()){
+      fSize_ = checkpoint_.getRestartSetSize();
+      setForcingSize(fSize_);
+    }
+    else if (parser.autoForcingSize()){
+      selectForcingSize();
+    }
+    checkpoint_.setSetSize(fSize_);
+    perfReport_.addInfo("forcingSize", fSize_);
+
+    selectOperatorBackend();
+
+    // the stress coordinates are only written next to the snapshots
+    if (parser.leanMemory()){
+      appObj_.releaseAssemblyData(parser.enableSnapshotMatrix());
+    }
+    perfReport_.addInfo("footprintMB", appObj_.footprintBytes()/1024./1024.);
+
+    if (parser.numaFirstTouch()){
+      reportPagePlacement();
+    }
+
+    if (parser.enableContainer()){
+      openContainer();
+    }
+  }
 
 public:
   void operator()()
   {
-    // seismogram
-    seismogram_type seismoObj(parser_, meshInfo_, appObj_, fSize_);
+    // buffers to collect data, with asyncWrite a set is written
+    // in the background while the next one runs with other buffers.
+    // The first observer is a shallow copy of observerObj_.
+    std::vector<observer_type> observers(1, observerObj_);
+    std::vector<seismogram_type> seismos;
+    seismos.emplace_back(parser_, meshInfo_, appObj_, fSize_);
+    const auto numBuffers = numOutputBuffers(parser_,
+					     observers[0].sizeInBytes() + seismos[0].sizeInBytes(),
+					     checkpoint_.enabled());
+    for (std::size_t k=1; k<numBuffers; ++k){
+      observers.emplace_back(nVp_, nSp_, parser_, fSize_, observerObj_.viewSnapshotRows());
+      seismos.emplace_back(parser_, meshInfo_, appObj_, fSize_);
+    }
+    OutputBufferPool<observer_type, seismogram_type> buffers(std::move(observers),
+							     std::move(seismos),
+							     perfReport_);
 
     // create vector of signals using target samples
     const auto & depths   = parser_.viewDepths();
@@ -132,11 +203,6 @@ public:
 
     // how many total forcing realizations to do
     const std::size_t totFRealizations = nDepths*nPeriods*nAngles*nDelays;
-    // for now, only support totFRealizations % fSize == 0
-    if (totFRealizations % fSize_ != 0){
-      throw std::runtime_error
-	("totFRealizations & fSize != 0: tot num of forcing realizations must be divisible by fSize");
-    }
 
     signals_h_type signalsForRun("s1",totFRealizations);
     Kokkos::View<scalar_type*, Kokkos::HostSpace> depthsForRun("d1",totFRealizations);
@@ -155,21 +221,39 @@ public:
 	    signalsForRun(i) = signal;
 	    depthsForRun(i) = itDepth;
 	    anglesForRun(i) = itAngle;
+	    addSampleToContainer(i, itDepth, itPeriod, itAngle, itDelay);
 	    ++i;
 	  }
 	}
       }
     }
 
-    const std::size_t numSets = signalsForRun.size()/fSize_;
+    // if totFRealizations is not divisible by fSize, the last
+    // set is run with the remaining realizations only
+    const std::size_t numSets = (totFRealizations + fSize_ - 1)/fSize_;
     std::cout << "Doing rank-2 FOM" << std::endl;
     std::cout << "Total number of samples " << totFRealizations << std::endl;
     std::cout << "Total number of set " << numSets << std::endl;
 
     for (std::size_t i=0; i<numSets; ++i)
     {
+      // sets completed before the restart point are not rerun
+      if (checkpoint_.isCompletedBeforeRestart(i)){
+	continue;
+      }
+
       const std::size_t sInd = i*fSize_;
-      const std::size_t eInd = sInd+fSize_;
+      const std::size_t eInd = std::min(sInd+fSize_, totFRealizations);
+      if (eInd-sInd != xVp_d_.extent(1)){
+	std::cout << "Last set has " << eInd-sInd << " samples" << std::endl;
+	reallocStates(eInd-sInd);
+      }
+      // no-op unless the buffers were used for a different set size
+      auto & observerObj = buffers.observer();
+      auto & seismoObj   = buffers.seismogram();
+      observerObj.setForcingSize(eInd-sInd);
+      seismoObj.setForcingSize(eInd-sInd);
+
       auto currSignals = Kokkos::subview(signalsForRun, std::make_pair(sInd, eInd));
       auto currDepths  = Kokkos::subview(depthsForRun,  std::make_pair(sInd, eInd));
       auto currAngles  = Kokkos::subview(anglesForRun,  std::make_pair(sInd, eInd));
@@ -177,19 +261,116 @@ public:
       forcing_type forcing(currSignals, parser_,meshInfo_, appObj_,currDepths, currAngles);
 
       // reset observer and seismogram
-      observerObj_.prepForNewRun(i);
-      seismoObj.prepForNewRun(i);
+      observerObj.prepForNewRun(i, sInd);
+      seismoObj.prepForNewRun(i, sInd);
 
       // run fom
       runFom(parser_.getNumSteps(), parser_.getTimeStepSize(),
-	     appObj_, forcing, observerObj_, seismoObj,
-	     xVp_d_, xSp_d_);
+	     appObj_, forcing, observerObj, seismoObj,
+	     xVp_d_, xSp_d_, checkpoint_, perfReport_, i);
 
-      processCollectedData(seismoObj);
+      buffers.writeAndAdvance([this](const observer_type & o, const seismogram_type & s){
+				return writeCollectedData(o, s);
+			      });
     }
+    buffers.waitAll();
 
     // coordinates only need to be written once
     processCoordinates();
+
+    // the index is written when the container is closed
+    if (container_){
+      container_->close();
+    }
+
+    if (perfReport_.enabled()){
+      perfReport_.write();
+    }
+  }
+
+  std::size_t numSamples() const
+  {
+    return parser_.viewDepths().size() * parser_.viewPeriods().size()
+      * parser_.viewAngles().size() * parser_.viewDelays().size();
+  }
+
+  // number of realizations the states and observer can hold
+  void setForcingSize(const std::size_t fSize)
+  {
+    reallocStates(fSize);
+    observerObj_.setForcingSize(fSize);
+  }
+
+  void reallocStates(const std::size_t fSize)
+  {
+    // free first so that old and new states are never both resident
+    xVp_d_ = state_d_type();
+    xSp_d_ = state_d_type();
+    xVp_d_ = allocateWithPlacement<state_d_type>(parser_, "xVp_d", nVp_, fSize);
+    xSp_d_ = allocateWithPlacement<state_d_type>(parser_, "xSp_d", nSp_, fSize);
+  }
+
+  void selectForcingSize()
+  {
+    // wider sets rarely pay off, and calibration time grows with the width
+    constexpr std::size_t maxForcingSize = 32;
+
+    ProfilingRegion region("shaw::autotune");
+    const auto startTime = std::chrono::high_resolution_clock::now();
+
+    // if the backend is also autotuned, this is done after
+    // for the selected forcing size. The shared-sparsity operator
+    // is only built afterwards, so calibrate with the CRS matrices
+    const auto backend = parser_.getOperatorBackend() == operatorBackendKind::crsFunctor
+      ? operatorBackendKind::crsFunctor : operatorBackendKind::kokkosSparse;
+    fSize_ = calibrateForcingSize<state_d_type>(appObj_, backend,
+						std::min(numSamples(), maxForcingSize),
+						parser_.getAutotuneSteps());
+    setForcingSize(fSize_);
+
+    const std::chrono::duration<double> elapsed =
+      std::chrono::high_resolution_clock::now() - startTime;
+    perfReport_.accumulateTime("autotune", elapsed.count());
+  }
+
+  void selectOperatorBackend()
+  {
+    auto backend = parser_.getOperatorBackend();
+    if (parser_.autotuneOperatorBackend()){
+      ProfilingRegion region("shaw::autotune");
+      const auto startTime = std::chrono::high_resolution_clock::now();
+      backend = autotuneOperatorBackend<state_d_type>(appObj_, fSize_,
+						      parser_.getAutotuneSteps(),
+						      parser_.getAutotuneCacheFile());
+      const std::chrono::duration<double> elapsed =
+	std::chrono::high_resolution_clock::now() - startTime;
+      perfReport_.accumulateTime("autotune", elapsed.count());
+    }
+    appObj_.setOperatorBackend(backend);
+    perfReport_.addInfo("operatorBackend", operatorBackendKindToString(backend));
+  }
+
+  // a restart would have to append to the container of the first run
+  void openContainer()
+  {
+    if (checkpoint_.enabled() or parser_.enableRestart()){
+      throw std::runtime_error("io: container cannot be used with checkpoint/restart");
+    }
+    container_.reset(new SampleContainerWriter(parser_.getContainerFileName(),
+					       parser_.getContainerTileRows(),
+					       parser_.getContainerTileCols()));
+  }
+
+  void addSampleToContainer(const std::size_t iSample,
+			    const scalar_type depth,
+			    const scalar_type period,
+			    const scalar_type angle,
+			    const scalar_type delay)
+  {
+    if (container_){
+      container_->addSample({iSample, depth, period, angle, delay,
+			     signalKindToString(parser_.getSourceSignalKind())});
+    }
   }
 
   void checkDispersion(const scalar_type & freq)
@@ -206,33 +387,52 @@ public:
     }
   }
 
+  void reportPagePlacement() const
+  {
+    PagePlacementReport report;
+    appObj_.addToPlacementReport(report);
+    report.add("xVp", xVp_d_);
+    report.add("xSp", xSp_d_);
+    observerObj_.addToPlacementReport(report);
+    report.print();
+  }
+
   void processCoordinates()
   {
+    ProfilingRegion region("shaw::write");
     if(parser_.enableSnapshotMatrix()){
       appObj_.writeCoordinatesToFile(dofId::vp);
       appObj_.writeCoordinatesToFile(dofId::sp);
+      observerObj_.writeSnapshotRowsToFile();
     }
   }
 
-  template <typename seismo_t>
-  void processCollectedData(const seismo_t & seismoObj)
+  // writes the collected data and returns the seconds it took,
+  // it only reads the parser so that it can run on the background writer
+  template <typename observer_t, typename seismo_t>
+  double writeCollectedData(const observer_t & observerObj, const seismo_t & seismoObj) const
   {
     const auto startTime  = std::chrono::high_resolution_clock::now();
 
-    if(parser_.enableSnapshotMatrix()){
-      observerObj_.writeSnapshotMatrixToFile(dofId::vp);
-      observerObj_.writeSnapshotMatrixToFile(dofId::sp);
+    if (container_){
+      observerObj.writeSnapshotMatrixToContainer(dofId::vp, *container_);
+      observerObj.writeSnapshotMatrixToContainer(dofId::sp, *container_);
+      seismoObj.writeReceiversToContainer(*container_);
     }
+    else{
+      if(parser_.enableSnapshotMatrix()){
+	observerObj.writeSnapshotMatrixToFile(dofId::vp);
+	observerObj.writeSnapshotMatrixToFile(dofId::sp);
+      }
 
-    if(parser_.enableSeismogram()){
-      seismoObj.writeReceiversToFile();
+      if(parser_.enableSeismogram()){
+	seismoObj.writeReceiversToFile();
+      }
     }
 
     const auto finishTime = std::chrono::high_resolution_clock::now();
     const std::chrono::duration<double> elapsed = finishTime - startTime;
-    std::cout << "\nfinalProcessTime = " << std::fixed << std::setprecision(10)
-	      << elapsed.count();
-    std::cout << "\n";
+    return elapsed.count();
   }
 
 };
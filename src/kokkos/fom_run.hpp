@@ -51,6 +51,8 @@
 
 #include "fom_update_kernels.hpp"
 #include "fom_complexities.hpp"
+#include "fom_checkpoint.hpp"
+#include <memory>
 
 namespace kokkosapp{
 
@@ -70,15 +72,23 @@ void runFom(const step_t & numSteps,
 	    observer_t & observerObj,
 	    seismo_t & seismoObj,
 	    state_d_t xVp_d,
-	    state_d_t xSp_d)
+	    state_d_t xSp_d,
+	    FomCheckpoint<sc_t> & checkpoint,
+	    PerfReport & perfReport,
+	    const std::size_t sampleID = 0)
 {
-  // zero states
-  KokkosBlas::fill(xVp_d, constants<sc_t>::zero());
-  KokkosBlas::fill(xSp_d, constants<sc_t>::zero());
+  // zero states, unless this sample resumes from a checkpoint
+  const std::size_t startStep = checkpoint.restore(sampleID, numSteps, dt, forcingObj,
+						   observerObj, seismoObj, xVp_d, xSp_d);
+  if (startStep == 0){
+    KokkosBlas::fill(xVp_d, constants<sc_t>::zero());
+    KokkosBlas::fill(xSp_d, constants<sc_t>::zero());
+  }
 
-  const auto jacVp_d     = fomObj.viewJacobianDevice(dofId::vp);
-  const auto jacSp_d     = fomObj.viewJacobianDevice(dofId::sp);
+  const auto jacVp_d     = fomObj.viewOperatorDevice(dofId::vp);
+  const auto jacSp_d     = fomObj.viewOperatorDevice(dofId::sp);
   const auto rhoInvVp_d  = fomObj.viewInvDensityDevice(dofId::vp);
+  const auto backend     = fomObj.getOperatorBackend();
 
   // create mirrors of states if we need to collect data
   auto xVp_h = Kokkos::create_mirror_view(xVp_d);
@@ -86,59 +96,104 @@ void runFom(const step_t & numSteps,
   const auto snapshotsCollectionEnabled = observerObj.enabled();
   const auto seismogramEnabled = seismoObj.enabled();
 
+  // if fenced timing is on, we fence after each phase so that
+  // timings are correct for asynchronous backends, and we record
+  // the latency of each phase at every step
+  const bool fencedTiming = perfReport.fencedTiming();
+  const auto forcingId  = perfReport.registerPhase("forcing");
+  const auto velocityId = perfReport.registerPhase("velocityUpdate");
+  const auto stressId   = perfReport.registerPhase("stressUpdate");
+  const auto observeId  = perfReport.registerPhase("observe");
+  const auto stepId     = perfReport.registerPhase("step");
+
   // to collec timings
   Kokkos::Timer timer;
   double dataCollectionTime = {};
+  double checkpointTime = {};
   std::array<double, 3> perfTimes = {1e32,0.,0.}; //min, max, total
 
+  // optional hardware counters over the time loop
+  std::unique_ptr<HardwareCounters> hwCounters;
+  if (perfReport.hardwareCounters()){
+    hwCounters.reset(new HardwareCounters());
+    hwCounters->start();
+  }
+
   //****** LOOP ******//
   const auto startTime  = std::chrono::high_resolution_clock::now();
-  sc_t timeVp = constants<sc_t>::zero();
-  for (auto iStep = 1; iStep<=numSteps; ++iStep)
+  sc_t timeVp = startStep*dt;
+  for (std::size_t iStep = startStep+1; iStep<=numSteps; ++iStep)
   {
     if (iStep % 2000 == 0) std::cout << "Doing step = " << iStep << std::endl;
 
+    double ct1 = {}, ct2 = {}, ct3 = {}, ctObs = {};
+
     // compute forcing for current time
-    timer.reset();
-    forcingObj.evaluate(timeVp, iStep);
-    const double ct1 = timer.seconds();
+    {
+      ProfilingRegion region("shaw::forcing");
+      timer.reset();
+      forcingObj.evaluate(timeVp, iStep);
+      if (fencedTiming) Kokkos::fence();
+      ct1 = timer.seconds();
+    }
 
     // ----------------
     // 1. do velocity
-    // need to fix timers for async launch
-    timer.reset();
-    updateVelocity(dt, xVp_d, xSp_d, jacVp_d, rhoInvVp_d, forcingObj);
-    const double ct2 = timer.seconds();
-    timer.reset();
-    if (snapshotsCollectionEnabled or seismogramEnabled){
-      // deep copy already fences so no need to explicitly fence
-      Kokkos::deep_copy(xVp_h, xVp_d);
+    {
+      ProfilingRegion region("shaw::velocityUpdate");
+      timer.reset();
+      updateVelocity(dt, xVp_d, xSp_d, jacVp_d, rhoInvVp_d, forcingObj, backend);
+      if (fencedTiming) Kokkos::fence();
+      ct2 = timer.seconds();
     }
-    else{
-      Kokkos::fence();
+    {
+      ProfilingRegion region("shaw::observe");
+      timer.reset();
+      if (snapshotsCollectionEnabled or seismogramEnabled){
+	// deep copy already fences so no need to explicitly fence
+	Kokkos::deep_copy(xVp_h, xVp_d);
+      }
+      else{
+	Kokkos::fence();
+      }
+      observerObj.observe(dofId::vp, iStep, xVp_h);
+      seismoObj.storeVelocitySignalAtReceivers(iStep, xVp_h);
+      ctObs += timer.seconds();
     }
-    observerObj.observe(dofId::vp, iStep, xVp_h);
-    seismoObj.storeVelocitySignalAtReceivers(iStep, xVp_h);
-    dataCollectionTime += timer.seconds();
 
     // update time
     timeVp = iStep*dt;
 
     // ----------------
     // 2. do stress
-    // need to fix timers for async launch
-    timer.reset();
-    updateStress(dt, xSp_d, xVp_d, jacSp_d);
-    const double ct3 = timer.seconds();
-    timer.reset();
-    if (snapshotsCollectionEnabled){
-      Kokkos::deep_copy(xSp_h, xSp_d);
+    {
+      ProfilingRegion region("shaw::stressUpdate");
+      timer.reset();
+      updateStress(dt, xSp_d, xVp_d, jacSp_d, backend);
+      if (fencedTiming) Kokkos::fence();
+      ct3 = timer.seconds();
     }
-    else{
-      Kokkos::fence();
+    {
+      ProfilingRegion region("shaw::observe");
+      timer.reset();
+      if (snapshotsCollectionEnabled){
+	Kokkos::deep_copy(xSp_h, xSp_d);
+      }
+      else{
+	Kokkos::fence();
+      }
+      observerObj.observe(dofId::sp, iStep, xSp_h);
+      ctObs += timer.seconds();
+    }
+    dataCollectionTime += ctObs;
+
+    if (checkpoint.isDue(iStep, numSteps)){
+      ProfilingRegion region("shaw::checkpoint");
+      timer.reset();
+      checkpoint.write(sampleID, iStep, numSteps, timeVp, dt, forcingObj,
+		       observerObj, seismoObj, xVp_d, xSp_d);
+      checkpointTime += timer.seconds();
     }
-    observerObj.observe(dofId::sp, iStep, xSp_h);
-    dataCollectionTime += timer.seconds();
 
     // ----------------
     // 3. timing vars
@@ -146,18 +201,66 @@ void runFom(const step_t & numSteps,
     perfTimes[0] = std::min(perfTimes[0], time);
     perfTimes[1] = std::max(perfTimes[1], time);
     perfTimes[2] += time;
+
+    if (fencedTiming){
+      perfReport.recordLatency(forcingId,  ct1);
+      perfReport.recordLatency(velocityId, ct2);
+      perfReport.recordLatency(stressId,   ct3);
+      perfReport.recordLatency(observeId,  ctObs);
+      perfReport.recordLatency(stepId,     time+ctObs);
+    }
   }
 
   const auto finishTime = std::chrono::high_resolution_clock::now();
+  if (hwCounters){
+    hwCounters->stop();
+  }
   const std::chrono::duration<double> elapsed = finishTime - startTime;
   std::cout << "\nloopTime = " << std::fixed << std::setprecision(10) << elapsed.count();
   std::cout << "\ndataCollectionTime = " << std::fixed << std::setprecision(10)
 	    << dataCollectionTime << std::endl;
+  if (checkpoint.enabled()){
+    std::cout << "checkpointTime = " << std::fixed << std::setprecision(10)
+	      << checkpointTime << std::endl;
+  }
 
   // compute complexity and print
   double memCostMB, flopsCost = 0.;
   complexityFom<sc_t>(xVp_d, xSp_d, fomObj, forcingObj, memCostMB, flopsCost);
-  printPerf(numSteps, perfTimes, memCostMB, flopsCost);
+  printPerf(numSteps-startStep, perfTimes, memCostMB, flopsCost);
+  if (hwCounters){
+    printHardwareCounters(*hwCounters, numSteps-startStep, elapsed.count(),
+			  memCostMB, perfReport.streamPeakGBs());
+    perfReport.recordCounters(*hwCounters);
+  }
+
+  perfReport.recordRun(numSteps-startStep, elapsed.count(), dataCollectionTime,
+		       perfTimes, memCostMB, flopsCost);
+}
+
+// overload without checkpointing and performance report
+template <
+  typename step_t,
+  typename sc_t,
+  typename app_t,
+  typename forcing_t,
+  typename observer_t,
+  typename seismo_t,
+  typename state_d_t
+  >
+void runFom(const step_t & numSteps,
+	    const sc_t dt,
+	    const app_t & fomObj,
+	    forcing_t & forcingObj,
+	    observer_t & observerObj,
+	    seismo_t & seismoObj,
+	    state_d_t xVp_d,
+	    state_d_t xSp_d)
+{
+  FomCheckpoint<sc_t> noCheckpoint;
+  PerfReport noReport;
+  runFom(numSteps, dt, fomObj, forcingObj, observerObj, seismoObj,
+	 xVp_d, xSp_d, noCheckpoint, noReport);
 }
 
 }//end namespace kokkosapp
@@ -0,0 +1,273 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// fom_run_ensemble.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef LEAP_FROG_RUN_FOM_ENSEMBLE_HPP_
+#define LEAP_FROG_RUN_FOM_ENSEMBLE_HPP_
+
+#include "fom_complexities.hpp"
+#include <memory>
+
+namespace kokkosapp{
+
+/*
+ * One time step of an ensemble of independent rank-1 samples:
+ * each team advances one sample (one column of the states), so
+ * samples run concurrently on disjoint groups of threads while
+ * all of them read the same jacobians.
+ */
+template <class sc_t, class jac_t, class state_t, class rho_inv_t, class gids_t, class f_t>
+struct EnsembleStepFunctor
+{
+  using exe_space = typename jac_t::execution_space;
+  using member_t  = typename Kokkos::TeamPolicy<exe_space>::member_type;
+  using ord_t	  = typename jac_t::ordinal_type;
+
+  sc_t dt_;
+  jac_t jacVp_;
+  jac_t jacSp_;
+  state_t xVp_;
+  state_t xSp_;
+  rho_inv_t rhoInvVp_;
+  gids_t vpGids_;
+  f_t f_;
+
+  EnsembleStepFunctor(const sc_t & dt, jac_t jacVp, jac_t jacSp,
+		      state_t xVp, state_t xSp, rho_inv_t rhoInvVp,
+		      gids_t vpGids, f_t f)
+    : dt_(dt), jacVp_(jacVp), jacSp_(jacSp), xVp_(xVp), xSp_(xSp),
+      rhoInvVp_(rhoInvVp), vpGids_(vpGids), f_(f){}
+
+  // y(:,k) = y(:,k) + dt * A * x(:,k), rows split among the team
+  template <class x_t, class y_t>
+  KOKKOS_INLINE_FUNCTION
+  void applyJacobian(const member_t & member, const jac_t & A,
+		     const x_t & x, const y_t & y, const int k) const
+  {
+    const auto dt = dt_;
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(member, A.numRows()),
+			 [&](const ord_t iRow)
+			 {
+			   sc_t sum = {};
+			   for (auto j=A.graph.row_map(iRow); j<A.graph.row_map(iRow+1); ++j){
+			     sum += A.values(j) * x(A.graph.entries(j), k);
+			   }
+			   y(iRow, k) += dt*sum;
+			 });
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const member_t & member) const
+  {
+    const int k = member.league_rank();
+
+    // xVp = xVp + dt*jacVp*xSp + dt*rhoInvVp*f
+    applyJacobian(member, jacVp_, xSp_, xVp_, k);
+    member.team_barrier();
+    Kokkos::single(Kokkos::PerTeam(member), [&](){
+	const auto gid = vpGids_(k);
+	xVp_(gid, k) += dt_ * rhoInvVp_(gid) * f_(k);
+      });
+    member.team_barrier();
+
+    // xSp = xSp + dt * jacSp * xVp
+    applyJacobian(member, jacSp_, xVp_, xSp_, k);
+  }
+};
+
+/*
+ * Runs an ensemble of rank-1 samples together: sample k uses column k
+ * of the states and forcings[k], observers[k], seismos[k], which
+ * collect exactly what a rank-1 run of that sample would.
+ * Only the first forcings.size() columns of the states are used.
+ */
+template <
+  typename step_t,
+  typename sc_t,
+  typename app_t,
+  typename forcing_t,
+  typename observer_t,
+  typename seismo_t,
+  typename state_d_t
+  >
+void runFomEnsemble(const step_t & numSteps,
+		    const sc_t dt,
+		    const app_t & fomObj,
+		    std::vector<forcing_t> & forcings,
+		    std::vector<observer_t> & observers,
+		    std::vector<seismo_t> & seismos,
+		    state_d_t xVp_d,
+		    state_d_t xSp_d,
+		    PerfReport & perfReport)
+{
+  using jac_t	  = typename app_t::jacobian_d_type;
+  using exe_space = typename jac_t::execution_space;
+  using policy_t  = Kokkos::TeamPolicy<exe_space>;
+  using gids_d_t  = Kokkos::View<std::size_t*, exe_space>;
+  using f_d_t	  = Kokkos::View<sc_t*, exe_space>;
+  using rho_inv_t = decltype(fomObj.viewInvDensityDevice(dofId::vp));
+  using functor_t = EnsembleStepFunctor<sc_t, jac_t, state_d_t, rho_inv_t, gids_d_t, f_d_t>;
+
+  const int numMembers = forcings.size();
+  KokkosBlas::fill(xVp_d, constants<sc_t>::zero());
+  KokkosBlas::fill(xSp_d, constants<sc_t>::zero());
+
+  // forcing location and current value of each member
+  gids_d_t vpGids_d("ensembleVpGids", numMembers);
+  f_d_t f_d("ensembleForcing", numMembers);
+  auto vpGids_h = Kokkos::create_mirror_view(vpGids_d);
+  auto f_h = Kokkos::create_mirror_view(f_d);
+  for (int k=0; k<numMembers; ++k){
+    vpGids_h(k) = forcings[k].getVpGid();
+  }
+  Kokkos::deep_copy(vpGids_d, vpGids_h);
+
+  functor_t fnc(dt, fomObj.viewJacobianDevice(dofId::vp), fomObj.viewJacobianDevice(dofId::sp),
+		xVp_d, xSp_d, fomObj.viewInvDensityDevice(dofId::vp), vpGids_d, f_d);
+
+  // on host, split the threads evenly among the members,
+  // on device let kokkos pick the team size
+  constexpr bool onHost = std::is_same<exe_space, Kokkos::DefaultHostExecutionSpace>::value;
+  const int teamSize = std::max(1, exe_space().concurrency()/numMembers);
+  const policy_t policy = onHost ? policy_t(numMembers, teamSize)
+    : policy_t(numMembers, Kokkos::AUTO);
+  std::cout << "ensembleSize = " << numMembers << std::endl;
+  if (onHost){
+    std::cout << "teamSize = " << teamSize << std::endl;
+  }
+
+  auto xVp_h = Kokkos::create_mirror_view(xVp_d);
+  auto xSp_h = Kokkos::create_mirror_view(xSp_d);
+  const bool snapshotsCollectionEnabled = observers[0].enabled();
+  const bool seismogramEnabled = seismos[0].enabled();
+
+  Kokkos::Timer timer;
+  double dataCollectionTime = {};
+  std::array<double, 3> perfTimes = {1e32,0.,0.}; //min, max, total
+
+  // optional hardware counters over the time loop
+  std::unique_ptr<HardwareCounters> hwCounters;
+  if (perfReport.hardwareCounters()){
+    hwCounters.reset(new HardwareCounters());
+    hwCounters->start();
+  }
+
+  //****** LOOP ******//
+  const auto startTime = std::chrono::high_resolution_clock::now();
+  for (std::size_t iStep = 1; iStep<=numSteps; ++iStep)
+  {
+    if (iStep % 2000 == 0) std::cout << "Doing step = " << iStep << std::endl;
+
+    double ct = {};
+    {
+      ProfilingRegion region("shaw::ensembleStep");
+      timer.reset();
+      for (int k=0; k<numMembers; ++k){
+	f_h(k) = forcings[k].getForcingValueAtStep(iStep);
+      }
+      Kokkos::deep_copy(f_d, f_h);
+      Kokkos::parallel_for("ensembleStep", policy, fnc);
+      Kokkos::fence();
+      ct = timer.seconds();
+    }
+
+    {
+      // velocity is not changed by the stress update, so observing
+      // both after the full step gives the same data as rank-1 runs
+      ProfilingRegion region("shaw::observe");
+      timer.reset();
+      if (snapshotsCollectionEnabled or seismogramEnabled){
+	Kokkos::deep_copy(xVp_h, xVp_d);
+      }
+      if (snapshotsCollectionEnabled){
+	Kokkos::deep_copy(xSp_h, xSp_d);
+      }
+      for (int k=0; k<numMembers; ++k){
+	const auto xVpk_h = Kokkos::subview(xVp_h, Kokkos::ALL(), k);
+	const auto xSpk_h = Kokkos::subview(xSp_h, Kokkos::ALL(), k);
+	observers[k].observe(dofId::vp, iStep, xVpk_h);
+	seismos[k].storeVelocitySignalAtReceivers(iStep, xVpk_h);
+	observers[k].observe(dofId::sp, iStep, xSpk_h);
+      }
+      dataCollectionTime += timer.seconds();
+    }
+
+    perfTimes[0] = std::min(perfTimes[0], ct);
+    perfTimes[1] = std::max(perfTimes[1], ct);
+    perfTimes[2] += ct;
+  }
+
+  const auto finishTime = std::chrono::high_resolution_clock::now();
+  if (hwCounters){
+    hwCounters->stop();
+  }
+  const std::chrono::duration<double> elapsed = finishTime - startTime;
+  std::cout << "\nloopTime = " << std::fixed << std::setprecision(10) << elapsed.count();
+  std::cout << "\ndataCollectionTime = " << std::fixed << std::setprecision(10)
+	    << dataCollectionTime << std::endl;
+
+  // same cost as numMembers rank-1 steps
+  double memCostMB = 0., flopsCost = 0.;
+  using ord_t = typename app_t::jacobian_ord_type;
+  complexityFomRankOne<sc_t, ord_t>(xVp_d.extent(0), xSp_d.extent(0),
+				    fomObj.getJacobianNNZ(dofId::vp),
+				    fomObj.getJacobianNNZ(dofId::sp),
+				    memCostMB, flopsCost);
+  memCostMB *= numMembers;
+  flopsCost *= numMembers;
+  printPerf(numSteps, perfTimes, memCostMB, flopsCost);
+  if (hwCounters){
+    printHardwareCounters(*hwCounters, numSteps, elapsed.count(),
+			  memCostMB, perfReport.streamPeakGBs());
+    perfReport.recordCounters(*hwCounters);
+  }
+  perfReport.recordRun(numSteps, elapsed.count(), dataCollectionTime,
+		       perfTimes, memCostMB, flopsCost);
+}
+
+}//end namespace kokkosapp
+#endif
@@ -0,0 +1,261 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// fom_run_interleaved.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef LEAP_FROG_RUN_FOM_INTERLEAVED_HPP_
+#define LEAP_FROG_RUN_FOM_INTERLEAVED_HPP_
+
+#include "interleaved_layout.hpp"
+#include "fom_complexities.hpp"
+#include <memory>
+
+namespace kokkosapp{
+
+template <typename sc_t, typename layout_t, typename z_t, typename rho_inv_t, typename f_t>
+void interleavedHalfStep(const sc_t & dt,
+			 const layout_t & layout,
+			 const dofId & dof,
+			 z_t z,
+			 rho_inv_t rhoInv,
+			 f_t f)
+{
+  using family_t  = typename layout_t::Family;
+  using exe_space = typename z_t::execution_space;
+  using functor_t = InterleavedHalfStep<sc_t, family_t, z_t, rho_inv_t, f_t>;
+  const auto & fam = layout.viewFamily(dof);
+  Kokkos::parallel_for(dof == dofId::vp ? "interleavedVelocity" : "interleavedStress",
+		       Kokkos::RangePolicy<exe_space>(0, fam.rowGid.extent(0)),
+		       functor_t(dt, fam, z, rhoInv, f));
+}
+
+// per-family view of the interleaved state, x = z restricted to dof
+template <typename layout_t, typename z_t, typename state_d_t>
+void gatherFamily(const layout_t & layout,
+		  const dofId & dof,
+		  z_t z,
+		  state_d_t x)
+{
+  using exe_space = typename z_t::execution_space;
+  const auto pos = layout.viewFamily(dof).posOfGid;
+  using functor_t = GatherFamily<decltype(pos), z_t, state_d_t>;
+  Kokkos::parallel_for("gatherFamily",
+		       Kokkos::RangePolicy<exe_space>(0, x.extent(0)),
+		       functor_t{pos, z, x});
+}
+
+/*
+ * rank-1 time loop on the cell-interleaved state: both half-steps
+ * update the single array z, and xVp_d/xSp_d are only filled from z
+ * at the steps where the observer or the seismogram collect data,
+ * and at the end of the run.
+ */
+template <
+  typename step_t,
+  typename sc_t,
+  typename app_t,
+  typename layout_t,
+  typename forcing_t,
+  typename observer_t,
+  typename seismo_t,
+  typename state_d_t
+  >
+void runFomInterleaved(const step_t & numSteps,
+		       const sc_t dt,
+		       const app_t & fomObj,
+		       const layout_t & layout,
+		       forcing_t & forcingObj,
+		       observer_t & observerObj,
+		       seismo_t & seismoObj,
+		       state_d_t xVp_d,
+		       state_d_t xSp_d,
+		       PerfReport & perfReport)
+{
+  static_assert(is_kokkos_1dview<state_d_t>::value,
+		"The interleaved state layout only supports rank-1 states");
+
+  state_d_t z("zInterleaved_d", layout.size());
+  const auto rhoInvVp_d = fomObj.viewInvDensityDevice(dofId::vp);
+  const auto f_d = forcingObj.viewForcingDevice();
+  const state_d_t empty;
+
+  auto xVp_h = Kokkos::create_mirror_view(xVp_d);
+  auto xSp_h = Kokkos::create_mirror_view(xSp_d);
+  const auto snapshotsCollectionEnabled = observerObj.enabled();
+  const auto seismogramEnabled = seismoObj.enabled();
+  const std::size_t freqVp = snapshotsCollectionEnabled ? observerObj.getSnapshotFreq(dofId::vp) : 0;
+  const std::size_t freqSp = snapshotsCollectionEnabled ? observerObj.getSnapshotFreq(dofId::sp) : 0;
+  const std::size_t freqSeismo = seismogramEnabled ? seismoObj.getFreq() : 0;
+  auto isDue = [](const std::size_t step, const std::size_t freq){
+		 return freq > 0 and step % freq == 0;
+	       };
+
+  const bool fencedTiming = perfReport.fencedTiming();
+  const auto forcingId  = perfReport.registerPhase("forcing");
+  const auto velocityId = perfReport.registerPhase("velocityUpdate");
+  const auto stressId   = perfReport.registerPhase("stressUpdate");
+  const auto observeId  = perfReport.registerPhase("observe");
+  const auto stepId     = perfReport.registerPhase("step");
+
+  Kokkos::Timer timer;
+  double dataCollectionTime = {};
+  std::array<double, 3> perfTimes = {1e32,0.,0.}; //min, max, total
+
+  std::unique_ptr<HardwareCounters> hwCounters;
+  if (perfReport.hardwareCounters()){
+    hwCounters.reset(new HardwareCounters());
+    hwCounters->start();
+  }
+
+  //****** LOOP ******//
+  const auto startTime = std::chrono::high_resolution_clock::now();
+  sc_t timeVp = {};
+  for (std::size_t iStep = 1; iStep<=numSteps; ++iStep)
+  {
+    if (iStep % 2000 == 0) std::cout << "Doing step = " << iStep << std::endl;
+
+    double ct1 = {}, ct2 = {}, ct3 = {}, ctObs = {};
+
+    {
+      ProfilingRegion region("shaw::forcing");
+      timer.reset();
+      forcingObj.evaluate(timeVp, iStep);
+      if (fencedTiming) Kokkos::fence();
+      ct1 = timer.seconds();
+    }
+
+    // 1. velocity: z_vp += dt*jacVp*z_sp + dt*rhoInvVp*f
+    {
+      ProfilingRegion region("shaw::velocityUpdate");
+      timer.reset();
+      interleavedHalfStep(dt, layout, dofId::vp, z, rhoInvVp_d, f_d);
+      if (fencedTiming) Kokkos::fence();
+      ct2 = timer.seconds();
+    }
+    {
+      ProfilingRegion region("shaw::observe");
+      timer.reset();
+      if (isDue(iStep, freqVp) or isDue(iStep, freqSeismo)){
+	gatherFamily(layout, dofId::vp, z, xVp_d);
+	Kokkos::deep_copy(xVp_h, xVp_d);
+	observerObj.observe(dofId::vp, iStep, xVp_h);
+	seismoObj.storeVelocitySignalAtReceivers(iStep, xVp_h);
+      }
+      else{
+	Kokkos::fence();
+      }
+      ctObs += timer.seconds();
+    }
+
+    timeVp = iStep*dt;
+
+    // 2. stress: z_sp += dt*jacSp*z_vp
+    {
+      ProfilingRegion region("shaw::stressUpdate");
+      timer.reset();
+      interleavedHalfStep(dt, layout, dofId::sp, z, empty, empty);
+      if (fencedTiming) Kokkos::fence();
+      ct3 = timer.seconds();
+    }
+    {
+      ProfilingRegion region("shaw::observe");
+      timer.reset();
+      if (isDue(iStep, freqSp)){
+	gatherFamily(layout, dofId::sp, z, xSp_d);
+	Kokkos::deep_copy(xSp_h, xSp_d);
+	observerObj.observe(dofId::sp, iStep, xSp_h);
+      }
+      else{
+	Kokkos::fence();
+      }
+      ctObs += timer.seconds();
+    }
+    dataCollectionTime += ctObs;
+
+    const double time = ct1+ct2+ct3;
+    perfTimes[0] = std::min(perfTimes[0], time);
+    perfTimes[1] = std::max(perfTimes[1], time);
+    perfTimes[2] += time;
+
+    if (fencedTiming){
+      perfReport.recordLatency(forcingId,  ct1);
+      perfReport.recordLatency(velocityId, ct2);
+      perfReport.recordLatency(stressId,   ct3);
+      perfReport.recordLatency(observeId,  ctObs);
+      perfReport.recordLatency(stepId,     time+ctObs);
+    }
+  }
+
+  const auto finishTime = std::chrono::high_resolution_clock::now();
+  if (hwCounters){
+    hwCounters->stop();
+  }
+
+  // leave the final state in the per-family arrays
+  gatherFamily(layout, dofId::vp, z, xVp_d);
+  gatherFamily(layout, dofId::sp, z, xSp_d);
+  Kokkos::fence();
+
+  const std::chrono::duration<double> elapsed = finishTime - startTime;
+  std::cout << "\nloopTime = " << std::fixed << std::setprecision(10) << elapsed.count();
+  std::cout << "\ndataCollectionTime = " << std::fixed << std::setprecision(10)
+	    << dataCollectionTime << std::endl;
+
+  double memCostMB, flopsCost = 0.;
+  complexityFom<sc_t>(xVp_d, xSp_d, fomObj, forcingObj, memCostMB, flopsCost);
+  printPerf(numSteps, perfTimes, memCostMB, flopsCost);
+  if (hwCounters){
+    printHardwareCounters(*hwCounters, numSteps, elapsed.count(),
+			  memCostMB, perfReport.streamPeakGBs());
+    perfReport.recordCounters(*hwCounters);
+  }
+
+  perfReport.recordRun(numSteps, elapsed.count(), dataCollectionTime,
+		       perfTimes, memCostMB, flopsCost);
+}
+
+}//end namespace kokkosapp
+#endif
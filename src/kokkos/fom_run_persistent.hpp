@@ -0,0 +1,268 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// fom_run_persistent.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef LEAP_FROG_RUN_FOM_PERSISTENT_HPP_
+#define LEAP_FROG_RUN_FOM_PERSISTENT_HPP_
+
+#include "fom_complexities.hpp"
+#include <limits>
+#include <memory>
+
+namespace kokkosapp{
+
+/*
+ * The whole rank-1 time loop as a single parallel region: one team
+ * advances all steps, with team barriers between the half-steps.
+ * The forcing is read from the precomputed time series and the
+ * snapshots/seismogram are written in the region, so there is a single
+ * kernel launch per run. Meant for small meshes where the cost of
+ * launching a few kernels per step dominates.
+ */
+template <class sc_t, class jac_t, class state_t, class rho_inv_t,
+	  class table_t, class snaps_t, class seismo_t, class gids_t>
+struct PersistentTimeLoop
+{
+  using exe_space = typename jac_t::execution_space;
+  using member_t  = typename Kokkos::TeamPolicy<exe_space>::member_type;
+  using ord_t	  = typename jac_t::ordinal_type;
+
+  // row index that matches no row
+  static constexpr std::size_t noRow = ~static_cast<std::size_t>(0);
+
+  sc_t dt_;
+  std::size_t numSteps_;
+  jac_t jacVp_;
+  jac_t jacSp_;
+  state_t xVp_;
+  state_t xSp_;
+  rho_inv_t rhoInvVp_;
+  // forcing value at each step and where it acts
+  table_t f_;
+  std::size_t vpGid_;
+
+  // data collection, a zero frequency disables it
+  snaps_t Avp_;
+  snaps_t Asp_;
+  std::size_t freqVp_;
+  std::size_t freqSp_;
+  seismo_t seismo_;
+  gids_t receiverGids_;
+  std::size_t freqSeismo_;
+
+  // y = y + dt * A * x, plus dt * rhoInvVp * f at row gid,
+  // rows split among the team
+  template <class x_t, class y_t>
+  KOKKOS_INLINE_FUNCTION
+  void applyJacobian(const member_t & member, const jac_t & A,
+		     const x_t & x, const y_t & y,
+		     const std::size_t gid, const sc_t f) const
+  {
+    const auto dt = dt_;
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(member, A.numRows()),
+			 [&](const ord_t iRow)
+			 {
+			   sc_t sum = {};
+			   for (auto k=A.graph.row_map(iRow); k<A.graph.row_map(iRow+1); ++k){
+			     sum += A.values(k) * x(A.graph.entries(k));
+			   }
+			   sc_t value = y(iRow) + dt*sum;
+			   if (static_cast<std::size_t>(iRow) == gid){
+			     value += dt * rhoInvVp_(iRow) * f;
+			   }
+			   y(iRow) = value;
+			 });
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void copyToColumn(const member_t & member, const state_t & x,
+		    const snaps_t & A, const std::size_t col) const
+  {
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(member, x.extent(0)),
+			 [&](const std::size_t i){ A(i, col, 0) = x(i); });
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const member_t & member) const
+  {
+    for (std::size_t iStep=1; iStep<=numSteps_; ++iStep)
+    {
+      // xVp = xVp + dt*jacVp*xSp + dt*rhoInvVp*f
+      applyJacobian(member, jacVp_, xSp_, xVp_, vpGid_, f_(iStep-1));
+      member.team_barrier();
+
+      // xSp = xSp + dt * jacSp * xVp: the velocity is only read
+      // from here on, so it is observed concurrently
+      applyJacobian(member, jacSp_, xVp_, xSp_, noRow, sc_t{});
+      if (freqVp_ > 0 and iStep % freqVp_ == 0){
+	copyToColumn(member, xVp_, Avp_, iStep/freqVp_ - 1);
+      }
+      if (freqSeismo_ > 0 and iStep % freqSeismo_ == 0){
+	const std::size_t col = iStep/freqSeismo_ - 1;
+	Kokkos::parallel_for(Kokkos::TeamThreadRange(member, receiverGids_.extent(0)),
+			     [&](const std::size_t i){
+			       seismo_(i, col, 0) = xVp_(receiverGids_(i));
+			     });
+      }
+      member.team_barrier();
+
+      // the next velocity update only reads the stress
+      if (freqSp_ > 0 and iStep % freqSp_ == 0){
+	copyToColumn(member, xSp_, Asp_, iStep/freqSp_ - 1);
+      }
+    }
+  }
+};
+
+template <
+  typename step_t,
+  typename sc_t,
+  typename app_t,
+  typename forcing_t,
+  typename observer_t,
+  typename seismo_t,
+  typename state_d_t
+  >
+void runFomPersistent(const step_t & numSteps,
+		      const sc_t dt,
+		      const app_t & fomObj,
+		      forcing_t & forcingObj,
+		      observer_t & observerObj,
+		      seismo_t & seismoObj,
+		      state_d_t xVp_d,
+		      state_d_t xSp_d,
+		      PerfReport & perfReport)
+{
+  static_assert(is_kokkos_1dview<state_d_t>::value,
+		"The persistent time loop only supports rank-1 states");
+  // snapshots and seismogram live in host memory and are written in the region
+  if (!std::is_same<typename state_d_t::memory_space, Kokkos::HostSpace>::value){
+    throw std::runtime_error("The persistent time loop needs the states in host memory");
+  }
+
+  using jac_t	  = typename app_t::jacobian_d_type;
+  using exe_space = typename jac_t::execution_space;
+  using policy_t  = Kokkos::TeamPolicy<exe_space>;
+  using rho_inv_t = decltype(fomObj.viewInvDensityDevice(dofId::vp));
+  using table_t	  = decltype(forcingObj.viewSignalTimeSeriesHost());
+  using snaps_t	  = typename std::decay<decltype(observerObj.viewSnapshotMatrix(dofId::vp))>::type;
+  using seis_t	  = typename std::decay<decltype(seismoObj.viewSeismogramMatrix())>::type;
+  using gids_t	  = typename std::decay<decltype(seismoObj.viewMappedGids())>::type;
+  using functor_t = PersistentTimeLoop<sc_t, jac_t, state_d_t, rho_inv_t,
+				       table_t, snaps_t, seis_t, gids_t>;
+
+  KokkosBlas::fill(xVp_d, constants<sc_t>::zero());
+  KokkosBlas::fill(xSp_d, constants<sc_t>::zero());
+
+  const bool snapshotsEnabled = observerObj.enabled();
+  const bool seismogramEnabled = seismoObj.enabled();
+  const std::size_t freqVp = snapshotsEnabled ? observerObj.getSnapshotFreq(dofId::vp) : 0;
+  const std::size_t freqSp = snapshotsEnabled ? observerObj.getSnapshotFreq(dofId::sp) : 0;
+  const std::size_t freqSeismo = seismogramEnabled ? seismoObj.getFreq() : 0;
+
+  functor_t fnc{dt, static_cast<std::size_t>(numSteps),
+		fomObj.viewJacobianDevice(dofId::vp), fomObj.viewJacobianDevice(dofId::sp),
+		xVp_d, xSp_d, fomObj.viewInvDensityDevice(dofId::vp),
+		forcingObj.viewSignalTimeSeriesHost(), forcingObj.getVpGid(),
+		observerObj.viewSnapshotMatrix(dofId::vp),
+		observerObj.viewSnapshotMatrix(dofId::sp),
+		freqVp, freqSp,
+		seismoObj.viewSeismogramMatrix(), seismoObj.viewMappedGids(), freqSeismo};
+
+  // a single team with as many threads as it can have
+  const int teamSize = std::min<int>(exe_space().concurrency(),
+				     policy_t(1, 1).team_size_max(fnc, Kokkos::ParallelForTag()));
+  std::cout << "persistent time loop, teamSize = " << teamSize << std::endl;
+
+  std::unique_ptr<HardwareCounters> hwCounters;
+  if (perfReport.hardwareCounters()){
+    hwCounters.reset(new HardwareCounters());
+    hwCounters->start();
+  }
+
+  const auto startTime = std::chrono::high_resolution_clock::now();
+  {
+    ProfilingRegion region("shaw::persistentTimeLoop");
+    Kokkos::parallel_for("persistentTimeLoop", policy_t(1, teamSize), fnc);
+    Kokkos::fence();
+  }
+  const auto finishTime = std::chrono::high_resolution_clock::now();
+  if (hwCounters){
+    hwCounters->stop();
+  }
+
+  // all columns have been filled in the region
+  if (snapshotsEnabled){
+    observerObj.setNumObserved(dofId::vp, numSteps/freqVp);
+    observerObj.setNumObserved(dofId::sp, numSteps/freqSp);
+  }
+  if (seismogramEnabled){
+    seismoObj.setNumObserved(numSteps/freqSeismo);
+  }
+
+  // steps are not timed one by one and the data collection happens
+  // inside the region, so min, max and collection time are not measured
+  const std::chrono::duration<double> elapsed = finishTime - startTime;
+  const double notTimed = std::numeric_limits<double>::quiet_NaN();
+  const std::array<double, 3> perfTimes = {notTimed, notTimed, elapsed.count()};
+  std::cout << "\nloopTime = " << std::fixed << std::setprecision(10) << elapsed.count();
+  std::cout << "\ndataCollectionTime = n/a" << std::endl;
+
+  double memCostMB, flopsCost = 0.;
+  complexityFom<sc_t>(xVp_d, xSp_d, fomObj, forcingObj, memCostMB, flopsCost);
+  printPerf(numSteps, perfTimes, memCostMB, flopsCost);
+  if (hwCounters){
+    printHardwareCounters(*hwCounters, numSteps, elapsed.count(),
+			  memCostMB, perfReport.streamPeakGBs());
+    perfReport.recordCounters(*hwCounters);
+  }
+
+  perfReport.recordRun(numSteps, elapsed.count(), notTimed, perfTimes, memCostMB, flopsCost);
+}
+
+}//end namespace kokkosapp
+#endif
@@ -0,0 +1,215 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// fom_run_zero_copy.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef LEAP_FROG_RUN_FOM_ZERO_COPY_HPP_
+#define LEAP_FROG_RUN_FOM_ZERO_COPY_HPP_
+
+#include "fom_update_kernels.hpp"
+#include "fom_complexities.hpp"
+#include <memory>
+
+namespace kokkosapp{
+
+/*
+ * Rank-1 time loop for host builds with zero-copy snapshots.
+ * On sampling steps the update is written directly into the next
+ * column of the snapshot matrix, which then holds the state until
+ * the next update reads it. Other steps update xVp_d/xSp_d.
+ * So no copy of the states into the snapshot matrix is ever done.
+ * At the end, the final states are in xVp_d and xSp_d.
+ */
+template <
+  typename step_t,
+  typename sc_t,
+  typename app_t,
+  typename forcing_t,
+  typename observer_t,
+  typename seismo_t,
+  typename state_d_t
+  >
+void runFomZeroCopy(const step_t & numSteps,
+		    const sc_t dt,
+		    const app_t & fomObj,
+		    forcing_t & forcingObj,
+		    observer_t & observerObj,
+		    seismo_t & seismoObj,
+		    state_d_t xVp_d,
+		    state_d_t xSp_d,
+		    PerfReport & perfReport)
+{
+  static_assert(is_kokkos_1dview<state_d_t>::value,
+		"Zero-copy snapshots are only supported for rank-1 states");
+  if (!std::is_same<typename state_d_t::memory_space, Kokkos::HostSpace>::value){
+    throw std::runtime_error("Zero-copy snapshots need the states in host memory");
+  }
+
+  KokkosBlas::fill(xVp_d, constants<sc_t>::zero());
+  KokkosBlas::fill(xSp_d, constants<sc_t>::zero());
+
+  const auto jacVp_d     = fomObj.viewJacobianDevice(dofId::vp);
+  const auto jacSp_d     = fomObj.viewJacobianDevice(dofId::sp);
+  const auto rhoInvVp_d  = fomObj.viewInvDensityDevice(dofId::vp);
+  const auto nVp = xVp_d.extent(0);
+  const auto nSp = xSp_d.extent(0);
+
+  // where the current states are, either xVp_d/xSp_d or a snapshot column
+  state_d_t xVp = xVp_d;
+  state_d_t xSp = xSp_d;
+
+  const bool fencedTiming = perfReport.fencedTiming();
+  const auto forcingId  = perfReport.registerPhase("forcing");
+  const auto velocityId = perfReport.registerPhase("velocityUpdate");
+  const auto stressId   = perfReport.registerPhase("stressUpdate");
+  const auto observeId  = perfReport.registerPhase("observe");
+  const auto stepId     = perfReport.registerPhase("step");
+
+  Kokkos::Timer timer;
+  double dataCollectionTime = {};
+  std::array<double, 3> perfTimes = {1e32,0.,0.}; //min, max, total
+
+  std::unique_ptr<HardwareCounters> hwCounters;
+  if (perfReport.hardwareCounters()){
+    hwCounters.reset(new HardwareCounters());
+    hwCounters->start();
+  }
+
+  //****** LOOP ******//
+  const auto startTime  = std::chrono::high_resolution_clock::now();
+  sc_t timeVp = {};
+  for (std::size_t iStep = 1; iStep<=numSteps; ++iStep)
+  {
+    if (iStep % 2000 == 0) std::cout << "Doing step = " << iStep << std::endl;
+
+    double ct1 = {}, ct2 = {}, ct3 = {}, ctObs = {};
+
+    {
+      ProfilingRegion region("shaw::forcing");
+      timer.reset();
+      forcingObj.evaluate(timeVp, iStep);
+      if (fencedTiming) Kokkos::fence();
+      ct1 = timer.seconds();
+    }
+
+    // ----------------
+    // 1. do velocity, into the snapshot column if this step is sampled
+    {
+      ProfilingRegion region("shaw::velocityUpdate");
+      timer.reset();
+      sc_t * col = observerObj.captureColumn(dofId::vp, iStep);
+      const state_d_t xVpNew = col ? state_d_t(col, nVp) : xVp_d;
+      updateVelocityInto(dt, xVp, xVpNew, xSp, jacVp_d, rhoInvVp_d, forcingObj);
+      xVp = xVpNew;
+      Kokkos::fence();
+      ct2 = timer.seconds();
+    }
+    {
+      ProfilingRegion region("shaw::observe");
+      timer.reset();
+      seismoObj.storeVelocitySignalAtReceivers(iStep, xVp);
+      ctObs += timer.seconds();
+    }
+
+    timeVp = iStep*dt;
+
+    // ----------------
+    // 2. do stress, into the snapshot column if this step is sampled
+    {
+      ProfilingRegion region("shaw::stressUpdate");
+      timer.reset();
+      sc_t * col = observerObj.captureColumn(dofId::sp, iStep);
+      const state_d_t xSpNew = col ? state_d_t(col, nSp) : xSp_d;
+      updateStressInto(dt, xSp, xSpNew, xVp, jacSp_d);
+      xSp = xSpNew;
+      Kokkos::fence();
+      ct3 = timer.seconds();
+    }
+    dataCollectionTime += ctObs;
+
+    const double time = ct1+ct2+ct3;
+    perfTimes[0] = std::min(perfTimes[0], time);
+    perfTimes[1] = std::max(perfTimes[1], time);
+    perfTimes[2] += time;
+
+    if (fencedTiming){
+      perfReport.recordLatency(forcingId,  ct1);
+      perfReport.recordLatency(velocityId, ct2);
+      perfReport.recordLatency(stressId,   ct3);
+      perfReport.recordLatency(observeId,  ctObs);
+      perfReport.recordLatency(stepId,     time+ctObs);
+    }
+  }
+
+  const auto finishTime = std::chrono::high_resolution_clock::now();
+  if (hwCounters){
+    hwCounters->stop();
+  }
+
+  // leave the final states where callers expect them
+  if (xVp.data() != xVp_d.data()) Kokkos::deep_copy(xVp_d, xVp);
+  if (xSp.data() != xSp_d.data()) Kokkos::deep_copy(xSp_d, xSp);
+
+  const std::chrono::duration<double> elapsed = finishTime - startTime;
+  std::cout << "\nloopTime = " << std::fixed << std::setprecision(10) << elapsed.count();
+  std::cout << "\ndataCollectionTime = " << std::fixed << std::setprecision(10)
+	    << dataCollectionTime << std::endl;
+
+  double memCostMB, flopsCost = 0.;
+  complexityFom<sc_t>(xVp_d, xSp_d, fomObj, forcingObj, memCostMB, flopsCost);
+  printPerf(numSteps, perfTimes, memCostMB, flopsCost);
+  if (hwCounters){
+    printHardwareCounters(*hwCounters, numSteps, elapsed.count(),
+			  memCostMB, perfReport.streamPeakGBs());
+    perfReport.recordCounters(*hwCounters);
+  }
+
+  perfReport.recordRun(numSteps, elapsed.count(), dataCollectionTime,
+		       perfTimes, memCostMB, flopsCost);
+}
+
+}//end namespace kokkosapp
+#endif
@@ -56,6 +56,114 @@
 
 namespace kokkosapp{
 
+/*
+ * hand-written alternative to KokkosSparse::spmv for y = y + alpha*A*x,
+ * one row per thread. Which of the two is faster depends on the mesh,
+ * the thread count and the forcing size, see fom_operator_autotune.hpp
+ */
+template <class sc_t, class jac_t, class x_t, class y_t>
+struct CrsApplyRank1
+{
+  using ord_t = typename jac_t::ordinal_type;
+
+  sc_t alpha_;
+  typename jac_t::row_map_type rowMap_;
+  typename jac_t::index_type entries_;
+  typename jac_t::values_type values_;
+  x_t x_;
+  y_t y_;
+
+  CrsApplyRank1(const sc_t & alpha, const jac_t & A, x_t x, y_t y)
+    : alpha_(alpha), rowMap_(A.graph.row_map), entries_(A.graph.entries),
+      values_(A.values), x_(x), y_(y){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ord_t iRow) const
+  {
+    sc_t sum = {};
+    for (auto k=rowMap_(iRow); k<rowMap_(iRow+1); ++k){
+      sum += values_(k) * x_(entries_(k));
+    }
+    y_(iRow) += alpha_*sum;
+  }
+};
+
+template <class sc_t, class jac_t, class x_t, class y_t>
+struct CrsApplyRank2
+{
+  using ord_t = typename jac_t::ordinal_type;
+
+  sc_t alpha_;
+  typename jac_t::row_map_type rowMap_;
+  typename jac_t::index_type entries_;
+  typename jac_t::values_type values_;
+  x_t x_;
+  y_t y_;
+
+  CrsApplyRank2(const sc_t & alpha, const jac_t & A, x_t x, y_t y)
+    : alpha_(alpha), rowMap_(A.graph.row_map), entries_(A.graph.entries),
+      values_(A.values), x_(x), y_(y){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ord_t iRow) const
+  {
+    // the loop over the forcing columns is innermost so that
+    // each nonzero is loaded once for all the columns
+    const auto numCols = y_.extent(1);
+    for (auto k=rowMap_(iRow); k<rowMap_(iRow+1); ++k){
+      const auto a = alpha_ * values_(k);
+      const auto col = entries_(k);
+      for (std::size_t j=0; j<numCols; ++j){
+	y_(iRow, j) += a * x_(col, j);
+      }
+    }
+  }
+};
+
+// y = y + alpha * A * x, rank-1 specialize
+template <typename sc_t, typename jac_d_t, typename x_d_t, typename y_d_t>
+typename std::enable_if<is_kokkos_1dview<y_d_t>::value>::type
+applyOperator(const operatorBackendKind backend,
+	      const sc_t & alpha,
+	      const jac_d_t & A,
+	      x_d_t x,
+	      y_d_t y)
+{
+  if (backend == operatorBackendKind::crsFunctor){
+    using exe_space = typename jac_d_t::execution_space;
+    using functor_t = CrsApplyRank1<sc_t, jac_d_t, x_d_t, y_d_t>;
+    Kokkos::parallel_for("crsApplyRank1",
+			 Kokkos::RangePolicy<exe_space>(0, A.numRows()),
+			 functor_t(alpha, A, x, y));
+  }
+  else{
+    constexpr auto one  = constants<sc_t>::one();
+    KokkosSparse::spmv(KokkosSparse::NoTranspose, alpha, A, x, one, y);
+  }
+}
+
+// y = y + alpha * A * x, rank-2 specialize
+template <typename sc_t, typename jac_d_t, typename x_d_t, typename y_d_t>
+typename std::enable_if<is_kokkos_2dview<y_d_t>::value>::type
+applyOperator(const operatorBackendKind backend,
+	      const sc_t & alpha,
+	      const jac_d_t & A,
+	      x_d_t x,
+	      y_d_t y)
+{
+  if (backend == operatorBackendKind::crsFunctor){
+    using exe_space = typename jac_d_t::execution_space;
+    using functor_t = CrsApplyRank2<sc_t, jac_d_t, x_d_t, y_d_t>;
+    Kokkos::parallel_for("crsApplyRank2",
+			 Kokkos::RangePolicy<exe_space>(0, A.numRows()),
+			 functor_t(alpha, A, x, y));
+  }
+  else{
+    constexpr auto one  = constants<sc_t>::one();
+    KokkosSparse::spmv(KokkosSparse::NoTranspose, alpha, A, x, one, y);
+  }
+}
+
 // rank-1 specialize
 template <
   typename sc_t,
@@ -70,7 +178,8 @@ updateVelocity(const sc_t & dt,
 	       typename state_d_t::const_type xSp_d,
 	       const jac_d_t jacVp_d,
 	       const rho_inv_d_t rhoInvVp_d,
-	       forcing_t & fObj)
+	       forcing_t & fObj,
+	       const operatorBackendKind backend = operatorBackendKind::kokkosSparse)
 {
   /* compute the velocity update:
    *	xVp = xVp + dt*jacVp*xSp + dt*rhoInvVp*f;
@@ -81,7 +190,7 @@ updateVelocity(const sc_t & dt,
    */
 
   constexpr auto one  = constants<sc_t>::one();
-  KokkosSparse::spmv(KokkosSparse::NoTranspose, dt, jacVp_d, xSp_d, one, xVp_d);
+  applyOperator(backend, dt, jacVp_d, xSp_d, xVp_d);
 
   // maybe we should do the following on host directly since
   // for a single forcing, if pointwise, we only change a single element
@@ -95,12 +204,99 @@ typename std::enable_if<is_kokkos_1dview<state_d_t>::value>::type
 updateStress(const sc_t & dt,
 	     state_d_t xSp_d,
 	     const typename state_d_t::const_type xVp_d,
-	     jac_d_t jacSp_d)
+	     jac_d_t jacSp_d,
+	     const operatorBackendKind backend = operatorBackendKind::kokkosSparse)
 {
   // xSp = xSp + dt * Jac * xVp
+  applyOperator(backend, dt, jacSp_d, xVp_d, xSp_d);
+}
 
-  constexpr auto one  = constants<sc_t>::one();
-  KokkosSparse::spmv(KokkosSparse::NoTranspose, dt, jacSp_d, xVp_d, one, xSp_d);
+/*
+ * rank-1 update written to a separate view: yOut = yIn + alpha*A*x
+ * and, if f is not empty, yOut += alpha*rhoInv.*f. Used for zero-copy
+ * snapshots where yOut is a column of the snapshot matrix.
+ * yIn and yOut can be the same view since each row only reads its own entry.
+ */
+template <class sc_t, class jac_t, class x_t, class y_t, class rho_inv_t, class f_t>
+struct CrsUpdateRank1
+{
+  using ord_t = typename jac_t::ordinal_type;
+
+  sc_t alpha_;
+  typename jac_t::row_map_type rowMap_;
+  typename jac_t::index_type entries_;
+  typename jac_t::values_type values_;
+  x_t x_;
+  typename y_t::const_type yIn_;
+  y_t yOut_;
+  rho_inv_t rhoInv_;
+  f_t f_;
+  bool withForcing_;
+
+  CrsUpdateRank1(const sc_t & alpha, const jac_t & A, x_t x,
+		 typename y_t::const_type yIn, y_t yOut,
+		 rho_inv_t rhoInv, f_t f)
+    : alpha_(alpha), rowMap_(A.graph.row_map), entries_(A.graph.entries),
+      values_(A.values), x_(x), yIn_(yIn), yOut_(yOut),
+      rhoInv_(rhoInv), f_(f), withForcing_(f.extent(0) > 0){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ord_t iRow) const
+  {
+    sc_t sum = {};
+    for (auto k=rowMap_(iRow); k<rowMap_(iRow+1); ++k){
+      sum += values_(k) * x_(entries_(k));
+    }
+    sc_t y = yIn_(iRow) + alpha_*sum;
+    if (withForcing_){
+      y += alpha_*rhoInv_(iRow)*f_(iRow);
+    }
+    yOut_(iRow) = y;
+  }
+};
+
+// rank-1 only: xVpOut = xVpIn + dt*jacVp*xSp + dt*rhoInvVp*f
+template <
+  typename sc_t,
+  typename state_d_t,
+  typename jac_d_t,
+  typename rho_inv_d_t,
+  typename forcing_t
+  >
+typename std::enable_if<is_kokkos_1dview<state_d_t>::value>::type
+updateVelocityInto(const sc_t & dt,
+		   typename state_d_t::const_type xVpIn_d,
+		   state_d_t xVpOut_d,
+		   typename state_d_t::const_type xSp_d,
+		   const jac_d_t jacVp_d,
+		   const rho_inv_d_t rhoInvVp_d,
+		   forcing_t & fObj)
+{
+  using exe_space = typename jac_d_t::execution_space;
+  using x_t = typename state_d_t::const_type;
+  auto f_d = fObj.viewForcingDevice();
+  using functor_t = CrsUpdateRank1<sc_t, jac_d_t, x_t, state_d_t, rho_inv_d_t, decltype(f_d)>;
+  Kokkos::parallel_for("crsUpdateVelocity",
+		       Kokkos::RangePolicy<exe_space>(0, jacVp_d.numRows()),
+		       functor_t(dt, jacVp_d, xSp_d, xVpIn_d, xVpOut_d, rhoInvVp_d, f_d));
+}
+
+// rank-1 only: xSpOut = xSpIn + dt * jacSp * xVp
+template <typename sc_t, typename state_d_t, typename jac_d_t>
+typename std::enable_if<is_kokkos_1dview<state_d_t>::value>::type
+updateStressInto(const sc_t & dt,
+		 typename state_d_t::const_type xSpIn_d,
+		 state_d_t xSpOut_d,
+		 typename state_d_t::const_type xVp_d,
+		 const jac_d_t jacSp_d)
+{
+  using exe_space = typename jac_d_t::execution_space;
+  using x_t = typename state_d_t::const_type;
+  using functor_t = CrsUpdateRank1<sc_t, jac_d_t, x_t, state_d_t, state_d_t, state_d_t>;
+  const state_d_t empty;
+  Kokkos::parallel_for("crsUpdateStress",
+		       Kokkos::RangePolicy<exe_space>(0, jacSp_d.numRows()),
+		       functor_t(dt, jacSp_d, xVp_d, xSpIn_d, xSpOut_d, empty, empty));
 }
 
 template <class sc_t, class state_t, class gids_t, class f_t, class rho_inv_t>
@@ -143,15 +339,15 @@ updateVelocity(const sc_t & dt,
 	       typename state_d_t::const_type xSp_d,
 	       const jac_d_t jacVp_d,
 	       const rho_inv_d_t rhoInvVp_d,
-	       forcing_t & fObj)
+	       forcing_t & fObj,
+	       const operatorBackendKind backend = operatorBackendKind::kokkosSparse)
 {
   /*
    *	A1	xVp = xVp + dt * Jvp * xSp
    *	A2	xVp = xVp + dt * rhoInvVp * f
    */
 
-  constexpr auto one  = constants<sc_t>::one();
-  KokkosSparse::spmv(KokkosSparse::NoTranspose, dt, jacVp_d, xSp_d, one, xVp_d);
+  applyOperator(backend, dt, jacVp_d, xSp_d, xVp_d);
   // auto f_d = fObj.viewForcingDevice();
   // KokkosBlas::mult(one, xVp_d, dt, rhoInvVp_d, f_d);
 
@@ -172,12 +368,11 @@ typename std::enable_if<is_kokkos_2dview<state_d_t>::value>::type
 updateStress(const sc_t & dt,
 	     state_d_t xSp_d,
 	     const typename state_d_t::const_type xVp_d,
-	     const jac_d_t jacSp_d)
+	     const jac_d_t jacSp_d,
+	     const operatorBackendKind backend = operatorBackendKind::kokkosSparse)
 {
   // xSp = xSp + dt * Jac * xVp
-
-  constexpr auto one  = constants<sc_t>::one();
-  KokkosSparse::spmv(KokkosSparse::NoTranspose, dt, jacSp_d, xVp_d, one, xSp_d);
+  applyOperator(backend, dt, jacSp_d, xVp_d, xSp_d);
 }
 
 }//end namespace kokkosapp
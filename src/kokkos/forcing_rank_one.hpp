@@ -100,7 +100,6 @@ public:
       NSteps_(parser.getNumSteps()),
       maxFreq_(signalObj.getFrequency())
   {
-    const auto gidsVp = appObj.viewGidListHost(dofId::vp);
     const auto coords = appObj.viewCoordsHost(dofId::vp);
 
     // find the vpGid identifying the grid point where the source is mapped to
@@ -108,7 +107,7 @@ public:
     const sc_t myRadiusKm = domainSurfaceRadiusKm - depthKm;
     mapPointSourceToGridPoint(angleDeg, myRadiusKm, depthKm,
     			      meshInfo.viewDomainBounds(),
-    			      meshInfo.getNumVpPts(), gidsVp, coords,
+    			      appObj.viewVelocitySpatialIndex(), coords,
     			      meshInfo.getAngularSpacing(), myVpGid_);
 
     KokkosBlas::fill(f_h_, constants<sc_t>::zero());
@@ -147,6 +146,17 @@ public:
     return f_d_;
   }
 
+  // value of the signal at each step, step i at index i-1
+  state_h_t viewSignalTimeSeriesHost() const{
+    return f_h_;
+  }
+
+  // identifies the forcing, used to validate checkpoints
+  std::uint64_t fingerprint() const{
+    const auto h = fnv1aHash(&myVpGid_, sizeof(myVpGid_));
+    return fnv1aHash(f_h_.data(), f_h_.span()*sizeof(sc_t), h);
+  }
+
   void evaluate(const sc_t & time, const std::size_t & step)
   {
     const auto src = Kokkos::subview(f_h_, step-1);
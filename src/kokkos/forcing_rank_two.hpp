@@ -99,7 +99,6 @@ public:
     KokkosBlas::fill(f_h_, constants<sc_t>::zero());
     KokkosBlas::fill(f_d_, constants<sc_t>::zero());
 
-    const auto gidsVp = appObj.viewGidListHost(dofId::vp);
     const auto coords = appObj.viewCoordsHost(dofId::vp);
 
     // where this forcing is located
@@ -112,7 +111,7 @@ public:
       // find the vpGid identifying the grid point where the source is mapped to
       mapPointSourceToGridPoint(myAngleDeg, myRadiusKm, depthsKm[i],
 				meshInfo.viewDomainBounds(),
-				meshInfo.getNumVpPts(), gidsVp, coords,
+				appObj.viewVelocitySpatialIndex(), coords,
 				meshInfo.getAngularSpacing(),
 				myVpGids_h_(i));
     }
@@ -136,6 +135,17 @@ public:
     return f_d_;
   }
 
+  // identifies the forcing, used to validate checkpoints
+  std::uint64_t fingerprint() const{
+    auto h = fnv1aHash(myVpGids_h_.data(), myVpGids_h_.span()*sizeof(std::size_t));
+    for (std::size_t i=0; i<signals_.extent(0); ++i){
+      h = fnv1aHashValue(static_cast<int>(signals_(i).getKind()), h);
+      h = fnv1aHashValue(signals_(i).getDelay(), h);
+      h = fnv1aHashValue(signals_(i).getPeriod(), h);
+    }
+    return h;
+  }
+
   auto getForcingAtStep(const std::size_t & step) const{
     return Kokkos::subview(f_h_, step-1, Kokkos::ALL());
   }
@@ -0,0 +1,117 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// index_policy.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef SHAXIPP_KOKKOS_INDEX_POLICY_HPP_
+#define SHAXIPP_KOKKOS_INDEX_POLICY_HPP_
+
+#include <limits>
+
+namespace kokkosapp{
+
+/*
+ * Integer types used to index the sparse operators and the mesh graphs:
+ * ordinal_type stores the CRS column indices and the gids in the graphs,
+ * offset_type stores the CRS row map.
+ * Jacobian rows have two to four nonzeros, so indices are a large share
+ * of the spmv memory traffic: 32-bit types are used by default and the
+ * 64-bit ones only when the mesh does not fit.
+ */
+template <typename ord_t, typename offset_t>
+struct IndexPolicy
+{
+  using ordinal_type = ord_t;
+  using offset_type  = offset_t;
+};
+
+using index32Policy = IndexPolicy<int, int>;
+using index64Policy = IndexPolicy<std::size_t, std::size_t>;
+
+// true if all gids and the nnz of both jacobians are representable,
+// with interleaved states also the positions in the combined state
+template <typename policy_t, typename mesh_info_t>
+bool meshFitsIndexPolicy(const mesh_info_t & meshInfo,
+			 const bool interleavedStates = false)
+{
+  using ord_t	 = typename policy_t::ordinal_type;
+  using offset_t = typename policy_t::offset_type;
+
+  const std::size_t maxOrd    = std::numeric_limits<ord_t>::max();
+  const std::size_t maxOffset = std::numeric_limits<offset_t>::max();
+
+  // velocity rows have at most four nonzeros, stress rows exactly two
+  const std::size_t nVp = meshInfo.getNumVpPts();
+  const std::size_t nSp = meshInfo.getNumSpPts();
+  return nVp <= maxOrd and nSp <= maxOrd
+    and 4*nVp <= maxOffset and 2*nSp <= maxOffset
+    and (!interleavedStates or nVp + nSp <= maxOrd);
+}
+
+/*
+ * Returns true if the 32-bit policy has to be used.
+ * indexWidth = 0 (auto) picks 32-bit whenever the mesh fits and
+ * falls back to 64-bit otherwise, 32 and 64 force the choice.
+ */
+template <typename parser_t, typename mesh_info_t>
+bool useIndex32Policy(const parser_t & parser, const mesh_info_t & meshInfo)
+{
+  const auto width = parser.getIndexWidth();
+  const bool fits  = meshFitsIndexPolicy<index32Policy>(meshInfo, parser.interleavedStates());
+  if (width == 32 and !fits){
+    throw std::runtime_error("indexWidth = 32 but the mesh needs 64-bit indices");
+  }
+
+  const bool use32 = (width == 64) ? false : fits;
+  if (width == 0 and !fits){
+    std::cout << "\nmesh too large for 32-bit indices, falling back to 64-bit";
+  }
+  std::cout << "\nusing " << (use32 ? 32 : 64) << "-bit jacobian and graph indices" << std::endl;
+  return use32;
+}
+
+}//end namespace kokkosapp
+#endif
@@ -0,0 +1,283 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// interleaved_layout.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef SHAXIPP_KOKKOS_INTERLEAVED_LAYOUT_HPP_
+#define SHAXIPP_KOKKOS_INTERLEAVED_LAYOUT_HPP_
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace kokkosapp{
+
+/*
+ * Cell-interleaved placement of the velocity and stress DOFs in a single
+ * state array z. Each stress DOF is owned by the smallest velocity gid it
+ * couples to, and sits right after it in z:
+ *
+ *	z = [vp_0, sp owned by vp_0, vp_1, sp owned by vp_1, ...]
+ *
+ * so the two to four neighbors gathered by each half-step mostly share
+ * cache lines with the row being updated. For each family the operator
+ * is stored with its rows in z order and its columns translated to z
+ * positions. The layout is built from the device jacobians, so it can
+ * be created after the assembly data has been released.
+ */
+template <typename sc_t, typename jac_t>
+class InterleavedStateLayout
+{
+public:
+  using ord_t	     = typename jac_t::ordinal_type;
+  using offset_t     = typename jac_t::size_type;
+  using device_t     = typename jac_t::device_type;
+  using ord_view_t   = Kokkos::View<ord_t*, device_t>;
+  using offset_view_t = Kokkos::View<offset_t*, device_t>;
+  using sc_view_t    = Kokkos::View<sc_t*, device_t>;
+
+  // one family of rows, in z order
+  struct Family
+  {
+    // gid of each row, used to index the per-family arrays
+    ord_view_t rowGid;
+    // position of each row in z
+    ord_view_t rowPos;
+    offset_view_t rowMap;
+    // columns as positions in z
+    ord_view_t cols;
+    sc_view_t vals;
+    // position in z of each gid
+    ord_view_t posOfGid;
+  };
+
+private:
+  std::size_t size_ = {};
+  Family vp_;
+  Family sp_;
+
+public:
+  InterleavedStateLayout(const jac_t & jacVp, const jac_t & jacSp)
+  {
+    const std::size_t nVp = jacVp.numRows();
+    const std::size_t nSp = jacSp.numRows();
+    size_ = nVp + nSp;
+    // positions in z are stored as ord_t
+    if (size_ > static_cast<std::size_t>(std::numeric_limits<ord_t>::max())){
+      throw std::runtime_error("stateLayout: interleaved needs " + std::to_string(size_)
+			       + " positions, more than the jacobian index type can hold");
+    }
+
+    auto spRowMap = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), jacSp.graph.row_map);
+    auto spCols   = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), jacSp.graph.entries);
+
+    // owner of each stress DOF, rows without entries go after the last cell
+    std::vector<std::size_t> owner(nSp, nVp);
+    std::vector<std::size_t> count(nVp+2, 0);
+    for (std::size_t s=0; s<nSp; ++s){
+      for (auto k=spRowMap(s); k<spRowMap(s+1); ++k){
+	owner[s] = std::min<std::size_t>(owner[s], spCols(k));
+      }
+      ++count[owner[s]+1];
+    }
+
+    // stable counting sort of the stress DOFs by owner
+    for (std::size_t g=0; g<=nVp; ++g){
+      count[g+1] += count[g];
+    }
+    std::vector<std::size_t> spOrder(nSp);
+    for (std::size_t s=0; s<nSp; ++s){
+      spOrder[count[owner[s]]++] = s;
+    }
+
+    // walk the cells: each velocity followed by the stresses it owns
+    std::vector<std::size_t> vpPos(nVp), spPos(nSp);
+    std::size_t pos = 0, next = 0;
+    for (std::size_t g=0; g<=nVp; ++g){
+      if (g < nVp){
+	vpPos[g] = pos++;
+      }
+      while (next < nSp and owner[spOrder[next]] == g){
+	spPos[spOrder[next++]] = pos++;
+      }
+    }
+
+    std::vector<std::size_t> vpOrder(nVp);
+    for (std::size_t g=0; g<nVp; ++g){
+      vpOrder[g] = g;
+    }
+
+    // velocity rows read the stresses and vice versa
+    vp_ = makeFamily("vp", jacVp, vpOrder, vpPos, spPos);
+    sp_ = makeFamily("sp", jacSp, spOrder, spPos, vpPos);
+  }
+
+  std::size_t size() const{
+    return size_;
+  }
+
+  const Family & viewFamily(const dofId & dof) const{
+    return (dof == dofId::vp) ? vp_ : sp_;
+  }
+
+  // bytes of the interleaved operators and position maps
+  std::size_t footprintBytes() const{
+    std::size_t bytes = 0;
+    for (const auto * f : {&vp_, &sp_}){
+      bytes += (f->rowGid.span() + f->rowPos.span() + f->cols.span()
+		+ f->posOfGid.span())*sizeof(ord_t)
+	+ f->rowMap.span()*sizeof(offset_t) + f->vals.span()*sizeof(sc_t);
+    }
+    return bytes;
+  }
+
+private:
+  static Family makeFamily(const std::string & name,
+			   const jac_t & A,
+			   const std::vector<std::size_t> & rowOrder,
+			   const std::vector<std::size_t> & rowPositions,
+			   const std::vector<std::size_t> & colPositions)
+  {
+    auto rowMap = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), A.graph.row_map);
+    auto cols   = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), A.graph.entries);
+    auto vals   = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), A.values);
+
+    const std::size_t numRows = rowOrder.size();
+    Family f;
+    f.rowGid   = ord_view_t("interleaved_rowGid_"+name, numRows);
+    f.rowPos   = ord_view_t("interleaved_rowPos_"+name, numRows);
+    f.rowMap   = offset_view_t("interleaved_rowMap_"+name, numRows+1);
+    f.cols     = ord_view_t("interleaved_cols_"+name, cols.extent(0));
+    f.vals     = sc_view_t("interleaved_vals_"+name, vals.extent(0));
+    f.posOfGid = ord_view_t("interleaved_posOfGid_"+name, numRows);
+
+    auto rowGid_h   = Kokkos::create_mirror_view(f.rowGid);
+    auto rowPos_h   = Kokkos::create_mirror_view(f.rowPos);
+    auto rowMap_h   = Kokkos::create_mirror_view(f.rowMap);
+    auto cols_h     = Kokkos::create_mirror_view(f.cols);
+    auto vals_h     = Kokkos::create_mirror_view(f.vals);
+    auto posOfGid_h = Kokkos::create_mirror_view(f.posOfGid);
+
+    offset_t nnz = 0;
+    rowMap_h(0) = 0;
+    for (std::size_t i=0; i<numRows; ++i){
+      const auto gid = rowOrder[i];
+      rowGid_h(i) = static_cast<ord_t>(gid);
+      rowPos_h(i) = static_cast<ord_t>(rowPositions[gid]);
+      posOfGid_h(gid) = static_cast<ord_t>(rowPositions[gid]);
+      for (auto k=rowMap(gid); k<rowMap(gid+1); ++k){
+	cols_h(nnz) = static_cast<ord_t>(colPositions[cols(k)]);
+	vals_h(nnz) = vals(k);
+	++nnz;
+      }
+      rowMap_h(i+1) = nnz;
+    }
+
+    Kokkos::deep_copy(f.rowGid, rowGid_h);
+    Kokkos::deep_copy(f.rowPos, rowPos_h);
+    Kokkos::deep_copy(f.rowMap, rowMap_h);
+    Kokkos::deep_copy(f.cols, cols_h);
+    Kokkos::deep_copy(f.vals, vals_h);
+    Kokkos::deep_copy(f.posOfGid, posOfGid_h);
+    return f;
+  }
+};
+
+/*
+ * one half-step on the interleaved state, rows visited in z order:
+ *	z(rowPos(i)) += alpha * sum_k vals(k)*z(cols(k))
+ * plus alpha*rhoInv(gid)*f(gid) for the velocity rows
+ */
+template <class sc_t, class family_t, class z_t, class rho_inv_t, class f_t>
+struct InterleavedHalfStep
+{
+  sc_t alpha_;
+  family_t fam_;
+  z_t z_;
+  rho_inv_t rhoInv_;
+  f_t f_;
+  bool withForcing_;
+
+  InterleavedHalfStep(const sc_t & alpha, const family_t & fam, z_t z,
+		      rho_inv_t rhoInv, f_t f)
+    : alpha_(alpha), fam_(fam), z_(z), rhoInv_(rhoInv), f_(f),
+      withForcing_(f.extent(0) > 0){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const std::size_t i) const
+  {
+    sc_t sum = {};
+    for (auto k=fam_.rowMap(i); k<fam_.rowMap(i+1); ++k){
+      sum += fam_.vals(k) * z_(fam_.cols(k));
+    }
+    sc_t value = alpha_*sum;
+    if (withForcing_){
+      const auto gid = fam_.rowGid(i);
+      value += alpha_*rhoInv_(gid)*f_(gid);
+    }
+    z_(fam_.rowPos(i)) += value;
+  }
+};
+
+// adapter to the per-family layout: x(gid) = z(posOfGid(gid))
+template <class pos_t, class z_t, class x_t>
+struct GatherFamily
+{
+  pos_t posOfGid_;
+  z_t z_;
+  x_t x_;
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const std::size_t gid) const
+  {
+    x_(gid) = z_(posOfGid_(gid));
+  }
+};
+
+}//end namespace kokkosapp
+#endif
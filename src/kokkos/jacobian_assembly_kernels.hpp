@@ -0,0 +1,229 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// jacobian_assembly_kernels.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef JACOBIAN_ASSEMBLY_KERNELS_HPP_
+#define JACOBIAN_ASSEMBLY_KERNELS_HPP_
+
+namespace kokkosapp{
+
+/*
+ * Kernels used to assemble the FOM Jacobians directly on the
+ * memory space where the CrsMatrix lives.
+ * Assembly is done in two passes:
+ *   1. parallel scan over the rows that counts the nnz of each row
+ *      and writes the exclusive prefix sum into the row map
+ *   2. parallel fill of column indices and values of each row
+ *
+ * Both passes use a static schedule over the same range so that,
+ * on host backends, each thread first-touches the pages of the rows
+ * it will later own during the spmv.
+ */
+
+template <class graph_t, class row_map_t>
+struct VpJacobianRowMapFunctor
+{
+  using value_type = typename row_map_t::non_const_value_type;
+  using ord_t	   = typename graph_t::non_const_value_type;
+
+  graph_t graph_;
+  row_map_t rowMap_;
+  ord_t numRows_;
+
+  VpJacobianRowMapFunctor(graph_t graph, row_map_t rowMap, ord_t numRows)
+    : graph_(graph), rowMap_(rowMap), numRows_(numRows){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ord_t iPt, value_type & update, const bool final) const
+  {
+    // graph col: 1 = west, 2 = north, 3 = east, 4 = south
+    // if two neighbors coincide, they share a single entry
+    value_type thisRowNnz = 0;
+    thisRowNnz += (graph_(iPt, 2) == graph_(iPt, 4)) ? 1 : 2;
+    thisRowNnz += (graph_(iPt, 1) == graph_(iPt, 3)) ? 1 : 2;
+
+    if (final){
+      rowMap_(iPt) = update;
+    }
+    update += thisRowNnz;
+    if (final and iPt == numRows_-1){
+      rowMap_(numRows_) = update;
+    }
+  }
+};
+
+template <
+  class sc_t, class graph_t, class coords_t, class cot_t,
+  class coeff_t, class rho_inv_t, class row_map_t, class ind_t, class val_t
+  >
+struct VpJacobianFillFunctor
+{
+  using ord_t = typename graph_t::non_const_value_type;
+
+  graph_t graph_;
+  coords_t coords_;
+  cot_t cot_;
+  coeff_t coeffs_;
+  rho_inv_t rhoInv_;
+  row_map_t rowMap_;
+  ind_t ind_;
+  val_t val_;
+  sc_t dthInv_;
+  sc_t drrInv_;
+  sc_t oneHalf_;
+  sc_t three_;
+
+  VpJacobianFillFunctor(graph_t graph, coords_t coords, cot_t cot,
+			coeff_t coeffs, rho_inv_t rhoInv,
+			row_map_t rowMap, ind_t ind, val_t val,
+			const sc_t & dthInv, const sc_t & drrInv)
+    : graph_(graph), coords_(coords), cot_(cot), coeffs_(coeffs),
+      rhoInv_(rhoInv), rowMap_(rowMap), ind_(ind), val_(val),
+      dthInv_(dthInv), drrInv_(drrInv),
+      oneHalf_(constants<sc_t>::one()/constants<sc_t>::two()),
+      three_(constants<sc_t>::three()){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ord_t iPt) const
+  {
+    const auto ptGID	 = graph_(iPt, 0);
+    const auto gid_west	 = graph_(iPt, 1);
+    const auto gid_north = graph_(iPt, 2);
+    const auto gid_east	 = graph_(iPt, 3);
+    const auto gid_south = graph_(iPt, 4);
+    const auto rInv	 = coords_(ptGID, 1);
+    const auto cot	 = cot_(ptGID);
+    const auto rhoInv	 = rhoInv_(iPt);
+
+    const auto c_west  = (-rInv*dthInv_ + rInv*cot)*coeffs_(iPt, 0)*rhoInv;
+    const auto c_north = (drrInv_ + three_*oneHalf_*rInv)*coeffs_(iPt, 1)*rhoInv;
+    const auto c_east  = (rInv*dthInv_ + rInv*cot)*coeffs_(iPt, 2)*rhoInv;
+    const auto c_south = (-drrInv_ + three_*oneHalf_*rInv)*coeffs_(iPt, 3)*rhoInv;
+
+    // entries are ordered as: north, (south), west, (east)
+    auto k = rowMap_(iPt);
+    if (gid_north == gid_south){
+      ind_(k) = gid_north; val_(k++) = c_north+c_south;
+    }
+    else{
+      ind_(k) = gid_north; val_(k++) = c_north;
+      ind_(k) = gid_south; val_(k++) = c_south;
+    }
+
+    if (gid_west == gid_east){
+      ind_(k) = gid_west; val_(k++) = c_west+c_east;
+    }
+    else{
+      ind_(k) = gid_west; val_(k++) = c_west;
+      ind_(k) = gid_east; val_(k++) = c_east;
+    }
+  }
+};
+
+template <
+  class sc_t, class graph_t, class coords_t, class cot_t,
+  class labels_t, class shmod_acc_t, class row_map_t, class ind_t, class val_t
+  >
+struct SpJacobianFillFunctor
+{
+  using ord_t = typename graph_t::non_const_value_type;
+
+  graph_t graph_;
+  coords_t coords_;
+  cot_t cot_;
+  labels_t labels_;
+  // see material_property_accessors.hpp
+  shmod_acc_t shearMod_;
+  row_map_t rowMap_;
+  ind_t ind_;
+  val_t val_;
+  sc_t dthInv_;
+  sc_t drrInv_;
+  sc_t oneHalf_;
+
+  SpJacobianFillFunctor(graph_t graph, coords_t coords, cot_t cot,
+			labels_t labels, shmod_acc_t shearMod,
+			row_map_t rowMap, ind_t ind, val_t val,
+			const sc_t & dthInv, const sc_t & drrInv)
+    : graph_(graph), coords_(coords), cot_(cot), labels_(labels),
+      shearMod_(shearMod), rowMap_(rowMap), ind_(ind), val_(val),
+      dthInv_(dthInv), drrInv_(drrInv),
+      oneHalf_(constants<sc_t>::one()/constants<sc_t>::two()){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ord_t iPt) const
+  {
+    // every stress row has exactly two nonzeros,
+    // so the prefix sum of the row counts is known in closed form
+    const auto k = 2*iPt;
+    rowMap_(iPt+1) = k+2;
+    if (iPt == 0){ rowMap_(0) = 0; }
+
+    const auto ptGID	= graph_(iPt, 0);
+    const auto rInv	= coords_(ptGID, 1);
+    const auto myLabel	= labels_(iPt);
+    const auto shearMod = shearMod_(iPt, rInv);
+
+    if (myLabel==1){ //srp: north, south
+      ind_(k)   = graph_(iPt, 1);
+      val_(k)   = (drrInv_ - rInv*oneHalf_)*shearMod;
+      ind_(k+1) = graph_(iPt, 2);
+      val_(k+1) = (-drrInv_ - rInv*oneHalf_)*shearMod;
+    }
+
+    if (myLabel==2){ //stp: west, east
+      const auto cot = cot_(ptGID);
+      ind_(k)   = graph_(iPt, 1);
+      val_(k)   = (-dthInv_ - oneHalf_*cot)*rInv*shearMod;
+      ind_(k+1) = graph_(iPt, 2);
+      val_(k+1) = (dthInv_ - oneHalf_*cot)*rInv*shearMod;
+    }
+  }
+};
+
+}//end namespace kokkosapp
+#endif
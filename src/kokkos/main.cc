@@ -5,8 +5,15 @@
 #include "../shared/all.hpp"
 #include "types.hpp"
 #include "shwavepp.hpp"
+#include "snapshot_selection.hpp"
 // fom
 #include "fom_run.hpp"
+#include "fom_operator_autotune.hpp"
+#include "fom_run_zero_copy.hpp"
+#include "fom_run_persistent.hpp"
+#include "fom_run_interleaved.hpp"
+#include "fom_run_ensemble.hpp"
+#include "output_buffer_pool.hpp"
 #include "fom_problem_rank_one.hpp"
 #include "fom_problem_rank_two.hpp"
 // rom
@@ -14,6 +21,8 @@
 #include "rom_compute_jacobians.hpp"
 #include "rom_run_rank_one.hpp"
 #include "rom_problem_rank_one.hpp"
+// dry run
+#include "dry_run.hpp"
 
 template<typename scalar_t>
 struct MyCustomMaterialModel final
@@ -38,6 +47,70 @@ struct MyCustomMaterialModel final
   }
 };
 
+/*
+ * everything after reading the input and the mesh info,
+ * index_policy sets the integer types of jacobians and graphs
+ */
+template <typename index_policy, typename parser_t, typename mesh_info_t>
+void runShaw(const parser_t & parser, const mesh_info_t & meshInfo)
+{
+  using rank1_types	= kokkosapp::rank1TypesWithIndex<index_policy>;
+  using rank2_types	= kokkosapp::rank2TypesWithIndex<index_policy>;
+  using rank1_rom_types = kokkosapp::rank1TypesRomWithIndex<index_policy>;
+  using scalar_t	= typename rank1_types::scalar_type;
+
+  // only predict memory and time from the input file and mesh_info.dat,
+  // nothing else is constructed
+  if (parser.dryRun()){
+    if (parser.enableRom()){
+      kokkosapp::dryRun<rank1_rom_types>(parser, meshInfo);
+    }
+    else if (parser.rank2Enabled()){
+      kokkosapp::dryRun<rank2_types>(parser, meshInfo);
+    }
+    else{
+      kokkosapp::dryRun<rank1_types>(parser, meshInfo);
+    }
+    return;
+  }
+
+  // create material model object
+  // if parser has custom model, use custom class above
+  std::shared_ptr<MaterialModelBase<scalar_t>> materialModel = {};
+  if (parser.getMaterialModelKind() == materialModelKind::custom){
+    materialModel = std::make_shared<MyCustomMaterialModel<scalar_t>>(meshInfo);
+  }
+  else{
+    materialModel = createMaterialModel<scalar_t>(parser, meshInfo);
+  }
+
+  // branch out for FOM or ROM
+  if (parser.enableRom())
+  {
+    // if here, we want to run ROM
+    using prob_t = kokkosapp::RomProblemRankOneForcing<rank1_rom_types>;
+    prob_t problem(parser, meshInfo, *materialModel);
+    problem();
+
+  }
+  else
+  {
+    // if here, we want to run FOM
+
+    if(parser.rank2Enabled())
+      {
+	using prob_t = kokkosapp::FomProblemRankTwoForcing<rank2_types>;
+	prob_t problem(parser, meshInfo, *materialModel);
+	problem();
+      }
+    else{
+      using prob_t = kokkosapp::FomProblemRankOneForcing<rank1_types>;
+      prob_t problem(parser, meshInfo, *materialModel);
+      problem();
+    }
+  }
+}
+
 int main(int argc, char *argv[])
 {
   Kokkos::initialize (argc, argv);
@@ -48,44 +121,19 @@ int main(int argc, char *argv[])
 
     // create parser for input file
     parser_t parser(argc, argv);
+    setTextIoThreads(parser.getAsciiThreads());
 
-    // create object with mesh info
-    mesh_info_t meshInfo(parser.getMeshDir());
+    // create object with mesh info, read from file or generated in memory
+    Kokkos::Profiling::pushRegion("shaw::meshRead");
+    const mesh_info_t meshInfo = createMeshInfo<scalar_t>(parser);
+    Kokkos::Profiling::popRegion();
 
-    // create material model object
-    // if parser has custom model, use custom class above
-    std::shared_ptr<MaterialModelBase<scalar_t>> materialModel = {};
-    if (parser.getMaterialModelKind() == materialModelKind::custom){
-      materialModel = std::make_shared<MyCustomMaterialModel<scalar_t>>(meshInfo);
+    // 32-bit indices unless the mesh is too large for them
+    if (kokkosapp::useIndex32Policy(parser, meshInfo)){
+      runShaw<kokkosapp::index32Policy>(parser, meshInfo);
     }
     else{
-      materialModel = createMaterialModel<scalar_t>(parser, meshInfo);
-    }
-
-    // branch out for FOM or ROM
-    if (parser.enableRom())
-    {
-      // if here, we want to run ROM
-      using prob_t = kokkosapp::RomProblemRankOneForcing<kokkosapp::rank1TypesRom>;
-      prob_t problem(parser, meshInfo, *materialModel);
-      problem();
-
-    }
-    else
-    {
-      // if here, we want to run FOM
-
-      if(parser.rank2Enabled())
-	{
-	  using prob_t = kokkosapp::FomProblemRankTwoForcing<kokkosapp::rank2Types>;
-	  prob_t problem(parser, meshInfo, *materialModel);
-	  problem();
-	}
-      else{
-	using prob_t = kokkosapp::FomProblemRankOneForcing<kokkosapp::rank1Types>;
-	prob_t problem(parser, meshInfo, *materialModel);
-	problem();
-      }
+      runShaw<kokkosapp::index64Policy>(parser, meshInfo);
     }
   }
   Kokkos::finalize();
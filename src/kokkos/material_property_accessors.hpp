@@ -0,0 +1,111 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// material_property_accessors.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef MATERIAL_PROPERTY_ACCESSORS_HPP_
+#define MATERIAL_PROPERTY_ACCESSORS_HPP_
+
+namespace kokkosapp{
+
+/*
+ * Accessors used by the Jacobian assembly to read a material
+ * property at a grid point given its index and its 1/radius.
+ */
+
+// the property is stored for every grid point
+template <class values_t>
+struct PointwiseMaterialAccessor
+{
+  using sc_t = typename values_t::non_const_value_type;
+  values_t values_;
+
+  PointwiseMaterialAccessor(values_t values) : values_(values){}
+
+  template <class ord_t>
+  KOKKOS_INLINE_FUNCTION
+  sc_t operator() (const ord_t iPt, const sc_t & /*rInv*/) const{
+    return values_(iPt);
+  }
+};
+
+// the property is stored once per distinct radius:
+// keys_ holds the distinct values of 1/radius sorted ascending
+// and values_(k) is the property at the radius of keys_(k)
+template <class keys_t, class values_t>
+struct RadialMaterialAccessor
+{
+  using sc_t = typename values_t::non_const_value_type;
+  keys_t keys_;
+  values_t values_;
+
+  RadialMaterialAccessor(keys_t keys, values_t values)
+    : keys_(keys), values_(values){}
+
+  KOKKOS_INLINE_FUNCTION
+  std::size_t findRadialIndex(const sc_t & rInv) const
+  {
+    // keys are exactly the 1/r values of the grid points,
+    // so this finds the matching entry
+    std::size_t lo = 0;
+    std::size_t hi = keys_.extent(0);
+    while (hi - lo > 1){
+      const std::size_t mid = lo + (hi-lo)/2;
+      if (keys_(mid) <= rInv) lo = mid;
+      else hi = mid;
+    }
+    return lo;
+  }
+
+  template <class ord_t>
+  KOKKOS_INLINE_FUNCTION
+  sc_t operator() (const ord_t /*iPt*/, const sc_t & rInv) const{
+    return values_(findRadialIndex(rInv));
+  }
+};
+
+}//end namespace kokkosapp
+#endif
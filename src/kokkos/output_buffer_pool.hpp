@@ -0,0 +1,176 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// output_buffer_pool.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef OUTPUT_BUFFER_POOL_HPP_
+#define OUTPUT_BUFFER_POOL_HPP_
+
+namespace kokkosapp{
+
+/*
+ * Number of observer/seismogram buffer sets for the output of a
+ * multi-forcing run: one (synchronous write) unless asyncWrite is on,
+ * otherwise as many as requested that fit in the memory budget.
+ * With checkpointing, the output of a sample must be on disk before
+ * the checkpoints of the next one are written, so we write synchronously.
+ */
+template <typename parser_t>
+std::size_t numOutputBuffers(const parser_t & parser,
+			     const std::size_t bytesPerBuffer,
+			     const bool checkpointEnabled)
+{
+  if (!parser.enableAsyncWrite()){
+    return 1;
+  }
+  if (checkpointEnabled){
+    std::cout << "asyncWrite is ignored when checkpointing is on" << std::endl;
+    return 1;
+  }
+
+  std::size_t n = parser.getAsyncWriteBuffers();
+  const double budget = parser.getAsyncWriteMemoryBudget()*1024.*1024.*1024.;
+  if (budget > 0. and bytesPerBuffer > 0){
+    n = std::min(n, static_cast<std::size_t>(budget/bytesPerBuffer));
+  }
+  n = std::max<std::size_t>(n, 1);
+  std::cout << "Number of output buffers = " << n << std::endl;
+  return n;
+}
+
+/*
+ * Set of observer/seismogram buffers used in turn by the samples of a
+ * multi-forcing run. When a sample is done, its buffers are handed to a
+ * background writer and the next sample runs with the next buffers,
+ * after waiting for their previous write to complete if still pending.
+ * With a single set of buffers, writes are synchronous.
+ */
+template <typename observer_t, typename seismo_t>
+class OutputBufferPool
+{
+  std::vector<observer_t> observers_;
+  std::vector<seismo_t> seismos_;
+  // write of each set still in flight, the value is the write time
+  std::vector<std::future<double>> pending_;
+  std::size_t current_ = 0;
+  PerfReport & perfReport_;
+  // declared last so that it finishes pending writes before
+  // the buffers are destroyed, only created for multiple sets
+  std::unique_ptr<BackgroundWriter> writer_;
+
+public:
+  OutputBufferPool(std::vector<observer_t> observers,
+		   std::vector<seismo_t> seismos,
+		   PerfReport & perfReport)
+    : observers_(std::move(observers)),
+      seismos_(std::move(seismos)),
+      pending_(observers_.size()),
+      perfReport_(perfReport)
+  {
+    if (observers_.empty() or observers_.size() != seismos_.size()){
+      throw std::runtime_error("OutputBufferPool needs the same number of observers and seismograms");
+    }
+    if (observers_.size() > 1){
+      writer_.reset(new BackgroundWriter());
+    }
+  }
+
+  observer_t & observer(){ return observers_[current_]; }
+  seismo_t & seismogram(){ return seismos_[current_]; }
+
+  /*
+   * write is called as write(observer, seismogram) and returns the
+   * seconds spent writing. It runs on the background writer, so it
+   * must only read the buffers it is given.
+   */
+  template <typename write_t>
+  void writeAndAdvance(write_t write)
+  {
+    if (!writer_){
+      ProfilingRegion region("shaw::write");
+      record(write(observers_[0], seismos_[0]));
+      return;
+    }
+
+    const auto & observerObj = observers_[current_];
+    const auto & seismoObj   = seismos_[current_];
+    pending_[current_] = writer_->submit([write, &observerObj, &seismoObj](){
+					   return write(observerObj, seismoObj);
+					 });
+    current_ = (current_+1) % observers_.size();
+    wait(current_);
+  }
+
+  void waitAll(){
+    for (std::size_t i=0; i<pending_.size(); ++i){
+      wait(i);
+    }
+  }
+
+private:
+  void wait(const std::size_t i)
+  {
+    if (pending_[i].valid()){
+      ProfilingRegion region("shaw::writeWait");
+      const auto startTime = std::chrono::high_resolution_clock::now();
+      const double writeTime = pending_[i].get();
+      const std::chrono::duration<double> elapsed =
+	std::chrono::high_resolution_clock::now() - startTime;
+      perfReport_.accumulateTime("writeWait", elapsed.count());
+      record(writeTime);
+    }
+  }
+
+  void record(const double writeTime)
+  {
+    perfReport_.accumulateTime("write", writeTime);
+    std::cout << "\nfinalProcessTime = " << std::fixed << std::setprecision(10) << writeTime;
+    std::cout << "\n";
+  }
+};
+
+}//end namespace kokkosapp
+#endif
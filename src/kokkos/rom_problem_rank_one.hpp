@@ -110,6 +110,10 @@ public:
       Jvp_d_("romJvp_d", nVp_, nSp_),
       Jsp_d_("romJsp_d", nSp_, nVp_)
   {
+    // the rom states are not indexed by grid point
+    if (parser.restrictSnapshots()){
+      throw std::runtime_error("snapshotMatrix restrict is not supported for ROM runs");
+    }
     fillBasis<mesh_ord_type, scalar_type>(parser_, phiVp_d_, phiSp_d_);
   }
 
@@ -177,7 +181,17 @@ private:
     {
       const auto startTime  = std::chrono::high_resolution_clock::now();
 
-      if(parser_.enableSnapshotMatrix()){
+      if (parser_.enableContainer()){
+	SampleContainerWriter container(parser_.getContainerFileName(),
+					parser_.getContainerTileRows(),
+					parser_.getContainerTileCols());
+	container.addSample({iSample, parser_.viewDepths()[0], parser_.viewPeriods()[0],
+			     parser_.viewAngles()[0], parser_.viewDelays()[0],
+			     signalKindToString(parser_.getSourceSignalKind())});
+	observerObj_.writeSnapshotMatrixToContainer(dofId::vp, container);
+	observerObj_.writeSnapshotMatrixToContainer(dofId::sp, container);
+      }
+      else if(parser_.enableSnapshotMatrix()){
 	observerObj_.writeSnapshotMatrixToFile(dofId::vp);
 	observerObj_.writeSnapshotMatrixToFile(dofId::sp);
       }
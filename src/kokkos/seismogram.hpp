@@ -60,6 +60,11 @@ struct CopySeis
   CopySeis(std::size_t count, gids_t gids, state_t x, dest_t M)
     : count_(count), gids_(gids), x_(x), M_(M){}
 
+  // rank-1: one receiver per iteration, rank-2: one realization per iteration
+  std::size_t numIterations() const{
+    return is_kokkos_2dview<state_t>::value ? M_.extent(2) : gids_.extent(0);
+  }
+
   template <typename _state_t = state_t>
   KOKKOS_INLINE_FUNCTION
   typename std::enable_if<is_kokkos_1dview<_state_t>::value>::type
@@ -71,9 +76,10 @@ struct CopySeis
   template <typename _state_t = state_t>
   KOKKOS_INLINE_FUNCTION
   typename std::enable_if<is_kokkos_2dview<_state_t>::value>::type
-  operator() (const std::size_t & i) const
+  operator() (const std::size_t & j) const
   {
-    for (std::size_t j=0; j<M_.extent(2); ++j)
+    // unit-stride writes into the matrix of realization j
+    for (std::size_t i=0; i<gids_.extent(0); ++i)
       M_(i, count_, j) = x_(gids_(i), j);
   }
 };
@@ -95,6 +101,9 @@ class Seismogram
   // whether we need to store in binary
   bool useBinaryIO_   = {};
 
+  // write each realization of a rank-2 run to its own file
+  bool splitRealizations_ = {};
+
   // filename to store seigmogram data
   std::string seismoFileName_ = {};
 
@@ -115,6 +124,8 @@ class Seismogram
 
   // runID used when we run many samples to prepend file
   std::size_t runID_ = 0;
+  // sample ID of the first realization stored
+  std::size_t firstSampleID_ = 0;
 
 public:
   template <typename parser_t, typename mesh_info_t, typename app_t>
@@ -124,6 +135,7 @@ public:
 	     std::size_t fSize = 1)
     : enable_{parser.enableSeismogram()},
       useBinaryIO_(parser.writeSeismogramBinary()),
+      splitRealizations_(parser.splitSeismogramRealizations()),
       seismoFileName_{parser.getSeismogramFileName()}
   {
     if (enable_){
@@ -151,8 +163,7 @@ public:
 	  (thisAngle,
 	   receiverRadM,
 	   meshInfo.viewDomainBounds(),
-	   meshInfo.getNumVpPts(),
-	   appObj.viewGidListHost(dofId::vp),
+	   appObj.viewVelocitySpatialIndex(),
 	   appObj.viewCoordsHost(dofId::vp));
       }
       std::cout << "Done Mapping receivers to grid " << std::endl;
@@ -179,14 +190,42 @@ public:
     return enable_;
   }
 
+  // change the number of forcing realizations stored
+  void setForcingSize(const std::size_t fSize){
+    if (enable_ and MM_.extent(2) != fSize){
+      Kokkos::realloc(MM_, MM_.extent(0), MM_.extent(1), fSize);
+    }
+  }
+
   const gids_t & viewMappedGids() const{
     return targetGids_;
   }
 
-  void prepForNewRun(const std::size_t & sampleID){
+  const matrix_t & viewSeismogramMatrix() const{
+    return MM_;
+  }
+
+  std::size_t getFreq() const{
+    return freq_;
+  }
+
+  // for time loops that fill the data matrix themselves
+  void setNumObserved(const std::size_t n){
+    count_ = n;
+  }
+
+  // bytes of the data matrix
+  std::size_t sizeInBytes() const{
+    return MM_.size() * sizeof(scalar_t);
+  }
+
+  // firstSampleID is the sample of the first realization stored
+  void prepForNewRun(const std::size_t & sampleID,
+		     const std::size_t firstSampleID = 0){
     // assumes the new run has same sampling frequncies as before
     count_ = {0};
     runID_ = sampleID;
+    firstSampleID_ = firstSampleID;
   }
 
   template <typename state_t>
@@ -206,13 +245,34 @@ public:
 	// must specify an host exespace here otherwise it picks the default
 	// which might be a device one
 	using copy_exespace = Kokkos::DefaultHostExecutionSpace;
-	Kokkos::RangePolicy<copy_exespace> policy(0, targetGids_.extent(0));
+	Kokkos::RangePolicy<copy_exespace> policy(0, fnc.numIterations());
 	Kokkos::parallel_for(policy, fnc);
 	count_++;
       }
     }
   }
 
+  // store/load counter and data collected so far, used by FomCheckpoint
+  void writeCheckpoint(std::ostream & os) const
+  {
+    impl::write_pod_to_binary(os, enable_);
+    if (enable_){
+      writeLeadingColumnsToBinary(os, MM_, count_);
+    }
+  }
+
+  void readCheckpoint(std::istream & is)
+  {
+    bool enabledInCheckpoint = false;
+    impl::read_pod_from_binary(is, enabledInCheckpoint);
+    if (enabledInCheckpoint != enable_){
+      throw std::runtime_error("Checkpoint and current run differ in seismogram collection");
+    }
+    if (enable_){
+      count_ = readLeadingColumnsFromBinary(is, MM_);
+    }
+  }
+
   void writeReceiversToFile() const
   {
     // for seismogram we do NOT want extents written to file
@@ -225,12 +285,39 @@ public:
 	const auto Mv = Kokkos::subview(MM_, Kokkos::ALL(), Kokkos::ALL(), 0);
 	writeToFile(fN2, Mv, useBinaryIO_, writeExtentsToFile);
       }
+      else if (splitRealizations_){
+	// the matrix of each realization is contiguous, so it is
+	// written as is to a file named after its sample ID
+	for (std::size_t j=0; j<MM_.extent(2); ++j){
+	  const auto Mv = Kokkos::subview(MM_, Kokkos::ALL(), Kokkos::ALL(), j);
+	  writeToFile(seismoFileName_ + "_" + std::to_string(firstSampleID_ + j),
+		      Mv, useBinaryIO_, writeExtentsToFile);
+	}
+      }
       else{
 	writeToFile(fN2, MM_, useBinaryIO_, writeExtentsToFile);
       }
       std::cout << "... Done" << std::endl;
     }
   }
+
+  // appends the seismogram of each realization to the container,
+  // named after the seismogram file
+  template <typename container_t>
+  void writeReceiversToContainer(container_t & container) const
+  {
+    if (enable_){
+      std::cout << "Writing seismogram to " << container.getFileName();
+      for (std::size_t j=0; j<MM_.extent(2); ++j){
+	container.addMatrix(seismoFileName_, firstSampleID_ + j,
+			    MM_.extent(0), MM_.extent(1),
+			    [this, j](const std::size_t r, const std::size_t c){
+			      return MM_(r, c, j);
+			    });
+      }
+      std::cout << "... Done" << std::endl;
+    }
+  }
 };
 
 #endif
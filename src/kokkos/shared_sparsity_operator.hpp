@@ -0,0 +1,318 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// shared_sparsity_operator.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef SHAXIPP_KOKKOS_SHARED_SPARSITY_OPERATOR_HPP_
+#define SHAXIPP_KOKKOS_SHARED_SPARSITY_OPERATOR_HPP_
+
+#include "fom_update_kernels.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace kokkosapp{
+
+// y(s) += alpha * sum_e vals(2s+e) * x(cols(2s+e)), one stress row per thread
+template <class sc_t, class ord_view_t, class sc_view_t, class x_t, class y_t>
+struct SharedSparsityGather
+{
+  sc_t alpha_;
+  ord_view_t cols_;
+  sc_view_t vals_;
+  x_t x_;
+  y_t y_;
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const std::size_t s) const
+  {
+    const auto c0 = cols_(2*s);
+    const auto c1 = cols_(2*s+1);
+    const auto a0 = alpha_*vals_(2*s);
+    const auto a1 = alpha_*vals_(2*s+1);
+    for (std::size_t j=0; j<y_.extent(1); ++j){
+      y_.access(s, j) += a0*x_.access(c0, j) + a1*x_.access(c1, j);
+    }
+  }
+};
+
+// y(cols(2s+e)) += alpha * vals(2s+e) * x(s) for the stress rows s of
+// one color: rows of the same color share no column, so there are no conflicts
+template <class sc_t, class ord_view_t, class sc_view_t, class x_t, class y_t>
+struct SharedSparsityScatter
+{
+  sc_t alpha_;
+  ord_view_t rows_;
+  ord_view_t cols_;
+  sc_view_t vals_;
+  x_t x_;
+  y_t y_;
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const std::size_t i) const
+  {
+    const std::size_t s = rows_(i);
+    const auto c0 = cols_(2*s);
+    const auto c1 = cols_(2*s+1);
+    const auto a0 = alpha_*vals_(2*s);
+    const auto a1 = alpha_*vals_(2*s+1);
+    for (std::size_t j=0; j<y_.extent(1); ++j){
+      y_.access(c0, j) += a0*x_.access(s, j);
+      y_.access(c1, j) += a1*x_.access(s, j);
+    }
+  }
+};
+
+/*
+ * The two FOM operators with a single connectivity. Every stress row
+ * couples to exactly two velocity points, and every nonzero (i,s) of
+ * JacVp is the transpose of a nonzero (s,i) of JacSp, so only the
+ * column indices of JacSp are stored, with an implicit row map, together
+ * with one value per entry for each operator:
+ *
+ *	JacSp * xVp: row-parallel gather over the stress rows
+ *	JacVp * xSp: transpose apply, scattering each stress row into its
+ *		     two velocity points, one color at a time
+ *
+ * The stress rows are greedily colored so that the rows of a color
+ * touch distinct velocity points, which avoids atomics.
+ */
+template <typename sc_t, typename jac_t>
+class SharedSparsityOperator
+{
+public:
+  using ord_t	   = typename jac_t::ordinal_type;
+  using device_t   = typename jac_t::device_type;
+  using exe_space  = typename jac_t::execution_space;
+  using ord_view_t = Kokkos::View<ord_t*, device_t>;
+  using sc_view_t  = Kokkos::View<sc_t*, device_t>;
+
+private:
+  std::size_t numVp_ = {};
+  std::size_t numSp_ = {};
+  std::size_t nnzVp_ = {};
+  // velocity columns of stress row s at 2s and 2s+1
+  ord_view_t cols_;
+  sc_view_t valsSp_;
+  // entry of JacVp transposed onto each stress entry, zero if none
+  sc_view_t valsVp_;
+  // stress rows sorted by color
+  ord_view_t rowsByColor_;
+  std::vector<std::size_t> colorOffsets_;
+
+public:
+  SharedSparsityOperator() = default;
+
+  SharedSparsityOperator(const jac_t & jacVp, const jac_t & jacSp)
+    : numVp_(jacVp.numRows()), numSp_(jacSp.numRows()), nnzVp_(jacVp.nnz())
+  {
+    auto vpRowMap = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), jacVp.graph.row_map);
+    auto vpCols   = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), jacVp.graph.entries);
+    auto vpVals   = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), jacVp.values);
+    auto spRowMap = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), jacSp.graph.row_map);
+    auto spCols   = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), jacSp.graph.entries);
+    auto spVals   = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), jacSp.values);
+
+    for (std::size_t s=0; s<=numSp_; ++s){
+      if (static_cast<std::size_t>(spRowMap(s)) != 2*s){
+	throw std::runtime_error("sharedSparsity: every stress row must have two nonzeros");
+      }
+    }
+
+    cols_   = ord_view_t("sharedCols", 2*numSp_);
+    valsSp_ = sc_view_t("sharedValsSp", 2*numSp_);
+    valsVp_ = sc_view_t("sharedValsVp", 2*numSp_);
+    auto cols_h   = Kokkos::create_mirror_view(cols_);
+    auto valsSp_h = Kokkos::create_mirror_view(valsSp_);
+    auto valsVp_h = Kokkos::create_mirror_view(valsVp_);
+
+    // match each stress entry (s,i) with the entry (i,s) of JacVp
+    std::vector<bool> matched(nnzVp_, false);
+    for (std::size_t k=0; k<2*numSp_; ++k){
+      const std::size_t s = k/2;
+      const auto i = spCols(k);
+      cols_h(k)	  = i;
+      valsSp_h(k) = spVals(k);
+      valsVp_h(k) = {};
+      for (auto kv=vpRowMap(i); kv<vpRowMap(i+1); ++kv){
+	if (static_cast<std::size_t>(vpCols(kv)) == s and !matched[kv]){
+	  valsVp_h(k) = vpVals(kv);
+	  matched[kv] = true;
+	  break;
+	}
+      }
+    }
+    for (std::size_t kv=0; kv<nnzVp_; ++kv){
+      if (!matched[kv]){
+	throw std::runtime_error("sharedSparsity: JacVp is not the transpose pattern of JacSp");
+      }
+    }
+
+    Kokkos::deep_copy(cols_, cols_h);
+    Kokkos::deep_copy(valsSp_, valsSp_h);
+    Kokkos::deep_copy(valsVp_, valsVp_h);
+
+    colorStressRows(cols_h);
+  }
+
+  bool empty() const{
+    return cols_.extent(0) == 0;
+  }
+
+  std::size_t getNNZ(const dofId dof) const{
+    return (dof == dofId::vp) ? nnzVp_ : 2*numSp_;
+  }
+
+  std::size_t getNumColors() const{
+    return colorOffsets_.size()-1;
+  }
+
+  double footprintBytes() const{
+    return 1.*(cols_.span() + rowsByColor_.span())*sizeof(ord_t)
+      + 1.*(valsSp_.span() + valsVp_.span())*sizeof(sc_t);
+  }
+
+  void addToPlacementReport(PagePlacementReport & report) const
+  {
+    report.add("shared columns",      cols_);
+    report.add("shared JacSp values", valsSp_);
+    report.add("shared JacVp values", valsVp_);
+    report.add("shared color rows",   rowsByColor_);
+  }
+
+  // y = y + alpha * Jac(dof) * x, rank-1 or rank-2 states
+  template <typename x_t, typename y_t>
+  void apply(const dofId dof, const sc_t & alpha, x_t x, y_t y) const
+  {
+    if (dof == dofId::sp){
+      using functor_t = SharedSparsityGather<sc_t, ord_view_t, sc_view_t, x_t, y_t>;
+      Kokkos::parallel_for("sharedSparsityStress",
+			   Kokkos::RangePolicy<exe_space>(0, numSp_),
+			   functor_t{alpha, cols_, valsSp_, x, y});
+    }
+    else{
+      using functor_t = SharedSparsityScatter<sc_t, ord_view_t, sc_view_t, x_t, y_t>;
+      for (std::size_t c=0; c+1<colorOffsets_.size(); ++c){
+	const auto rows = Kokkos::subview(rowsByColor_,
+					  std::make_pair(colorOffsets_[c], colorOffsets_[c+1]));
+	Kokkos::parallel_for("sharedSparsityVelocity",
+			     Kokkos::RangePolicy<exe_space>(0, rows.extent(0)),
+			     functor_t{alpha, rows, cols_, valsVp_, x, y});
+      }
+    }
+  }
+
+private:
+  template <typename cols_h_t>
+  void colorStressRows(const cols_h_t cols_h)
+  {
+    // colors already used by the rows touching each velocity point
+    std::vector<std::uint32_t> used(numVp_, 0);
+    std::vector<std::size_t> color(numSp_);
+    std::size_t numColors = 0;
+    for (std::size_t s=0; s<numSp_; ++s){
+      const auto c0 = cols_h(2*s);
+      const auto c1 = cols_h(2*s+1);
+      const std::uint32_t taken = used[c0] | used[c1];
+      std::size_t c = 0;
+      while (c < 32 and (taken >> c) & 1u){ ++c; }
+      if (c == 32){
+	throw std::runtime_error("sharedSparsity: more than 32 colors needed");
+      }
+      color[s] = c;
+      used[c0] |= (1u << c);
+      used[c1] |= (1u << c);
+      numColors = std::max(numColors, c+1);
+    }
+
+    colorOffsets_.assign(numColors+1, 0);
+    for (std::size_t s=0; s<numSp_; ++s){
+      ++colorOffsets_[color[s]+1];
+    }
+    for (std::size_t c=0; c<numColors; ++c){
+      colorOffsets_[c+1] += colorOffsets_[c];
+    }
+
+    rowsByColor_ = ord_view_t("sharedRowsByColor", numSp_);
+    auto rows_h = Kokkos::create_mirror_view(rowsByColor_);
+    std::vector<std::size_t> next(colorOffsets_.begin(), colorOffsets_.end()-1);
+    for (std::size_t s=0; s<numSp_; ++s){
+      rows_h(next[color[s]]++) = s;
+    }
+    Kokkos::deep_copy(rowsByColor_, rows_h);
+  }
+};
+
+/*
+ * what the time loop sees as a jacobian: the CRS matrix, or the
+ * shared-sparsity operator when the backend is sharedSparsity
+ */
+template <typename jac_t, typename shared_t>
+struct FomOperatorView
+{
+  jac_t crs;
+  const shared_t * shared;
+  dofId dof;
+};
+
+// y = y + alpha * A * x, dispatches to the CRS backends or the shared operator
+template <typename sc_t, typename jac_t, typename shared_t, typename x_d_t, typename y_d_t>
+void applyOperator(const operatorBackendKind backend,
+		   const sc_t & alpha,
+		   const FomOperatorView<jac_t, shared_t> & A,
+		   x_d_t x,
+		   y_d_t y)
+{
+  if (backend == operatorBackendKind::sharedSparsity){
+    A.shared->apply(A.dof, alpha, x, y);
+  }
+  else{
+    applyOperator(backend, alpha, A.crs, x, y);
+  }
+}
+
+}//end namespace kokkosapp
+#endif
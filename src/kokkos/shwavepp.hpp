@@ -49,6 +49,14 @@
 #ifndef SHWAVEPP_KOKKOS_HPP_
 #define SHWAVEPP_KOKKOS_HPP_
 
+#include "material_property_accessors.hpp"
+#include "jacobian_assembly_kernels.hpp"
+#include "shared_sparsity_operator.hpp"
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace kokkosapp{
 
 template<typename T>
@@ -62,12 +70,23 @@ public:
   using jacobian_ord_type = typename jacobian_d_type::ordinal_type;
   using mesh_ord_type     = typename mesh_info_type::ordinal_type;
 
+  // both operators with a single connectivity, see shared_sparsity_operator.hpp
+  using shared_operator_t = SharedSparsityOperator<scalar_type, jacobian_d_type>;
+  using operator_view_t   = FomOperatorView<jacobian_d_type, shared_operator_t>;
+
   // coordinates: col0 stores angle, col1 stores 1/radius
   using coords_h_t = Kokkos::View<scalar_type*[2], Kokkos::HostSpace>;
 
-  // connectivity of velo and stresses grid points
-  using graph_vp_h_t = Kokkos::View<mesh_ord_type*[5], Kokkos::HostSpace>;
-  using graph_sp_h_t = Kokkos::View<mesh_ord_type*[3], Kokkos::HostSpace>;
+  // connectivity of velo and stresses grid points: the gids end up as
+  // jacobian column indices, so they use the same integer type
+  using graph_vp_h_t = Kokkos::View<jacobian_ord_type*[5], Kokkos::HostSpace>;
+  using graph_sp_h_t = Kokkos::View<jacobian_ord_type*[3], Kokkos::HostSpace>;
+
+  // list of velocity gids, i.e. column 0 of the velocity graph
+  using gids_list_h_t = Kokkos::View<jacobian_ord_type*, Kokkos::LayoutStride, Kokkos::HostSpace>;
+
+  // spatial index to map target locations to velocity grid points
+  using vp_spatial_index_t = VelocityGridSpatialIndex<scalar_type, gids_list_h_t, coords_h_t>;
 
   // stencil coefficients for velocity points
   using velo_stencil_coeff_h_t = Kokkos::View<scalar_type*[4], Kokkos::HostSpace>;
@@ -81,6 +100,10 @@ public:
   // shear modulus
   using shmod_d_t = Kokkos::View<scalar_type*, device_mem_space>;
   using shmod_h_t = typename shmod_d_t::host_mirror_type;
+  // distinct values of 1/radius, used to index per-radius material tables
+  using rinv_keys_d_t = Kokkos::View<scalar_type*, device_mem_space>;
+  using rinv_keys_h_t = typename rinv_keys_d_t::host_mirror_type;
+
   // cotangent
   using cot_d_t   = Kokkos::View<scalar_type*, device_mem_space>;
   using cot_h_t   = typename cot_d_t::host_mirror_type;
@@ -98,8 +121,10 @@ public:
   ShWavePP() = delete;
 
   ShWavePP(const mesh_info_type & meshInfo,
-	   const MaterialModelBase<scalar_type> & materialObj)
-    : meshDir_{meshInfo.getMeshDir()},
+	   const MaterialModelBase<scalar_type> & materialObj,
+	   const bool hugePages = false)
+    : hugePages_{hugePages},
+      meshDir_{meshInfo.getMeshDir()},
       dthInv_{meshInfo.getAngularSpacingInverse()},
       drrInv_{meshInfo.getRadialSpacingInverse()},
       numGptVp_{meshInfo.getNumVpPts()},
@@ -117,8 +142,6 @@ public:
     // for stresses
     Kokkos::resize(coordsSp_h_,  numGptSp_);
     Kokkos::resize(labelsSp_h_,  numGptSp_);
-    Kokkos::resize(shearModSp_h_,numGptSp_);
-    Kokkos::resize(shearModSp_d_,numGptSp_);
     Kokkos::resize(graphSp_h_,   numGptSp_);
 
     std::cout << std::endl;
@@ -128,55 +151,204 @@ public:
     cot_h_t cotVp_h("cotVph", numGptVp_);
     cot_h_t cotSp_h("cotSph", numGptSp_);
 
-    // read Vp graph
-    readFullMeshGraphFile<scalar_type>(meshDir_, dofId::vp, graphVp_h_,
-				       coordsVp_h_, cotVp_h);
-    readFullMeshCoeffFile<scalar_type>(meshDir_, dofId::vp, coeffsVp_h);
+    Kokkos::Timer timer;
+    {
+      ProfilingRegion region("shaw::meshRead");
+
+      if (meshInfo.isGenerated()){
+	// generate in memory the same graphs stored in the mesh files
+	const auto & generator = meshInfo.viewGenerator();
+	generator.fillGraph(dofId::vp, graphVp_h_, coordsVp_h_, cotVp_h);
+	generator.fillCoefficients(dofId::vp, coeffsVp_h);
+	generator.fillGraph(dofId::sp, graphSp_h_, coordsSp_h_, cotSp_h, labelsSp_h_);
+      }
+      else{
+	// read Vp graph
+	readFullMeshGraphFile<scalar_type>(meshDir_, dofId::vp, graphVp_h_,
+					   coordsVp_h_, cotVp_h);
+	readFullMeshCoeffFile<scalar_type>(meshDir_, dofId::vp, coeffsVp_h);
+
+	// read Sp graph
+	readFullMeshGraphFile<scalar_type>(meshDir_, dofId::sp, graphSp_h_,
+					   coordsSp_h_,
+					   cotSp_h, labelsSp_h_);
+      }
+
+      // gids are column 0 of the graphs
+      gidsVp_h_ = Kokkos::subview(graphVp_h_, Kokkos::ALL(), 0);
+      gidsSp_h_ = Kokkos::subview(graphSp_h_, Kokkos::ALL(), 0);
 
-    // read Sp graph
-    readFullMeshGraphFile<scalar_type>(meshDir_, dofId::sp, graphSp_h_,
-				       coordsSp_h_,
-				       cotSp_h, labelsSp_h_);
+      // build once the index used to map sources and receivers to the grid
+      vpSpatialIndex_ = vp_spatial_index_t(gidsVp_h_, coordsVp_h_);
+    }
+    setupTimes_.emplace_back("meshRead", timer.seconds());
 
     // store material properties since are needed to fill jacobians
-    this->setMaterialProperties(materialObj);
+    timer.reset();
+    {
+      ProfilingRegion region("shaw::material");
+      if (materialObj.isRadiallySymmetric()){
+	this->setRadialMaterialProperties(materialObj);
+      }
+      else{
+	this->setMaterialProperties(materialObj);
+      }
+      Kokkos::fence();
+    }
+    setupTimes_.emplace_back("material", timer.seconds());
 
-    fillVpJacobian(cotVp_h, coeffsVp_h, true);
-    fillSpJacobian(cotSp_h, true);
+    timer.reset();
+    {
+      ProfilingRegion region("shaw::assembly");
+      fillVpJacobian(cotVp_h, coeffsVp_h);
+      fillSpJacobian(cotSp_h);
+      Kokkos::fence();
+    }
+    setupTimes_.emplace_back("assembly", timer.seconds());
 
     printJacInfo();
   }
 
-  const auto viewGidListHost(const dofId dof) const{
+  gids_list_h_t viewGidListHost(const dofId dof) const{
     switch(dof){
-    case dofId::vp:
-      return Kokkos::subview(graphVp_h_, Kokkos::ALL(), 0);
-      break;
-    case dofId::sp:
-      return Kokkos::subview(graphSp_h_, Kokkos::ALL(), 0);
-      break;
-    default:
-      throw std::runtime_error("Invalid dof");
+    case dofId::vp: return gidsVp_h_; break;
+    case dofId::sp: return gidsSp_h_; break;
+    default: throw std::runtime_error("Invalid dof");
     }
   }
 
   auto viewVelocityGraphHost() const{
+    throwIfReleased("velocity graph", assemblyDataReleased_);
     return graphVp_h_;
   }
 
   auto viewStressGraphHost() const{
+    throwIfReleased("stress graph", assemblyDataReleased_);
     return graphSp_h_;
   }
 
   auto viewCoordsHost(const dofId dof) const{
     switch(dof){
     case dofId::vp: return coordsVp_h_; break;
-    case dofId::sp: return coordsSp_h_; break;
+    case dofId::sp:
+      throwIfReleased("stress coordinates", stressCoordsReleased_);
+      return coordsSp_h_;
+      break;
     default: throw std::runtime_error("Invalid dof");
     }
   }
 
+  /*
+    Lean memory: frees the host data that is only needed to assemble
+    the jacobians, i.e. the graphs, the stress labels and the host copies
+    of the material properties. The stress coordinates are only needed
+    to write them to file, so they are freed unless keepStressCoords.
+    The gid lists are kept as compact copies of the graph first column
+    and the velocity coordinates are kept for the source/receiver mappers.
+  */
+  void releaseAssemblyData(const bool keepStressCoords)
+  {
+    if (assemblyDataReleased_) return;
+
+    const auto bytesBefore = footprintBytes();
+    const auto rssBefore   = currentResidentMemoryMB();
+
+    gidsVp_h_ = compactCopy(gidsVp_h_, "gidsVp");
+    gidsSp_h_ = compactCopy(gidsSp_h_, "gidsSp");
+    // the index points to the graph, so rebuild it on the compact list
+    vpSpatialIndex_ = vp_spatial_index_t(gidsVp_h_, coordsVp_h_);
+
+    graphVp_h_	  = graph_vp_h_t();
+    graphSp_h_	  = graph_sp_h_t();
+    labelsSp_h_	  = labels_h_t();
+    rhoInvVp_h_	  = rho_inv_h_t();
+    shearModSp_h_ = shmod_h_t();
+    if (!keepStressCoords){
+      coordsSp_h_ = coords_h_t();
+      stressCoordsReleased_ = true;
+    }
+    assemblyDataReleased_ = true;
+
+    const auto bytesAfter = footprintBytes();
+    const auto rssAfter   = currentResidentMemoryMB();
+    std::cout << "\n*** Lean memory: released assembly-only data ***"
+	      << "\nfootprint (MB) = " << bytesBefore/1024./1024.
+	      << " -> " << bytesAfter/1024./1024.
+	      << "\nresident memory (MB) = " << rssBefore << " -> " << rssAfter
+	      << std::endl;
+  }
+
+  // adds the arrays used in the time loop to a page placement report
+  void addToPlacementReport(PagePlacementReport & report) const
+  {
+    sharedOp_.addToPlacementReport(report);
+    report.add("JacVp row map", JacVp_d_.graph.row_map);
+    report.add("JacVp entries", JacVp_d_.graph.entries);
+    report.add("JacVp values",	JacVp_d_.values);
+    report.add("JacSp row map", JacSp_d_.graph.row_map);
+    report.add("JacSp entries", JacSp_d_.graph.entries);
+    report.add("JacSp values",	JacSp_d_.values);
+    report.add("rhoInvVp",	rhoInvVp_d_);
+  }
+
+  bool assemblyDataReleased() const{
+    return assemblyDataReleased_;
+  }
+
+  // bytes held by this object, allocations shared by
+  // a host mirror and its device view are counted once
+  double footprintBytes() const
+  {
+    double bytes = viewBytes(coordsVp_h_) + viewBytes(coordsSp_h_)
+      + viewBytes(graphVp_h_) + viewBytes(graphSp_h_) + viewBytes(labelsSp_h_)
+      + viewBytes(rhoInvVp_d_) + viewBytes(shearModSp_d_) + viewBytes(radialKeysSp_d_)
+      + jacobianBytes(JacVp_d_) + jacobianBytes(JacSp_d_) + sharedOp_.footprintBytes();
+    if (rhoInvVp_h_.data() != rhoInvVp_d_.data()){
+      bytes += viewBytes(rhoInvVp_h_);
+    }
+    if (shearModSp_h_.data() != shearModSp_d_.data()){
+      bytes += viewBytes(shearModSp_h_);
+    }
+    // before release the gid lists are views of the graphs
+    if (assemblyDataReleased_){
+      bytes += viewBytes(gidsVp_h_) + viewBytes(gidsSp_h_);
+    }
+    return bytes;
+  }
+
+  // wall time in seconds of the setup phases: mesh read, material, assembly
+  const std::vector<std::pair<std::string, double>> & viewSetupTimes() const{
+    return setupTimes_;
+  }
+
+  // backend used to apply the jacobians during the time loop
+  operatorBackendKind getOperatorBackend() const{
+    return operatorBackend_;
+  }
+
+  // sharedSparsity builds the shared-sparsity operator and frees the
+  // two CRS matrices, so it cannot be undone
+  void setOperatorBackend(const operatorBackendKind backend){
+    if (backend != operatorBackendKind::kokkosSparse and
+	backend != operatorBackendKind::crsFunctor and
+	backend != operatorBackendKind::sharedSparsity){
+      throw std::runtime_error("setOperatorBackend: backend must be kokkosSparse, crsFunctor or sharedSparsity");
+    }
+    if (!sharedOp_.empty() and backend != operatorBackendKind::sharedSparsity){
+      throw std::runtime_error("setOperatorBackend: the CRS jacobians were freed by sharedSparsity");
+    }
+    if (backend == operatorBackendKind::sharedSparsity and sharedOp_.empty()){
+      buildSharedSparsityOperator();
+    }
+    operatorBackend_ = backend;
+  }
+
+  const vp_spatial_index_t & viewVelocitySpatialIndex() const{
+    return vpSpatialIndex_;
+  }
+
   auto viewLabelsHost(const dofId dof) const{
+    throwIfReleased("stress labels", assemblyDataReleased_);
     switch(dof){
     case dofId::sp: return labelsSp_h_; break;
     default: throw std::runtime_error("Invalid dof");
@@ -184,6 +356,9 @@ public:
   }
 
   auto viewJacobianDevice(const dofId dof) const{
+    if (!sharedOp_.empty()){
+      throw std::runtime_error("CRS jacobians not available: freed by operatorBackend: sharedSparsity");
+    }
     switch(dof){
     case dofId::vp: return JacVp_d_; break;
     case dofId::sp: return JacSp_d_; break;
@@ -191,6 +366,11 @@ public:
     }
   }
 
+  // the operator applied by the time loop with the current backend
+  operator_view_t viewOperatorDevice(const dofId dof) const{
+    return operator_view_t{(dof == dofId::vp) ? JacVp_d_ : JacSp_d_, &sharedOp_, dof};
+  }
+
   auto viewInvDensityDevice(const dofId dof) const{
     switch(dof){
     case dofId::vp: return rhoInvVp_d_; break;
@@ -199,20 +379,45 @@ public:
   }
 
   auto viewInvDensityHost(const dofId dof) const{
+    throwIfReleased("host inverse density", assemblyDataReleased_);
     switch(dof){
     case dofId::vp: return rhoInvVp_h_; break;
     default: throw std::runtime_error("Invalid dof");
     }
   }
 
+  // only available when the material is stored pointwise,
+  // for radially symmetric models see viewRadialShearModulusDevice
   auto viewShearModulusDevice(const dofId dof) const{
+    if (radialMaterial_){
+      throw std::runtime_error("Shear modulus is stored per radius for this material model");
+    }
     switch(dof){
     case dofId::sp: return shearModSp_d_; break;
     default: throw std::runtime_error("Invalid dof");
     }
   }
 
-  auto getJacobianNNZ(const dofId dof) const{
+  // for radially symmetric models: returns the distinct values of 1/r
+  // (sorted ascending) and the shear modulus at each of them
+  auto viewRadialShearModulusDevice(const dofId dof) const{
+    if (!radialMaterial_){
+      throw std::runtime_error("Shear modulus is stored pointwise for this material model");
+    }
+    switch(dof){
+    case dofId::sp: return std::make_pair(radialKeysSp_d_, shearModSp_d_); break;
+    default: throw std::runtime_error("Invalid dof");
+    }
+  }
+
+  bool hasRadialMaterialProperties() const{
+    return radialMaterial_;
+  }
+
+  std::size_t getJacobianNNZ(const dofId dof) const{
+    if (!sharedOp_.empty()){
+      return sharedOp_.getNNZ(dof);
+    }
     switch(dof){
     case dofId::vp: return JacVp_d_.nnz(); break;
     case dofId::sp: return JacSp_d_.nnz(); break;
@@ -233,49 +438,129 @@ public:
     const std::string dofName = dofIdToString(dof);
     const std::string filePath = "coords_" + dofName + ".txt";
     const auto coords = this->viewCoordsHost(dof);
-    std::ofstream file; file.open(filePath);
-    for(auto i=0; i < coords.extent(0); i++){
-      file << std::setprecision(dblFmt)
-	   << coords(i,0) << " " << constants<scalar_type>::one()/coords(i,1)
-	   << std::endl;
-    }
+    impl::TextFileWriter file(filePath);
+    file.writeRows(coords.extent(0), [&](const std::size_t i, std::string & out){
+			 impl::append_double(out, coords(i,0));
+			 out += ' ';
+			 impl::append_double(out, constants<scalar_type>::one()/coords(i,1));
+			 out += '\n';
+		       });
     file.close();
   }
 
 private:
+  static void throwIfReleased(const std::string & what, const bool released){
+    if (released){
+      throw std::runtime_error(what + " not available: released by leanMemory");
+    }
+  }
+
+  void buildSharedSparsityOperator()
+  {
+    const auto bytesBefore = footprintBytes();
+    sharedOp_ = shared_operator_t(JacVp_d_, JacSp_d_);
+    JacVp_d_ = jacobian_d_type();
+    JacSp_d_ = jacobian_d_type();
+    std::cout << "\n*** Shared-sparsity operator: "
+	      << sharedOp_.getNumColors() << " colors ***"
+	      << "\nfootprint (MB) = " << bytesBefore/1024./1024.
+	      << " -> " << footprintBytes()/1024./1024. << std::endl;
+  }
+
+  template <typename view_t>
+  static double viewBytes(const view_t & v){
+    return 1.*v.span()*sizeof(typename view_t::value_type);
+  }
+
+  static double jacobianBytes(const jacobian_d_type & A){
+    return viewBytes(A.graph.row_map) + viewBytes(A.graph.entries) + viewBytes(A.values);
+  }
+
+  // the assembly kernels first-touch the jacobian arrays,
+  // this only asks for huge pages before they do
+  template <typename view_t>
+  void maybeAdviseHugePages(const view_t & v) const{
+    if (hugePages_ and isHostAccessible<view_t>()){
+      adviseHugePages(v.data(), v.span()*sizeof(typename view_t::value_type));
+    }
+  }
+
+  static gids_list_h_t compactCopy(const gids_list_h_t gids, const std::string & label){
+    Kokkos::View<jacobian_ord_type*, Kokkos::HostSpace> result(
+      Kokkos::view_alloc(Kokkos::WithoutInitializing, label), gids.extent(0));
+    Kokkos::deep_copy(result, gids);
+    return result;
+  }
+
+  template <typename gids_t, typename radii_t, typename angles_t>
+  void gatherPolarCoordinates(const gids_t gids,
+			      const coords_h_t coords,
+			      radii_t radii,
+			      angles_t angles) const
+  {
+    using policy_t = Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>;
+    Kokkos::parallel_for("gatherPolarCoords", policy_t(0, gids.extent(0)),
+			 [=](const std::size_t iPt)
+			 {
+			   const auto ptGID = gids(iPt);
+			   angles(iPt) = coords(ptGID, 0);
+			   radii(iPt)  = one/coords(ptGID, 1);
+			 });
+  }
+
   void setMaterialProperties(const MaterialModelBase<scalar_type> & matModel)
   {
+    using policy_t = Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>;
+    using batch_t  = typename MaterialModelBase<scalar_type>::batch_out_t;
+    const auto noInit = Kokkos::WithoutInitializing;
+
+    Kokkos::resize(shearModSp_d_, numGptSp_);
     rhoInvVp_h_   = Kokkos::create_mirror_view(rhoInvVp_d_);
     shearModSp_h_ = Kokkos::create_mirror_view(shearModSp_d_);
-    KokkosBlas::fill(rhoInvVp_h_,   static_cast<scalar_type>(0));
-    KokkosBlas::fill(shearModSp_h_, static_cast<scalar_type>(0));
-
-    const auto gidsVp = this->viewGidListHost(dofId::vp);
-    const auto gidsSp = this->viewGidListHost(dofId::sp);
-    scalar_type tmpRho, tmpVs;
 
     // set host properties for the vp dofs
-    for (mesh_ord_type iPt=0; iPt < numGptVp_; ++iPt){
-      const auto ptGID        = gidsVp(iPt);
-      const auto thisPtTheta  = coordsVp_h_(ptGID, 0);
-      const auto thisPtRadius = one/coordsVp_h_(ptGID, 1);
-      matModel.computeAt(thisPtRadius, thisPtTheta, tmpRho, tmpVs);
-      rhoInvVp_h_(iPt) = one/tmpRho;
+    {
+      batch_t radii (Kokkos::view_alloc(noInit, "radiiVp"),  numGptVp_);
+      batch_t angles(Kokkos::view_alloc(noInit, "anglesVp"), numGptVp_);
+      batch_t rho   (Kokkos::view_alloc(noInit, "rhoVp"),    numGptVp_);
+      batch_t vs    (Kokkos::view_alloc(noInit, "vsVp"),     numGptVp_);
+      gatherPolarCoordinates(this->viewGidListHost(dofId::vp), coordsVp_h_, radii, angles);
+      matModel.computeAtBatch(radii, angles, rho, vs);
+
+      auto rhoInv = rhoInvVp_h_;
+      Kokkos::parallel_for("setRhoInvVp", policy_t(0, numGptVp_),
+			   [=](const std::size_t iPt){ rhoInv(iPt) = one/rho(iPt); });
     }
     Kokkos::deep_copy(rhoInvVp_d_, rhoInvVp_h_);
 
     // set host properties for the stress dofs
-    for (mesh_ord_type iPt=0; iPt < numGptSp_; ++iPt){
-      const auto ptGID	      = gidsSp(iPt);
-      const auto thisPtTheta  = coordsSp_h_(ptGID, 0);
-      const auto thisPtRadius = one/coordsSp_h_(ptGID, 1);
-      matModel.computeAt(thisPtRadius, thisPtTheta, tmpRho, tmpVs);
-      shearModSp_h_(iPt) = tmpRho * tmpVs * tmpVs;
-
-      if (tmpVs != 0.){
-    	minMaxShearWaveVelocity_[0] = std::min(minMaxShearWaveVelocity_[0], tmpVs);
-      }
-      minMaxShearWaveVelocity_[1] = std::max(minMaxShearWaveVelocity_[1], tmpVs);
+    {
+      batch_t radii (Kokkos::view_alloc(noInit, "radiiSp"),  numGptSp_);
+      batch_t angles(Kokkos::view_alloc(noInit, "anglesSp"), numGptSp_);
+      batch_t rho   (Kokkos::view_alloc(noInit, "rhoSp"),    numGptSp_);
+      batch_t vs    (Kokkos::view_alloc(noInit, "vsSp"),     numGptSp_);
+      gatherPolarCoordinates(this->viewGidListHost(dofId::sp), coordsSp_h_, radii, angles);
+      matModel.computeAtBatch(radii, angles, rho, vs);
+
+      auto shearMod = shearModSp_h_;
+      Kokkos::parallel_for("setShearModSp", policy_t(0, numGptSp_),
+			   [=](const std::size_t iPt){
+			     shearMod(iPt) = rho(iPt) * vs(iPt) * vs(iPt);
+			   });
+
+      // min excludes points where vs is zero (e.g. fluid regions)
+      scalar_type minVs = {};
+      scalar_type maxVs = {};
+      Kokkos::parallel_reduce("minVs", policy_t(0, numGptSp_),
+			      [=](const std::size_t iPt, scalar_type & lmin){
+				if (vs(iPt) != 0.){ lmin = std::min(lmin, vs(iPt)); }
+			      }, Kokkos::Min<scalar_type>(minVs));
+      Kokkos::parallel_reduce("maxVs", policy_t(0, numGptSp_),
+			      [=](const std::size_t iPt, scalar_type & lmax){
+				lmax = std::max(lmax, vs(iPt));
+			      }, Kokkos::Max<scalar_type>(maxVs));
+      minMaxShearWaveVelocity_[0] = std::min(minMaxShearWaveVelocity_[0], minVs);
+      minMaxShearWaveVelocity_[1] = std::max(minMaxShearWaveVelocity_[1], maxVs);
     }
     Kokkos::deep_copy(shearModSp_d_, shearModSp_h_);
 
@@ -285,184 +570,206 @@ private:
     	      << std::endl;
   }
 
-  auto countVpJacNNZ() const
+  rinv_keys_h_t findDistinctInverseRadii(const coords_h_t coords) const
   {
-    mesh_ord_type result = 0;
-    for (mesh_ord_type iPt=0; iPt < numGptVp_; ++iPt)
-    {
-      const auto & ptGID      = graphVp_h_(iPt, 0);
-      const auto & gid_west   = graphVp_h_(iPt, 1);
-      const auto & gid_north  = graphVp_h_(iPt, 2);
-      const auto & gid_east   = graphVp_h_(iPt, 3);
-      const auto & gid_south  = graphVp_h_(iPt, 4);
-
-      mesh_ord_type thisRowNnz = 0;
-      if (gid_north == gid_south){
-	thisRowNnz+=1;
-      }
-      else{
-	thisRowNnz+=2;
-      }
-
-      if (gid_west == gid_east){
-	thisRowNnz+=1;
-      }
-      else{
-	thisRowNnz+=2;
+    // points are stored row by row, so most of them repeat one of
+    // the last two distinct values seen (vp rows are constant in r,
+    // sp rows alternate srp/stp): skipping those first means that
+    // only about nr values need to be sorted
+    std::vector<scalar_type> keys;
+    for (std::size_t i=0; i<coords.extent(0); ++i){
+      const auto rInv = coords(i, 1);
+      const auto n = keys.size();
+      if ( (n>=1 and keys[n-1]==rInv) or (n>=2 and keys[n-2]==rInv) ){
+	continue;
       }
+      keys.push_back(rInv);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
 
-      result+=thisRowNnz;
+    rinv_keys_h_t result("rInvKeys", keys.size());
+    for (std::size_t k=0; k<keys.size(); ++k){
+      result(k) = keys[k];
     }
     return result;
   }
 
-  void fillVpJacobian(const cot_h_t cotVp_h,
-		      const velo_stencil_coeff_h_t coeffsVp_h,
-		      bool includeMatProp = false)
+  void evaluateRadialProfile(const MaterialModelBase<scalar_type> & matModel,
+			     const rinv_keys_h_t rInvKeys,
+			     typename MaterialModelBase<scalar_type>::batch_out_t rho,
+			     typename MaterialModelBase<scalar_type>::batch_out_t vs) const
   {
-    const mesh_ord_type numRows = numGptVp_;
-    const mesh_ord_type numCols = numGptSp_;
+    using batch_t = typename MaterialModelBase<scalar_type>::batch_out_t;
+    const auto n = rInvKeys.extent(0);
+    batch_t radii("radii", n);
+    // the model does not depend on the angle, so any value works
+    batch_t angles("angles", n);
+    for (std::size_t k=0; k<n; ++k){
+      radii(k) = one/rInvKeys(k);
+    }
+    matModel.computeAtBatch(radii, angles, rho, vs);
+  }
 
-    // count nnz
-    const auto nnz = countVpJacNNZ();
-
-    // // create data on device that we need to fill to create Jacobian
-    // typename jacobian_d_type::values_type val ("val", nnz);
-    // typename jacobian_d_type::row_map_type::non_const_type ptr ("ptr", numRows+1);
-    // typename jacobian_d_type::index_type::non_const_type ind ("ind", nnz);
-    // // create host mirros of these
-    // auto val_h = Kokkos::create_mirror_view (val);
-    // auto ptr_h = Kokkos::create_mirror_view (ptr);
-    // auto ind_h = Kokkos::create_mirror_view (ind);
-
-    Kokkos::View<scalar_type*, Kokkos::HostSpace> val_h("valJVp", nnz);
-    Kokkos::View<mesh_ord_type*, Kokkos::HostSpace> ptr_h("ptrJVp", numRows+1);
-    Kokkos::View<mesh_ord_type*, Kokkos::HostSpace> ind_h("indJVp", nnz);
-
-    ptr_h[0] = 0;
-    // set the column index for each non-zero entry of the Jacobian
-    mesh_ord_type k = 0;
-    for (mesh_ord_type iPt=0; iPt < numRows; ++iPt)
-      {
-	const auto & ptGID	 = graphVp_h_(iPt, 0);
-	const auto & gid_west	 = graphVp_h_(iPt, 1);
-	const auto & gid_north   = graphVp_h_(iPt, 2);
-	const auto & gid_east    = graphVp_h_(iPt, 3);
-	const auto & gid_south   = graphVp_h_(iPt, 4);
-	const auto & thisPtTheta = coordsVp_h_(ptGID, 0);
-	const auto & rInv	 = coordsVp_h_(ptGID, 1);
-	const auto rhoInv	 = rhoInvVp_h_[iPt];
-
-	const auto & c0	    = coeffsVp_h(iPt, 0);
-	const auto & c1	    = coeffsVp_h(iPt, 1);
-	const auto & c2	    = coeffsVp_h(iPt, 2);
-	const auto & c3	    = coeffsVp_h(iPt, 3);
-
-	const auto c_west  = (-rInv*dthInv_ + rInv*cotVp_h[ptGID])*c0*rhoInv;
-	const auto c_north = (drrInv_	    + three*oneHalf*rInv )*c1*rhoInv;
-	const auto c_east  = (rInv*dthInv_  + rInv*cotVp_h[ptGID])*c2*rhoInv;
-	const auto c_south = (-drrInv_	    + three*oneHalf*rInv )*c3*rhoInv;
-
-	mesh_ord_type shift = 0;
-	if (gid_north == gid_south){
-	  shift+=1;
-	  ind_h[k] = gid_north;
-	  val_h(k++) = c_north+c_south;
-	}
-	else{
-	  shift+=2;
-	  ind_h[k] = gid_north;
-	  val_h(k++) = c_north;
+  void setRadialMaterialProperties(const MaterialModelBase<scalar_type> & matModel)
+  {
+    using policy_t = Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>;
+    using batch_t  = typename MaterialModelBase<scalar_type>::batch_out_t;
 
-	  ind_h[k] = gid_south;
-	  val_h(k++) = c_south;
-	}
+    radialMaterial_ = true;
 
-	if (gid_west == gid_east){
-	  shift+=1;
-	  ind_h[k] = gid_west;
-	  val_h(k++) = c_west+c_east;
-	}
-	else{
-	  shift+=2;
-	  ind_h[k] = gid_west;
-	  val_h(k++) = c_west;
+    // vp: the per-radius 1/rho is broadcast to all points since
+    // the full array is needed by the forcing term in the time loop
+    {
+      const auto keys = findDistinctInverseRadii(coordsVp_h_);
+      const auto nRad = keys.extent(0);
+      batch_t rho("rhoVpRad", nRad);
+      batch_t vs ("vsVpRad",  nRad);
+      evaluateRadialProfile(matModel, keys, rho, vs);
+
+      batch_t rhoInvRad("rhoInvVpRad", nRad);
+      for (std::size_t k=0; k<nRad; ++k){
+	rhoInvRad(k) = one/rho(k);
+      }
 
-	  ind_h[k] = gid_east;
-	  val_h(k++) = c_east;
+      rhoInvVp_h_ = Kokkos::create_mirror_view(rhoInvVp_d_);
+      auto rhoInv = rhoInvVp_h_;
+      const auto gids   = this->viewGidListHost(dofId::vp);
+      const auto coords = coordsVp_h_;
+      const RadialMaterialAccessor<rinv_keys_h_t, batch_t> acc(keys, rhoInvRad);
+      Kokkos::parallel_for("setRhoInvVp", policy_t(0, numGptVp_),
+			   [=](const std::size_t iPt){
+			     rhoInv(iPt) = acc(iPt, coords(gids(iPt), 1));
+			   });
+      Kokkos::deep_copy(rhoInvVp_d_, rhoInvVp_h_);
+    }
+
+    // sp: only store the shear modulus per radius
+    {
+      const auto keys = findDistinctInverseRadii(coordsSp_h_);
+      const auto nRad = keys.extent(0);
+      batch_t rho("rhoSpRad", nRad);
+      batch_t vs ("vsSpRad",  nRad);
+      evaluateRadialProfile(matModel, keys, rho, vs);
+
+      Kokkos::resize(radialKeysSp_d_, nRad);
+      Kokkos::resize(shearModSp_d_,   nRad);
+      shearModSp_h_ = Kokkos::create_mirror_view(shearModSp_d_);
+      for (std::size_t k=0; k<nRad; ++k){
+	shearModSp_h_(k) = rho(k) * vs(k) * vs(k);
+
+	// min excludes points where vs is zero (e.g. fluid regions)
+	if (vs(k) != 0.){
+	  minMaxShearWaveVelocity_[0] = std::min(minMaxShearWaveVelocity_[0], vs(k));
 	}
-	ptr_h[iPt+1] = ptr_h[iPt] + shift;
+	minMaxShearWaveVelocity_[1] = std::max(minMaxShearWaveVelocity_[1], vs(k));
       }
+      Kokkos::deep_copy(radialKeysSp_d_, keys);
+      Kokkos::deep_copy(shearModSp_d_, shearModSp_h_);
+    }
+
+    std::cout << "minMaxVs = "
+    	      << minMaxShearWaveVelocity_[0] << " "
+    	      << minMaxShearWaveVelocity_[1]
+    	      << std::endl;
+    std::cout << "radially symmetric material: "
+	      << "numRadiiSp = " << radialKeysSp_d_.extent(0)
+	      << std::endl;
+  }
 
-    jacobian_d_type J("JacVp", numRows, numCols, nnz,
-		   val_h.data(), ptr_h.data(), ind_h.data());
-    JacVp_d_ = J;
+  void fillVpJacobian(const cot_h_t cotVp_h,
+		      const velo_stencil_coeff_h_t coeffsVp_h)
+  {
+    using exe_space = typename jacobian_d_type::execution_space;
+    using mem_space = typename jacobian_d_type::memory_space;
+    using policy_t  = Kokkos::RangePolicy<exe_space, Kokkos::Schedule<Kokkos::Static>>;
+    using row_map_t = typename jacobian_d_type::row_map_type::non_const_type;
+    using ind_t	    = typename jacobian_d_type::index_type::non_const_type;
+    using val_t	    = typename jacobian_d_type::values_type::non_const_type;
+
+    const mesh_ord_type numRows = numGptVp_;
+    const mesh_ord_type numCols = numGptSp_;
+
+    // the assembly runs where the matrix lives, so make the inputs
+    // accessible there (this is a no-op for host builds)
+    auto graph  = Kokkos::create_mirror_view_and_copy(mem_space(), graphVp_h_);
+    auto coords = Kokkos::create_mirror_view_and_copy(mem_space(), coordsVp_h_);
+    auto cot    = Kokkos::create_mirror_view_and_copy(mem_space(), cotVp_h);
+    auto coeffs = Kokkos::create_mirror_view_and_copy(mem_space(), coeffsVp_h);
+
+    // pass 1: count nnz of each row and scan them into the row map
+    row_map_t ptr(Kokkos::view_alloc(Kokkos::WithoutInitializing, "ptrJVp"), numRows+1);
+    maybeAdviseHugePages(ptr);
+    using scan_functor_t = VpJacobianRowMapFunctor<decltype(graph), row_map_t>;
+    typename scan_functor_t::value_type nnz = 0;
+    Kokkos::parallel_scan("jacVpRowMap", policy_t(0, numRows),
+			  scan_functor_t(graph, ptr, numRows), nnz);
+
+    // pass 2: fill column indices and values in place
+    ind_t ind(Kokkos::view_alloc(Kokkos::WithoutInitializing, "indJVp"), nnz);
+    val_t val(Kokkos::view_alloc(Kokkos::WithoutInitializing, "valJVp"), nnz);
+    maybeAdviseHugePages(ind);
+    maybeAdviseHugePages(val);
+    using fill_functor_t = VpJacobianFillFunctor<
+      scalar_type, decltype(graph), decltype(coords), decltype(cot),
+      decltype(coeffs), rho_inv_d_t, row_map_t, ind_t, val_t>;
+    Kokkos::parallel_for("jacVpFill", policy_t(0, numRows),
+			 fill_functor_t(graph, coords, cot, coeffs, rhoInvVp_d_,
+					ptr, ind, val, dthInv_, drrInv_));
+    exe_space().fence();
+
+    JacVp_d_ = jacobian_d_type("JacVp", numRows, numCols, nnz, val, ptr, ind);
   }
 
-  void fillSpJacobian(const cot_h_t cotSp_h, bool includeMatProp = false)
+  void fillSpJacobian(const cot_h_t cotSp_h)
   {
+    if (radialMaterial_){
+      using acc_t = RadialMaterialAccessor<rinv_keys_d_t, shmod_d_t>;
+      fillSpJacobianImpl(cotSp_h, acc_t(radialKeysSp_d_, shearModSp_d_));
+    }
+    else{
+      using acc_t = PointwiseMaterialAccessor<shmod_d_t>;
+      fillSpJacobianImpl(cotSp_h, acc_t(shearModSp_d_));
+    }
+  }
+
+  template <typename shmod_acc_t>
+  void fillSpJacobianImpl(const cot_h_t cotSp_h, const shmod_acc_t shearModAcc)
+  {
+    using exe_space = typename jacobian_d_type::execution_space;
+    using mem_space = typename jacobian_d_type::memory_space;
+    using policy_t  = Kokkos::RangePolicy<exe_space, Kokkos::Schedule<Kokkos::Static>>;
+    using row_map_t = typename jacobian_d_type::row_map_type::non_const_type;
+    using ind_t	    = typename jacobian_d_type::index_type::non_const_type;
+    using val_t	    = typename jacobian_d_type::values_type::non_const_type;
+
     const mesh_ord_type nonZerosPerRowJ_ = 2;
     const mesh_ord_type numRows = numGptSp_;
     const mesh_ord_type numCols = numGptVp_;
     const mesh_ord_type numEnt  = numRows * nonZerosPerRowJ_;
 
-    // // create data on device that we need to fill to create Jacobian
-    // typename jacobian_d_type::row_map_type::non_const_type ptr ("ptr", numRows+1);
-    // typename jacobian_d_type::index_type::non_const_type ind ("ind", numEnt);
-    // typename jacobian_d_type::values_type val ("val", numEnt);
-    // // create host mirros of these
-    // typename jacobian_d_type::row_map_type::HostMirror ptr_h = Kokkos::create_mirror_view (ptr);
-    // typename jacobian_d_type::index_type::HostMirror   ind_h = Kokkos::create_mirror_view (ind);
-    // typename jacobian_d_type::values_type::HostMirror  val_h = Kokkos::create_mirror_view (val);
-
-    Kokkos::View<scalar_type*, Kokkos::HostSpace> val_h("valJSp", numEnt);
-    Kokkos::View<mesh_ord_type*, Kokkos::HostSpace> ptr_h("ptrJSp", numRows+1);
-    Kokkos::View<mesh_ord_type*, Kokkos::HostSpace> ind_h("indJSp", numEnt);
-
-    // first, fill in how many elements per row
-    ptr_h[0] = 0;
-    for (mesh_ord_type iRow = 0; iRow < numRows; ++iRow) {
-      ptr_h[iRow+1] = ptr_h[iRow] + nonZerosPerRowJ_;
-    }
-
-    // set the column index for each non-zero entry of the Jacobian
-    mesh_ord_type k = 0;
-    for (mesh_ord_type iPt=0; iPt < numRows; ++iPt)
-      {
-	const auto & ptGID       = graphSp_h_(iPt, 0);
-	const auto & thisPtTheta = coordsSp_h_(ptGID, 0);
-	const auto & rInv        = coordsSp_h_(ptGID, 1);
-	const auto & myLabel	 = labelsSp_h_(iPt);
-	const auto shearMod	 = shearModSp_h_(iPt);
-
-	if( myLabel==1){ //srp
-	  const auto gid_north     = graphSp_h_(iPt, 1);
-	  const auto gid_south     = graphSp_h_(iPt, 2);
-	  const auto c_north	   = (drrInv_ - rInv*oneHalf)*shearMod;
-	  const auto c_south	   = (-drrInv_ - rInv*oneHalf)*shearMod;
-	  ind_h[k] = gid_north;
-	  val_h[k++]   = c_north;
-
-	  ind_h[k] = gid_south;
-	  val_h[k++]   = c_south;
-	}
-
-	if(myLabel==2){ //stp
-    	  const auto gid_west = graphSp_h_(iPt, 1);
-    	  const auto gid_east = graphSp_h_(iPt, 2);
-    	  const auto c_west   = (-dthInv_ - oneHalf*cotSp_h[ptGID])*rInv*shearMod;
-    	  const auto c_east   = (dthInv_ - oneHalf*cotSp_h[ptGID])*rInv*shearMod;
-    	  ind_h[k] = gid_west;
-    	  val_h[k++]   = c_west;
-
-    	  ind_h[k] = gid_east;
-    	  val_h[k++]   = c_east;
-	}
-      }
-
-    jacobian_d_type J2("JacSp", numRows, numCols, numEnt,
-		    val_h.data(), ptr_h.data(), ind_h.data());
-    JacSp_d_ = J2;
+    auto graph  = Kokkos::create_mirror_view_and_copy(mem_space(), graphSp_h_);
+    auto coords = Kokkos::create_mirror_view_and_copy(mem_space(), coordsSp_h_);
+    auto cot    = Kokkos::create_mirror_view_and_copy(mem_space(), cotSp_h);
+    auto labels = Kokkos::create_mirror_view_and_copy(mem_space(), labelsSp_h_);
+
+    // row counts are constant, so the row map is filled
+    // by the same kernel that fills indices and values
+    row_map_t ptr(Kokkos::view_alloc(Kokkos::WithoutInitializing, "ptrJSp"), numRows+1);
+    ind_t ind(Kokkos::view_alloc(Kokkos::WithoutInitializing, "indJSp"), numEnt);
+    val_t val(Kokkos::view_alloc(Kokkos::WithoutInitializing, "valJSp"), numEnt);
+    maybeAdviseHugePages(ptr);
+    maybeAdviseHugePages(ind);
+    maybeAdviseHugePages(val);
+    using fill_functor_t = SpJacobianFillFunctor<
+      scalar_type, decltype(graph), decltype(coords), decltype(cot),
+      decltype(labels), shmod_acc_t, row_map_t, ind_t, val_t>;
+    Kokkos::parallel_for("jacSpFill", policy_t(0, numRows),
+			 fill_functor_t(graph, coords, cot, labels, shearModAcc,
+					ptr, ind, val, dthInv_, drrInv_));
+    exe_space().fence();
+
+    JacSp_d_ = jacobian_d_type("JacSp", numRows, numCols, numEnt, val, ptr, ind);
   }
 
   void printJacInfo() const
@@ -479,6 +786,9 @@ private:
   }
 
 private:
+  // back the jacobian arrays with huge pages
+  bool hugePages_ = false;
+
   std::string meshDir_ = {};
 
   // inverse spacing in theta (rad) and r (m) direction
@@ -507,9 +817,16 @@ private:
   // graph for vp
   graph_vp_h_t  graphVp_h_ = {};
 
+  // gids of the vp points, a view of the graph column 0
+  // or a compact copy once the assembly data is released
+  gids_list_h_t gidsVp_h_ = {};
+
   // jacobian matrix for Vp
   jacobian_d_type JacVp_d_ = {};
 
+  // spatial index over the vp grid points
+  vp_spatial_index_t vpSpatialIndex_ = {};
+
   //**************************
   //***** members for Sp *****
   //**************************
@@ -524,16 +841,36 @@ private:
   // i.e. sigma_r,phi from sigma_theta,phi
   labels_h_t labelsSp_h_ = {};
 
-  // shear modulus for sp points
+  // true if material properties are stored per distinct radius
+  bool radialMaterial_ = false;
+
+  // shear modulus for sp points: if radialMaterial_ is true,
+  // this has one entry per value in radialKeysSp_d_
   shmod_d_t shearModSp_d_ = {};
   shmod_h_t shearModSp_h_ = {};
+  rinv_keys_d_t radialKeysSp_d_ = {};
 
   // graph for sp
   graph_sp_h_t  graphSp_h_ = {};
 
+  // gids of the sp points, see gidsVp_h_
+  gids_list_h_t gidsSp_h_ = {};
+
   // jacobian matrix for sp
   jacobian_d_type JacSp_d_ = {};
 
+  // replaces JacVp_d_ and JacSp_d_ with operatorBackend: sharedSparsity
+  shared_operator_t sharedOp_ = {};
+
+  // wall time of the setup phases
+  std::vector<std::pair<std::string, double>> setupTimes_ = {};
+
+  // how the jacobians are applied, set after autotuning if enabled
+  operatorBackendKind operatorBackend_ = operatorBackendKind::kokkosSparse;
+
+  // true after releaseAssemblyData
+  bool assemblyDataReleased_ = false;
+  bool stressCoordsReleased_ = false;
 };
 
 }//end namespace kokkosapp
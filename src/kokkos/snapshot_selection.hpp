@@ -0,0 +1,158 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// snapshot_selection.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef SHWAVEPP_SNAPSHOT_SELECTION_HPP_
+#define SHWAVEPP_SNAPSHOT_SELECTION_HPP_
+
+#include <algorithm>
+#include <numeric>
+
+namespace impl{
+
+/*
+ * reads the gids to store from a file with one or two columns per line,
+ * the last column is used so that the sm_to_fm_*.dat maps of a sample
+ * mesh, "sampleMeshGid fullMeshGid", can be used as they are
+ */
+inline std::vector<std::size_t> readSnapshotGidsFile(const std::string & fileName,
+						     const std::size_t numDofs)
+{
+  std::ifstream source(fileName, std::ios_base::in);
+  if (!source){
+    throw std::runtime_error("cannot open snapshot gids file " + fileName);
+  }
+
+  std::vector<std::size_t> gids;
+  std::string line;
+  while (std::getline(source, line)){
+    std::istringstream ss(line);
+    std::string col, last;
+    while (ss >> col){ last = col; }
+    if (last.empty()) continue;
+
+    const auto gid = std::stoull(last);
+    if (gid >= numDofs){
+      throw std::runtime_error("gid " + last + " in " + fileName + " is out of range");
+    }
+    gids.push_back(gid);
+  }
+  return gids;
+}
+
+template <typename parser_t, typename app_t>
+typename SnapshotRows::gids_t
+selectSnapshotRowsForDof(const dofId dof, const parser_t & parser, const app_t & appObj)
+{
+  using sc_t = typename app_t::scalar_type;
+  constexpr auto one = constants<sc_t>::one();
+  constexpr auto thousand = constants<sc_t>::thousand();
+
+  const auto coords = appObj.viewCoordsHost(dof);
+  const std::size_t numDofs = coords.extent(0);
+
+  // candidates are the gids in the file if any, otherwise all,
+  // sorted so that the gather reads the state in order
+  const auto gidsFile = parser.getSnapshotGidsFile(dof);
+  std::vector<std::size_t> candidates;
+  if (gidsFile.empty()){
+    candidates.resize(numDofs);
+    std::iota(candidates.begin(), candidates.end(), std::size_t(0));
+  }
+  else{
+    candidates = readSnapshotGidsFile(gidsFile, numDofs);
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+  }
+
+  // keep the ones in the region, then every stride-th one
+  const auto radius = parser.getSnapshotRadiusRange();
+  const auto angle  = parser.getSnapshotAngleRange();
+  const auto stride = parser.getSnapshotStride();
+  std::vector<std::size_t> selected;
+  std::size_t numInRegion = 0;
+  for (const auto gid : candidates){
+    const auto rKm   = one/(coords(gid,1)*thousand);
+    const auto thDeg = radToDeg(coords(gid,0));
+    const bool inRegion = rKm >= radius[0] and rKm <= radius[1]
+      and thDeg >= angle[0] and thDeg <= angle[1];
+    if (inRegion and (numInRegion++ % stride == 0)){
+      selected.push_back(gid);
+    }
+  }
+
+  if (selected.empty()){
+    throw std::runtime_error("snapshot restrict selects no " + dofIdToString(dof) + " dofs");
+  }
+  std::cout << "Snapshots " << dofIdToString(dof) << ": storing "
+	    << selected.size() << " of " << numDofs << " dofs" << std::endl;
+
+  typename SnapshotRows::gids_t gids(Kokkos::view_alloc(Kokkos::WithoutInitializing, "snapGids"),
+				     selected.size());
+  std::copy(selected.begin(), selected.end(), gids.data());
+  return gids;
+}
+}//end namespace impl
+
+/*
+ * rows of the states to store in the snapshot matrices, from the
+ * io: snapshotMatrix: restrict inputs. Not restricted unless set, so
+ * that the snapshots keep every dof.
+ */
+template <typename parser_t, typename app_t>
+SnapshotRows selectSnapshotRows(const parser_t & parser, const app_t & appObj)
+{
+  SnapshotRows rows;
+  if (parser.enableSnapshotMatrix() and parser.restrictSnapshots()){
+    rows.restricted = true;
+    rows.gids[0] = impl::selectSnapshotRowsForDof(dofId::vp, parser, appObj);
+    rows.gids[1] = impl::selectSnapshotRowsForDof(dofId::sp, parser, appObj);
+  }
+  return rows;
+}
+
+#endif
@@ -49,9 +49,22 @@
 #ifndef SHWAVEPP_OBSERVER_HPP_
 #define SHWAVEPP_OBSERVER_HPP_
 
+// gids of the state rows stored in the snapshot matrices,
+// all rows are stored unless restricted, see selectSnapshotRows
+struct SnapshotRows
+{
+  using gids_t = Kokkos::View<std::size_t*, Kokkos::HostSpace>;
+
+  bool restricted = false;
+  std::array<gids_t, 2> gids = {};
+};
+
 template <typename state_t, typename dest_t>
 struct CopyState
 {
+  // rows handled by one iteration for rank-2 states
+  static constexpr std::size_t tileSize = 64;
+
   std::size_t colIndex_;
   state_t x_;
   dest_t M_;
@@ -59,6 +72,12 @@ struct CopyState
   CopyState(const std::size_t & colIndex, const state_t & x, const dest_t & M)
     : colIndex_(colIndex), x_(x), M_(M){}
 
+  // rank-1: one row per iteration, rank-2: one tile of rows per iteration
+  std::size_t numIterations() const{
+    return is_kokkos_2dview<state_t>::value
+      ? (x_.extent(0) + tileSize - 1)/tileSize : x_.extent(0);
+  }
+
   template <typename _state_t = state_t>
   KOKKOS_INLINE_FUNCTION
   typename std::enable_if<is_kokkos_1dview<_state_t>::value>::type
@@ -67,13 +86,65 @@ struct CopyState
     M_(i, colIndex_, 0) = x_(i);
   }
 
+  // the realizations are the outer loop so that the writes into the
+  // matrix of each realization, M_(:, colIndex_, j), are unit-stride,
+  // while the tile of the state being read stays in cache
   template <typename _state_t = state_t>
   KOKKOS_INLINE_FUNCTION
   typename std::enable_if<is_kokkos_2dview<_state_t>::value>::type
+  operator() (const std::size_t & iTile) const
+  {
+    const std::size_t begin = iTile*tileSize;
+    const std::size_t end   = (begin + tileSize < x_.extent(0)) ? begin + tileSize : x_.extent(0);
+    for (std::size_t j=0; j<M_.extent(2); ++j){
+      for (std::size_t i=begin; i<end; ++i){
+	M_(i, colIndex_, j) = x_(i,j);
+      }
+    }
+  }
+};
+
+
+// as CopyState, but row i of the matrix is row gids_(i) of the state
+template <typename state_t, typename dest_t, typename gids_t>
+struct GatherState
+{
+  static constexpr std::size_t tileSize = 64;
+
+  std::size_t colIndex_;
+  state_t x_;
+  dest_t M_;
+  gids_t gids_;
+
+  GatherState(const std::size_t & colIndex, const state_t & x,
+	      const dest_t & M, const gids_t & gids)
+    : colIndex_(colIndex), x_(x), M_(M), gids_(gids){}
+
+  std::size_t numIterations() const{
+    return is_kokkos_2dview<state_t>::value
+      ? (gids_.extent(0) + tileSize - 1)/tileSize : gids_.extent(0);
+  }
+
+  template <typename _state_t = state_t>
+  KOKKOS_INLINE_FUNCTION
+  typename std::enable_if<is_kokkos_1dview<_state_t>::value>::type
   operator() (const std::size_t & i) const
   {
-    for (std::size_t j=0; j<M_.extent(2); ++j)
-      M_(i, colIndex_, j) = x_(i,j);
+    M_(i, colIndex_, 0) = x_(gids_(i));
+  }
+
+  template <typename _state_t = state_t>
+  KOKKOS_INLINE_FUNCTION
+  typename std::enable_if<is_kokkos_2dview<_state_t>::value>::type
+  operator() (const std::size_t & iTile) const
+  {
+    const std::size_t begin = iTile*tileSize;
+    const std::size_t end   = (begin + tileSize < gids_.extent(0)) ? begin + tileSize : gids_.extent(0);
+    for (std::size_t j=0; j<M_.extent(2); ++j){
+      for (std::size_t i=begin; i<end; ++i){
+	M_(i, colIndex_, j) = x_(gids_(i),j);
+      }
+    }
   }
 };
 
@@ -87,9 +158,17 @@ struct StateObserver
 private:
   bool useBinaryIO_   = {};
   bool enableSnapMat_ = {};
+  bool zeroCopy_      = {};
+  // write each realization of a rank-2 run to its own file
+  bool splitRealizations_ = {};
+  // first-touch the snapshot rows with the threads that copy them
+  bool numaFirstTouch_ = {};
+  bool hugePages_ = {};
   std::array<std::string,2> snapFileName_ = {};
 
   std::array<std::size_t, 2> numDofs_ = {};
+  // rows of the states that are stored
+  SnapshotRows rows_ = {};
 
   // to count the snapshots
   std::array<std::size_t, 2> count_ = {};
@@ -102,18 +181,27 @@ private:
 
   // runID used when we run many samples to prepend file
   std::size_t runID_ = 0;
+  // sample ID of the first realization stored
+  std::size_t firstSampleID_ = 0;
 
 public:
   template <typename parser_t>
   StateObserver(std::size_t numDof_vp,
 		std::size_t numDof_sp,
 		const parser_t & parser,
-		std::size_t fSize = 1)
+		std::size_t fSize = 1,
+		const SnapshotRows & rows = SnapshotRows())
     : useBinaryIO_(parser.writeSnapshotsBinary()),
       enableSnapMat_{parser.enableSnapshotMatrix()},
+      zeroCopy_{parser.snapshotsZeroCopy()},
+      splitRealizations_{parser.splitSnapshotRealizations()},
+      numaFirstTouch_{parser.numaFirstTouch()},
+      hugePages_{parser.hugePages()},
       snapFileName_{{parser.getSnapshotFileName(dofId::vp),
 		     parser.getSnapshotFileName(dofId::sp)}},
-      numDofs_{{numDof_vp, numDof_sp}},
+      numDofs_{{rows.restricted ? rows.gids[0].extent(0) : numDof_vp,
+		 rows.restricted ? rows.gids[1].extent(0) : numDof_sp}},
+      rows_(rows),
       snapshotFreq_{{parser.getSnapshotFreq(dofId::vp),
 		     parser.getSnapshotFreq(dofId::sp)}}
   {
@@ -143,8 +231,7 @@ public:
       }
 
       //resize matrix
-      Kokkos::resize(Avp_, numDof_vp, numColsVp, fSize);
-      Kokkos::resize(Asp_, numDof_sp, numColsSp, fSize);
+      allocate(numColsVp, numColsSp, fSize);
 
       const double memAvp = Avp_.extent(0)*Avp_.extent(1)*Avp_.extent(2) * sizeof(scalar_t);
       const double memAsp = Asp_.extent(0)*Asp_.extent(1)*Asp_.extent(2) * sizeof(scalar_t);
@@ -157,10 +244,72 @@ public:
     return enableSnapMat_;
   }
 
-  void prepForNewRun(const std::size_t & runIdIn){
+  // rows stored, to construct more observers for the same run
+  const SnapshotRows & viewSnapshotRows() const{
+    return rows_;
+  }
+
+  // true if the time integration writes the sampled states
+  // directly into the snapshot matrices, see captureColumn
+  bool zeroCopy() const{
+    return enableSnapMat_ and zeroCopy_;
+  }
+
+  /*
+   * zero-copy capture: if the state at this step is sampled, returns
+   * a pointer to the column of the snapshot matrix where the update
+   * has to be written and counts it as observed, otherwise nullptr.
+   * The column is contiguous because the matrices are LayoutLeft.
+   */
+  scalar_t * captureColumn(const dofId & dof, const std::size_t step)
+  {
+    if (enableSnapMat_)
+    {
+      auto & A	      = (dof==dofId::vp) ? Avp_ : Asp_;
+      const auto freq = (dof==dofId::vp) ? snapshotFreq_[0] : snapshotFreq_[1];
+      auto & count    = (dof==dofId::vp) ? count_[0] : count_[1];
+
+      if (step % freq == 0 and step > 0){
+	if (rows_.restricted){
+	  throw std::runtime_error("Zero-copy snapshots cannot be restricted");
+	}
+	if (A.extent(2) != 1){
+	  throw std::runtime_error("Zero-copy snapshots are only supported for rank-1 forcing");
+	}
+	return &A(0, count++, 0);
+      }
+    }
+    return nullptr;
+  }
+
+  // change the number of forcing realizations stored, e.g. for the
+  // last batch of a rank-2 run which can have fewer realizations
+  void setForcingSize(const std::size_t fSize){
+    if (enableSnapMat_ and Avp_.extent(2) != fSize){
+      allocate(Avp_.extent(1), Asp_.extent(1), fSize);
+    }
+  }
+
+  template <typename report_t>
+  void addToPlacementReport(report_t & report) const{
+    if (enableSnapMat_){
+      report.add("snapshots vp", Avp_);
+      report.add("snapshots sp", Asp_);
+    }
+  }
+
+  // bytes of the snapshot matrices
+  std::size_t sizeInBytes() const{
+    return (Avp_.size() + Asp_.size()) * sizeof(scalar_t);
+  }
+
+  // firstSampleID is the sample of the first realization stored
+  void prepForNewRun(const std::size_t & runIdIn,
+		     const std::size_t firstSampleID = 0){
     // assumes the new run has same sampling frequncies as before
     count_ = {0,0};
     runID_ = runIdIn;
+    firstSampleID_ = firstSampleID;
   }
 
   const auto & viewSnapshotMatrix(const dofId & dof) const
@@ -171,6 +320,16 @@ public:
     }
   }
 
+  std::size_t getSnapshotFreq(const dofId & dof) const{
+    return (dof==dofId::vp) ? snapshotFreq_[0] : snapshotFreq_[1];
+  }
+
+  // for time loops that fill the snapshot matrices themselves
+  void setNumObserved(const dofId & dof, const std::size_t n){
+    auto & count = (dof==dofId::vp) ? count_[0] : count_[1];
+    count = n;
+  }
+
   template<typename state_t>
   void observe(dofId dof,
 	       std::size_t step,
@@ -188,20 +347,51 @@ public:
 
       if ( step % freq == 0 and step > 0)
       {
-	using functor_t = CopyState<state_t, matrix_t>;
-	functor_t fnc(count, xhv, A);
-
 	// must specify an host exespace here otherwise it picks the default
 	// which might be a device one
 	using copy_exespace = Kokkos::DefaultHostExecutionSpace;
-	Kokkos::RangePolicy<copy_exespace> policy(0, xhv.extent(0));
-	Kokkos::parallel_for(policy, fnc);
+	if (rows_.restricted){
+	  using gids_t = typename SnapshotRows::gids_t;
+	  using functor_t = GatherState<state_t, matrix_t, gids_t>;
+	  functor_t fnc(count, xhv, A, rows_.gids[(dof==dofId::vp) ? 0 : 1]);
+	  Kokkos::RangePolicy<copy_exespace> policy(0, fnc.numIterations());
+	  Kokkos::parallel_for(policy, fnc);
+	}
+	else{
+	  using functor_t = CopyState<state_t, matrix_t>;
+	  functor_t fnc(count, xhv, A);
+	  Kokkos::RangePolicy<copy_exespace> policy(0, fnc.numIterations());
+	  Kokkos::parallel_for(policy, fnc);
+	}
 
   	count++;
       }
     }
   }
 
+  // store/load counters and snapshots collected so far, used by FomCheckpoint
+  void writeCheckpoint(std::ostream & os) const
+  {
+    impl::write_pod_to_binary(os, enableSnapMat_);
+    if (enableSnapMat_){
+      writeLeadingColumnsToBinary(os, Avp_, count_[0]);
+      writeLeadingColumnsToBinary(os, Asp_, count_[1]);
+    }
+  }
+
+  void readCheckpoint(std::istream & is)
+  {
+    bool enabledInCheckpoint = false;
+    impl::read_pod_from_binary(is, enabledInCheckpoint);
+    if (enabledInCheckpoint != enableSnapMat_){
+      throw std::runtime_error("Checkpoint and current run differ in snapshot collection");
+    }
+    if (enableSnapMat_){
+      count_[0] = readLeadingColumnsFromBinary(is, Avp_);
+      count_[1] = readLeadingColumnsFromBinary(is, Asp_);
+    }
+  }
+
   void writeSnapshotMatrixToFile(const dofId & dof) const
   {
     // for snapshots, we want extents written to file
@@ -223,12 +413,71 @@ public:
 	const auto Av = Kokkos::subview(A, Kokkos::ALL(), Kokkos::ALL(), 0);
 	writeToFile(fN2, Av, useBinaryIO_, writeExtentsToFile);
       }
+      else if (splitRealizations_)
+      {
+	// the matrix of each realization is contiguous, so it is
+	// written as is to a file named after its sample ID
+	for (std::size_t j=0; j<A.extent(2); ++j){
+	  const auto Av = Kokkos::subview(A, Kokkos::ALL(), Kokkos::ALL(), j);
+	  writeToFile(fN + "_" + std::to_string(firstSampleID_ + j),
+		      Av, useBinaryIO_, writeExtentsToFile);
+	}
+      }
       else{
 	writeToFile(fN2, A, useBinaryIO_, writeExtentsToFile);
       }
       std::cout << "... Done" << std::endl;
     }
   }
+
+  // with restricted snapshots, writes the gids of the rows stored
+  // to <snapshot file name>_gids.txt, these are the same for all samples
+  void writeSnapshotRowsToFile() const
+  {
+    if (enableSnapMat_ and rows_.restricted){
+      for (const auto dof : {dofId::vp, dofId::sp}){
+	const auto k = (dof==dofId::vp) ? 0 : 1;
+	writeToFile(snapFileName_[k] + "_gids.txt", rows_.gids[k], false);
+      }
+    }
+  }
+
+  // appends the snapshots of each realization to the container,
+  // named after the snapshot file
+  template <typename container_t>
+  void writeSnapshotMatrixToContainer(const dofId & dof, container_t & container) const
+  {
+    if (enableSnapMat_)
+    {
+      std::cout << "Writing snapshots " + dofIdToString(dof) + " to " + container.getFileName();
+
+      const auto & A  = (dof==dofId::vp) ? Avp_ : Asp_;
+      const auto & fN = (dof==dofId::vp) ? snapFileName_[0] : snapFileName_[1];
+      for (std::size_t j=0; j<A.extent(2); ++j){
+	container.addMatrix(fN, firstSampleID_ + j, A.extent(0), A.extent(1),
+			    [&A, j](const std::size_t r, const std::size_t c){
+			      return A(r, c, j);
+			    });
+      }
+      std::cout << "... Done" << std::endl;
+    }
+  }
+
+private:
+  void allocate(const std::size_t numColsVp,
+		const std::size_t numColsSp,
+		const std::size_t fSize)
+  {
+    // free first so that old and new matrices are never both resident
+    const auto nVp = numDofs_[0];
+    const auto nSp = numDofs_[1];
+    Avp_ = matrix_t();
+    Asp_ = matrix_t();
+    Avp_ = kokkosapp::allocateWithPlacement<matrix_t>("Avp", numaFirstTouch_, hugePages_,
+						      nVp, numColsVp, fSize);
+    Asp_ = kokkosapp::allocateWithPlacement<matrix_t>("Asp", numaFirstTouch_, hugePages_,
+						      nSp, numColsSp, fSize);
+  }
 };
 
 #endif
@@ -53,10 +53,13 @@
 #include "seismogram.hpp"
 #include "forcing_rank_one.hpp"
 #include "forcing_rank_two.hpp"
+#include "index_policy.hpp"
 
 namespace kokkosapp{
 
-struct commonTypes
+// index_policy selects the integer types of jacobians and graphs, see index_policy.hpp
+template <typename index_policy>
+struct commonTypesWithIndex
 {
   using scalar_type = double;
 
@@ -66,7 +69,9 @@ struct commonTypes
   using p_mm_t  = ParserMaterialModel<scalar_type>;
   using p_ss_t  = ParserForcingSection<scalar_type>;
   using p_rom_t = ParserRomSection<scalar_type>;
-  using parser_type = InputParser<p_gs_t, p_io_t, p_mm_t, p_ss_t, p_rom_t>;
+  using p_cp_t  = ParserCheckpointSection<scalar_type>;
+  using p_pf_t  = ParserPerformanceSection<scalar_type>;
+  using parser_type = InputParser<p_gs_t, p_io_t, p_mm_t, p_ss_t, p_rom_t, p_cp_t, p_pf_t>;
 
   // mesh info class
   using mesh_info_type = MeshInfo<scalar_type>;
@@ -78,8 +83,10 @@ struct commonTypes
 #endif
 
   // jacobian is a sparse matrix
-  using jacobian_ord_type = typename mesh_info_type::ordinal_type;
-  using jacobian_d_type = KokkosSparse::CrsMatrix<scalar_type, jacobian_ord_type, device_mem_space>;
+  using jacobian_ord_type    = typename index_policy::ordinal_type;
+  using jacobian_offset_type = typename index_policy::offset_type;
+  using jacobian_d_type = KokkosSparse::CrsMatrix<
+    scalar_type, jacobian_ord_type, device_mem_space, void, jacobian_offset_type>;
 
   // state observer: to collect state snapshots
   using observer_type = StateObserver<scalar_type>;
@@ -88,35 +95,45 @@ struct commonTypes
   using seismogram_type  = Seismogram<scalar_type>;
 };
 
-struct rank1Types : commonTypes
+template <typename index_policy>
+struct rank1TypesWithIndex : commonTypesWithIndex<index_policy>
 {
-  using typename commonTypes::scalar_type;
-  using typename commonTypes::parser_type;
-  using typename commonTypes::mesh_info_type;
-  using typename commonTypes::jacobian_ord_type;
-  using typename commonTypes::jacobian_d_type;
-  using typename commonTypes::observer_type;
-  using typename commonTypes::seismogram_type;
-  using typename commonTypes::device_mem_space;
+  using base_t = commonTypesWithIndex<index_policy>;
+  using typename base_t::scalar_type;
+  using typename base_t::parser_type;
+  using typename base_t::mesh_info_type;
+  using typename base_t::jacobian_ord_type;
+  using typename base_t::jacobian_offset_type;
+  using typename base_t::jacobian_d_type;
+  using typename base_t::observer_type;
+  using typename base_t::seismogram_type;
+  using typename base_t::device_mem_space;
 
   // state is a rank-1 view
   using state_d_type = Kokkos::View<scalar_type*, device_mem_space>;
   using state_h_type = typename state_d_type::host_mirror_type;
 
+  // states of an ensemble of rank-1 samples: one column per sample,
+  // layout left so that each column is contiguous
+  using ensemble_state_d_type = Kokkos::View<scalar_type**, Kokkos::LayoutLeft, device_mem_space>;
+
   // forcing
   using forcing_type = RankOneForcing<scalar_type, state_d_type>;
 };
 
-struct rank2Types : commonTypes
+template <typename index_policy>
+struct rank2TypesWithIndex : commonTypesWithIndex<index_policy>
 {
-  using typename commonTypes::scalar_type;
-  using typename commonTypes::parser_type;
-  using typename commonTypes::mesh_info_type;
-  using typename commonTypes::jacobian_ord_type;
-  using typename commonTypes::jacobian_d_type;
-  using typename commonTypes::observer_type;
-  using typename commonTypes::seismogram_type;
-  using typename commonTypes::device_mem_space;
+  using base_t = commonTypesWithIndex<index_policy>;
+  using typename base_t::scalar_type;
+  using typename base_t::parser_type;
+  using typename base_t::mesh_info_type;
+  using typename base_t::jacobian_ord_type;
+  using typename base_t::jacobian_offset_type;
+  using typename base_t::jacobian_d_type;
+  using typename base_t::observer_type;
+  using typename base_t::seismogram_type;
+  using typename base_t::device_mem_space;
 
   // state is a rank-2 view
   using state_d_type = Kokkos::View<scalar_type**, device_mem_space>;
@@ -128,16 +145,19 @@ struct rank2Types : commonTypes
   using forcing_type = RankTwoForcing<scalar_type, signal_instances_h_type>;
 };
 
-struct rank1TypesRom : commonTypes
+template <typename index_policy>
+struct rank1TypesRomWithIndex : commonTypesWithIndex<index_policy>
 {
-  using typename commonTypes::scalar_type;
-  using typename commonTypes::parser_type;
-  using typename commonTypes::mesh_info_type;
-  using typename commonTypes::jacobian_ord_type;
-  using typename commonTypes::jacobian_d_type;
-  using typename commonTypes::observer_type;
-  using typename commonTypes::seismogram_type;
-  using typename commonTypes::device_mem_space;
+  using base_t = commonTypesWithIndex<index_policy>;
+  using typename base_t::scalar_type;
+  using typename base_t::parser_type;
+  using typename base_t::mesh_info_type;
+  using typename base_t::jacobian_ord_type;
+  using typename base_t::jacobian_offset_type;
+  using typename base_t::jacobian_d_type;
+  using typename base_t::observer_type;
+  using typename base_t::seismogram_type;
+  using typename base_t::device_mem_space;
 
   // state is a rank-1 view
   using state_d_type = Kokkos::View<scalar_type*, device_mem_space>;
@@ -161,5 +181,11 @@ struct rank1TypesRom : commonTypes
   using forcing_type = RankOneForcing<scalar_type, state_d_type>;
 };
 
+// default to 32-bit indices, main.cc switches to 64-bit when the mesh does not fit
+using commonTypes   = commonTypesWithIndex<index32Policy>;
+using rank1Types    = rank1TypesWithIndex<index32Policy>;
+using rank2Types    = rank2TypesWithIndex<index32Policy>;
+using rank1TypesRom = rank1TypesRomWithIndex<index32Policy>;
+
 }// end namespace
 #endif
@@ -61,19 +61,28 @@
 #include "./enums/supported_signal_enums.hpp"
 #include "./enums/supported_material_model_enums.hpp"
 #include "./enums/supported_samplable_params_enums.hpp"
+#include "./enums/operator_backend_enums.hpp"
+#include "./enums/time_loop_enums.hpp"
 
 #include "./complexity.hpp"
 #include "./various/print_perf.hpp"
+#include "./various/profiling_region.hpp"
+#include "./various/hardware_counters.hpp"
+#include "./various/perf_report.hpp"
+#include "./various/numa_placement.hpp"
 
 #include "./meta_kokkos.hpp"
 #include "./various/equality.hpp"
 #include "./various/angular_helpers.hpp"
+#include "./various/fnv_hash.hpp"
 
 #include "./parser/parser_general_section.hpp"
 #include "./parser/parser_io_section.hpp"
 #include "./parser/parser_material_model.hpp"
 #include "./parser/parser_forcing_section.hpp"
 #include "./parser/parser_rom_section.hpp"
+#include "./parser/parser_checkpoint_section.hpp"
+#include "./parser/parser_performance_section.hpp"
 #include "./parser/input_parser.hpp"
 
 #include "./io/matrix_write.hpp"
@@ -81,11 +90,15 @@
 #include "./io/read_basis.hpp"
 #include "./io/vector_write.hpp"
 #include "./io/vector_read.hpp"
+#include "./io/checkpoint_io.hpp"
+#include "./io/background_writer.hpp"
+#include "./io/sample_container.hpp"
 
 #include "./checkers/check_dispersion_criterion.hpp"
 #include "./checkers/check_cfl.hpp"
 
 #include "./mesh_helpers/read_graph_file.hpp"
+#include "./mesh_helpers/structured_mesh_generator.hpp"
 #include "./mesh_helpers/mesh_info.hpp"
 #include "./mesh_helpers/read_vpcoeff_file.hpp"
 
@@ -93,8 +106,10 @@
 #include "./material_models/material_model_bilayer.hpp"
 #include "./material_models/material_model_prem.hpp"
 #include "./material_models/material_model_create.hpp"
+#include "./mesh_helpers/create_mesh_info.hpp"
 
 #include "./various/signal.hpp"
+#include "./nominal_to_grid_mappers/velocity_grid_spatial_index.hpp"
 #include "./nominal_to_grid_mappers/map_point_source_to_velocity_grid_point.hpp"
 #include "./nominal_to_grid_mappers/map_nominal_location_to_velocity_grid_point.hpp"
 
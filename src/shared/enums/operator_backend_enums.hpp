@@ -0,0 +1,82 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// operator_backend_enums.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef UTILS_OPERATOR_BACKEND_ENUMS_HPP_
+#define UTILS_OPERATOR_BACKEND_ENUMS_HPP_
+
+// how the sparse FOM operators are applied at each step:
+// kokkosSparse uses KokkosSparse::spmv, crsFunctor uses our own
+// row-parallel CRS kernel, autotune picks the faster one at runtime.
+// sharedSparsity replaces the two CRS matrices with a single connectivity,
+// see shared_sparsity_operator.hpp
+enum class operatorBackendKind {unknown, kokkosSparse, crsFunctor, sharedSparsity, autotune};
+
+std::string operatorBackendKindToString(const operatorBackendKind e){
+  switch (e){
+  case operatorBackendKind::kokkosSparse: return "kokkosSparse";
+  case operatorBackendKind::crsFunctor:   return "crsFunctor";
+  case operatorBackendKind::sharedSparsity: return "sharedSparsity";
+  case operatorBackendKind::autotune:     return "auto";
+  default:				  return "unknown";
+  }
+}
+
+operatorBackendKind stringToOperatorBackendKind(const std::string s){
+  if (s == "kokkosSparse" or s=="KokkosSparse")
+    return operatorBackendKind::kokkosSparse;
+  else if (s == "crsFunctor" or s=="CrsFunctor")
+    return operatorBackendKind::crsFunctor;
+  else if (s == "sharedSparsity" or s=="SharedSparsity")
+    return operatorBackendKind::sharedSparsity;
+  else if (s == "auto")
+    return operatorBackendKind::autotune;
+  else
+    return operatorBackendKind::unknown;
+}
+
+#endif
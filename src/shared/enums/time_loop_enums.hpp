@@ -0,0 +1,77 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// time_loop_enums.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef UTILS_TIME_LOOP_ENUMS_HPP_
+#define UTILS_TIME_LOOP_ENUMS_HPP_
+
+// how the FOM time loop is run: kernels launches separate kernels for
+// each phase of each step, persistent runs all the steps inside a single
+// parallel region, automatic picks persistent for small meshes
+enum class timeLoopKind {unknown, kernels, persistent, automatic};
+
+std::string timeLoopKindToString(const timeLoopKind e){
+  switch (e){
+  case timeLoopKind::kernels:    return "kernels";
+  case timeLoopKind::persistent: return "persistent";
+  case timeLoopKind::automatic:  return "auto";
+  default:			 return "unknown";
+  }
+}
+
+timeLoopKind stringToTimeLoopKind(const std::string s){
+  if (s == "kernels")
+    return timeLoopKind::kernels;
+  else if (s == "persistent")
+    return timeLoopKind::persistent;
+  else if (s == "auto")
+    return timeLoopKind::automatic;
+  else
+    return timeLoopKind::unknown;
+}
+
+#endif
@@ -0,0 +1,123 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// background_writer.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef BACKGROUND_WRITER_HPP_
+#define BACKGROUND_WRITER_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/*
+ * Runs jobs, one at a time and in submission order, on a thread
+ * of its own. Used to write output while the compute threads move on.
+ * submit returns a future for the result of the job, exceptions
+ * thrown by a job are rethrown when the future is read.
+ */
+class BackgroundWriter
+{
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> jobs_;
+  bool done_ = false;
+  std::thread thread_;
+
+public:
+  BackgroundWriter() : thread_([this](){ this->loop(); }){}
+
+  BackgroundWriter(const BackgroundWriter &) = delete;
+  BackgroundWriter & operator=(const BackgroundWriter &) = delete;
+
+  // pending jobs are completed before the thread is joined
+  ~BackgroundWriter()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      done_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+  }
+
+  template <typename job_t>
+  auto submit(job_t && job) -> std::future<decltype(job())>
+  {
+    using result_t = decltype(job());
+    auto task = std::make_shared<std::packaged_task<result_t()>>(std::forward<job_t>(job));
+    auto result = task->get_future();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.emplace_back([task](){ (*task)(); });
+    }
+    cv_.notify_one();
+    return result;
+  }
+
+private:
+  void loop()
+  {
+    while (true)
+    {
+      std::function<void()> job;
+      {
+	std::unique_lock<std::mutex> lock(mutex_);
+	cv_.wait(lock, [this](){ return done_ or !jobs_.empty(); });
+	if (jobs_.empty()) return;
+	job = std::move(jobs_.front());
+	jobs_.pop_front();
+      }
+      job();
+    }
+  }
+};
+
+#endif
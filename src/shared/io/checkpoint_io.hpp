@@ -0,0 +1,126 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// checkpoint_io.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef CHECKPOINT_IO_HPP_
+#define CHECKPOINT_IO_HPP_
+
+#include <fstream>
+#include <iostream>
+
+namespace impl
+{
+
+template <typename T>
+void write_pod_to_binary(std::ostream & os, const T & value)
+{
+  os.write((const char*) (&value), sizeof(T));
+}
+
+template <typename T>
+void read_pod_from_binary(std::istream & is, T & value)
+{
+  is.read((char*) (&value), sizeof(T));
+  if (!is){
+    throw std::runtime_error("Unexpected end of checkpoint file");
+  }
+}
+
+template <typename sc_t>
+void write_array_to_binary(std::ostream & os, const sc_t * A, std::size_t n)
+{
+  os.write((const char*) A, n*sizeof(sc_t));
+}
+
+template <typename sc_t>
+void read_array_from_binary(std::istream & is, sc_t * A, std::size_t n)
+{
+  is.read((char*) A, n*sizeof(sc_t));
+  if (!is){
+    throw std::runtime_error("Unexpected end of checkpoint file");
+  }
+}
+}// impl namespace
+
+/*
+ * write/read the first numCols columns of every slice A(:,:,k)
+ * of a layout-left 3d view: each of these blocks is contiguous
+ */
+template<class T>
+typename std::enable_if<is_kokkos_3dview<T>::value>::type
+writeLeadingColumnsToBinary(std::ostream & os, const T & A, const std::size_t numCols)
+{
+  static_assert(is_accessible_on_host<T>::value and
+		std::is_same<typename T::array_layout, Kokkos::LayoutLeft>::value,
+		"writeLeadingColumnsToBinary needs a layout-left view accessible on host");
+
+  impl::write_pod_to_binary(os, numCols);
+  for (std::size_t k=0; k<A.extent(2); ++k){
+    impl::write_array_to_binary(os, &A(0,0,k), A.extent(0)*numCols);
+  }
+}
+
+template<class T>
+typename std::enable_if<is_kokkos_3dview<T>::value, std::size_t>::type
+readLeadingColumnsFromBinary(std::istream & is, const T & A)
+{
+  static_assert(is_accessible_on_host<T>::value and
+		std::is_same<typename T::array_layout, Kokkos::LayoutLeft>::value,
+		"readLeadingColumnsFromBinary needs a layout-left view accessible on host");
+
+  std::size_t numCols = 0;
+  impl::read_pod_from_binary(is, numCols);
+  if (numCols > A.extent(1)){
+    throw std::runtime_error("Checkpoint has more columns than the destination container");
+  }
+  for (std::size_t k=0; k<A.extent(2); ++k){
+    impl::read_array_from_binary(is, &A(0,0,k), A.extent(0)*numCols);
+  }
+  return numCols;
+}
+
+#endif
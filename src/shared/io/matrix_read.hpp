@@ -49,6 +49,8 @@
 #ifndef MATRIX_READ_HPP_
 #define MATRIX_READ_HPP_
 
+#include "text_io.hpp"
+#include "sample_container.hpp"
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -122,38 +124,53 @@ fillMatrixFromBinary(const std::string filename, dmat_t & M)
   fin.close();
 }
 
+// rows of whitespace separated values, optionally after a line with the extents.
+// Values past extent(1) in a row are ignored, a row with fewer values throws
 template <typename dmat_t>
 typename std::enable_if< is_kokkos_2dview<dmat_t>::value >::type
 fillMatrixFromAscii(const std::string fileName,
-		    dmat_t M,
+		    dmat_t & M,
 		    bool fileContainsExtents)
 {
   static_assert( is_accessible_on_host<dmat_t>::value,
 		 "fillMatrixFromAscii: the kokkos view must have HostSpace to read");
 
-  std::ifstream source; source.open(fileName, std::ios_base::in);
-  std::string line, colv;
-
+  impl::TextFileReader source(fileName);
   if (fileContainsExtents)
   {
-    std::getline(source, line);
-    std::istringstream in(line);
-    std::string col1, col2;
-    in >> col1; in >> col2;
-    Kokkos::resize(M, std::stoi(col1), std::stoi(col2) );
+    const auto rows = source.nextSize();
+    const auto cols = source.nextSize();
+    Kokkos::resize(M, rows, cols);
+    source.skipLine();
   }
 
-  // then read the actual data
-  std::size_t iRow = 0;
-  while (std::getline(source, line) ){
-    std::istringstream in(line);
+  for (std::size_t i=0; i<M.extent(0) and source.hasNext(); ++i){
     for (std::size_t j=0; j<M.extent(1); ++j){
-      in >> colv;
-      M(iRow, j) = atof(colv.c_str());
+      M(i, j) = source.nextDoubleInLine();
     }
-    iRow++;
+    source.skipLine();
+  }
+}
+
+// matrix name stored for sampleID in a sample container, resized to its extents
+template<class dmat_t>
+typename std::enable_if< is_col_major_matrix_kokkos<dmat_t>::value >::type
+fillMatrixFromContainer(const std::string fileName,
+			const std::string & name,
+			const std::size_t sampleID,
+			dmat_t & M)
+{
+  static_assert( is_accessible_on_host<dmat_t>::value,
+		 "fillMatrixFromContainer: the kokkos view must have HostSpace to read");
+  static_assert( std::is_same<typename dmat_t::non_const_value_type, double>::value,
+		 "fillMatrixFromContainer: the container stores doubles");
+
+  const SampleContainerReader container(fileName);
+  const auto & entry = container.findMatrix(name, sampleID);
+  if (M.extent(0) != entry.rows || M.extent(1) != entry.cols){
+    Kokkos::resize(M, entry.rows, entry.cols);
   }
-  source.close();
+  container.readMatrix(entry, M.data());
 }
 
 #endif
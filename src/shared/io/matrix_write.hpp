@@ -49,6 +49,7 @@
 #ifndef MATRIX_WRITE_HPP_
 #define MATRIX_WRITE_HPP_
 
+#include "text_io.hpp"
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -100,19 +101,21 @@ void write_contig_3d_view_to_ascii(const std::string fileName,
 				    std::size_t s2,
 				    bool writeSize = true)
 {
-  std::ofstream file; file.open(fileName);
+  TextFileWriter file(fileName);
   if (writeSize){
-    file << s0 << " " << s1 << " " << s2 << std::endl;
+    file.writeLine(std::to_string(s0) + " " + std::to_string(s1) + " " + std::to_string(s2));
   }
 
-  for (std::size_t k=0; k<s2; k++){
-    for (std::size_t i=0; i<s0; i++){
-      for (std::size_t j=0; j<s1; j++){
-	file << std::setprecision(dblFmt) << A(i,j,k) << " ";
-      }
-      file << std::endl;
-    }
-  }
+  // row r is row r%s0 of slice r/s0
+  file.writeRows(s0*s2, [&](const std::size_t r, std::string & out){
+			  const auto i = r % s0;
+			  const auto k = r / s0;
+			  for (std::size_t j=0; j<s1; j++){
+			    append_double(out, A(i,j,k));
+			    out += ' ';
+			  }
+			  out += '\n';
+			});
   file.close();
 }
 
@@ -123,17 +126,18 @@ void write_matrix_to_ascii(const std::string fileName,
 			   std::size_t n,
 			   bool writeSize = true)
 {
-  std::ofstream file; file.open(fileName);
+  TextFileWriter file(fileName);
   if (writeSize){
-    file << m << " " << n << std::endl;
+    file.writeLine(std::to_string(m) + " " + std::to_string(n));
   }
 
-  for (std::size_t i=0; i<m; i++){
-    for (std::size_t j=0; j<n; j++){
-      file << std::setprecision(dblFmt) << A(i,j) << " ";
-    }
-    file << std::endl;
-  }
+  file.writeRows(m, [&](const std::size_t i, std::string & out){
+		      for (std::size_t j=0; j<n; j++){
+			append_double(out, A(i,j));
+			out += ' ';
+		      }
+		      out += '\n';
+		    });
   file.close();
 }
 }// impl namespace
@@ -0,0 +1,448 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// sample_container.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef SAMPLE_CONTAINER_HPP_
+#define SAMPLE_CONTAINER_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Single-file container for the outputs of multi-sample runs.
+ *
+ * header: magic, version, tile extents, offset and bytes of the index
+ * data:   one record per matrix, split into tiles of tileRows x tileCols
+ *	   values stored column-major. Tiles are ordered by column of tiles,
+ *	   then by row of tiles, so a range of rows or of columns is read
+ *	   from the tiles intersecting it only.
+ * index:  metadata of each sample, then name, sample, extents and
+ *	   offset of each matrix. It is written when the container is closed.
+ *
+ * Integers are stored as uint64 and values as double, in native
+ * byte order like the other binary files.
+ */
+
+struct SampleMetadata
+{
+  std::uint64_t sampleID = 0;
+  double depth	= 0.;
+  double period = 0.;
+  double angle	= 0.;
+  double delay	= 0.;
+  std::string signal = {};
+};
+
+struct ContainerMatrixEntry
+{
+  std::string name = {};
+  std::uint64_t sampleID = 0;
+  std::uint64_t rows = 0;
+  std::uint64_t cols = 0;
+  // byte offset of the first tile
+  std::uint64_t offset = 0;
+};
+
+namespace impl
+{
+constexpr char containerMagic[8] = {'S','H','A','W','C','N','T','R'};
+constexpr std::uint64_t containerVersion = 1;
+// magic, version, tileRows, tileCols, indexOffset, indexBytes
+constexpr std::size_t containerHeaderBytes = 8 + 5*sizeof(std::uint64_t);
+
+// element offset of tile (tr, tc) from the first tile of a matrix:
+// all tile columns before tc are full width, and within tile column tc
+// all tiles before tr are full height
+inline std::uint64_t containerTileOffset(const std::uint64_t rows,
+					 const std::uint64_t cols,
+					 const std::uint64_t tileRows,
+					 const std::uint64_t tileCols,
+					 const std::uint64_t tr,
+					 const std::uint64_t tc)
+{
+  const auto c0 = tc*tileCols;
+  const auto width = std::min(tileCols, cols - c0);
+  return c0*rows + tr*tileRows*width;
+}
+
+template <typename T>
+void append_pod(std::string & out, const T & v){
+  out.append(reinterpret_cast<const char *>(&v), sizeof(T));
+}
+
+inline void append_string(std::string & out, const std::string & s){
+  append_pod(out, static_cast<std::uint64_t>(s.size()));
+  out += s;
+}
+
+// reads from a buffer, checking that it is not read past its end
+class ContainerIndexParser
+{
+  const std::string & data_;
+  std::size_t pos_ = 0;
+
+public:
+  explicit ContainerIndexParser(const std::string & data) : data_(data){}
+
+  template <typename T>
+  T pod(){
+    T v;
+    checkAvailable(sizeof(T));
+    std::memcpy(&v, data_.data() + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return v;
+  }
+
+  std::string string(){
+    const auto n = pod<std::uint64_t>();
+    checkAvailable(n);
+    std::string s = data_.substr(pos_, n);
+    pos_ += n;
+    return s;
+  }
+
+private:
+  void checkAvailable(const std::size_t n) const{
+    if (pos_ + n > data_.size()){
+      throw std::runtime_error("Corrupted sample container index");
+    }
+  }
+};
+}// impl namespace
+
+/*
+ * Writes a container. Samples and matrices can be added from
+ * different threads, e.g. the background writer of asyncWrite.
+ */
+class SampleContainerWriter
+{
+  std::mutex mutex_;
+  std::string fileName_;
+  std::FILE * file_ = nullptr;
+  std::uint64_t tileRows_ = 0;
+  std::uint64_t tileCols_ = 0;
+  // offset where the next matrix is written
+  std::uint64_t end_ = impl::containerHeaderBytes;
+  std::vector<SampleMetadata> samples_;
+  std::vector<ContainerMatrixEntry> matrices_;
+  std::vector<double> tile_;
+
+public:
+  SampleContainerWriter(const std::string & fileName,
+			const std::size_t tileRows,
+			const std::size_t tileCols)
+    : fileName_(fileName),
+      file_(std::fopen(fileName.c_str(), "wb")),
+      tileRows_(tileRows),
+      tileCols_(tileCols),
+      tile_(tileRows*tileCols)
+  {
+    if (!file_){
+      throw std::runtime_error("cannot open " + fileName + " for writing");
+    }
+    // the index offset and size are filled in by close
+    writeHeader(0, 0);
+  }
+
+  SampleContainerWriter(const SampleContainerWriter &) = delete;
+  SampleContainerWriter & operator=(const SampleContainerWriter &) = delete;
+
+  ~SampleContainerWriter(){
+    try{
+      close();
+    }
+    catch (const std::exception & e){
+      std::cout << e.what() << std::endl;
+    }
+  }
+
+  const std::string & getFileName() const{ return fileName_; }
+
+  void addSample(const SampleMetadata & meta)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples_.push_back(meta);
+  }
+
+  // appends matrix A of rows x cols, A(i,j) is called for each value
+  template <typename accessor_t>
+  void addMatrix(const std::string & name,
+		 const std::uint64_t sampleID,
+		 const std::uint64_t rows,
+		 const std::uint64_t cols,
+		 const accessor_t & A)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    checkOpen();
+    std::fseek(file_, static_cast<long>(end_), SEEK_SET);
+
+    for (std::uint64_t c0=0; c0<cols; c0+=tileCols_){
+      const auto c1 = std::min(cols, c0+tileCols_);
+      for (std::uint64_t r0=0; r0<rows; r0+=tileRows_){
+	const auto r1 = std::min(rows, r0+tileRows_);
+	std::size_t k = 0;
+	for (auto j=c0; j<c1; ++j){
+	  for (auto i=r0; i<r1; ++i){
+	    tile_[k++] = A(i,j);
+	  }
+	}
+	if (std::fwrite(tile_.data(), sizeof(double), k, file_) != k){
+	  throw std::runtime_error("error writing sample container " + fileName_);
+	}
+      }
+    }
+
+    matrices_.push_back({name, sampleID, rows, cols, end_});
+    end_ += rows*cols*sizeof(double);
+  }
+
+  // writes the index, no-op if already closed
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) return;
+
+    std::string index;
+    impl::append_pod(index, static_cast<std::uint64_t>(samples_.size()));
+    for (const auto & s : samples_){
+      impl::append_pod(index, s.sampleID);
+      impl::append_pod(index, s.depth);
+      impl::append_pod(index, s.period);
+      impl::append_pod(index, s.angle);
+      impl::append_pod(index, s.delay);
+      impl::append_string(index, s.signal);
+    }
+    impl::append_pod(index, static_cast<std::uint64_t>(matrices_.size()));
+    for (const auto & m : matrices_){
+      impl::append_string(index, m.name);
+      impl::append_pod(index, m.sampleID);
+      impl::append_pod(index, m.rows);
+      impl::append_pod(index, m.cols);
+      impl::append_pod(index, m.offset);
+    }
+
+    std::fseek(file_, static_cast<long>(end_), SEEK_SET);
+    const bool ok = std::fwrite(index.data(), 1, index.size(), file_) == index.size();
+    writeHeader(end_, index.size());
+    std::fclose(file_);
+    file_ = nullptr;
+    if (!ok){
+      throw std::runtime_error("error writing sample container " + fileName_);
+    }
+  }
+
+private:
+  void checkOpen() const{
+    if (!file_){
+      throw std::runtime_error("sample container " + fileName_ + " is already closed");
+    }
+  }
+
+  void writeHeader(const std::uint64_t indexOffset, const std::uint64_t indexBytes)
+  {
+    std::string header(impl::containerMagic, 8);
+    impl::append_pod(header, impl::containerVersion);
+    impl::append_pod(header, tileRows_);
+    impl::append_pod(header, tileCols_);
+    impl::append_pod(header, indexOffset);
+    impl::append_pod(header, indexBytes);
+    std::fseek(file_, 0, SEEK_SET);
+    if (std::fwrite(header.data(), 1, header.size(), file_) != header.size()){
+      throw std::runtime_error("error writing sample container " + fileName_);
+    }
+  }
+};
+
+/*
+ * Reads a container: the header and the index are loaded on
+ * construction, blocks of a matrix are read on demand.
+ */
+class SampleContainerReader
+{
+  std::string fileName_;
+  std::FILE * file_ = nullptr;
+  std::uint64_t tileRows_ = 0;
+  std::uint64_t tileCols_ = 0;
+  std::vector<SampleMetadata> samples_;
+  std::vector<ContainerMatrixEntry> matrices_;
+
+public:
+  explicit SampleContainerReader(const std::string & fileName)
+    : fileName_(fileName),
+      file_(std::fopen(fileName.c_str(), "rb"))
+  {
+    if (!file_){
+      throw std::runtime_error("cannot open " + fileName + " for reading");
+    }
+
+    std::string header(impl::containerHeaderBytes, '\0');
+    readBytes(0, &header[0], header.size());
+    if (header.compare(0, 8, impl::containerMagic, 8) != 0){
+      throw std::runtime_error(fileName + " is not a sample container");
+    }
+    const std::string headerFields = header.substr(8);
+    impl::ContainerIndexParser hp(headerFields);
+    if (hp.pod<std::uint64_t>() != impl::containerVersion){
+      throw std::runtime_error("Unsupported version of sample container " + fileName);
+    }
+    tileRows_ = hp.pod<std::uint64_t>();
+    tileCols_ = hp.pod<std::uint64_t>();
+    const auto indexOffset = hp.pod<std::uint64_t>();
+    const auto indexBytes  = hp.pod<std::uint64_t>();
+    if (indexOffset == 0){
+      throw std::runtime_error("Sample container " + fileName + " was not closed, no index");
+    }
+
+    std::string index(indexBytes, '\0');
+    readBytes(indexOffset, &index[0], index.size());
+    impl::ContainerIndexParser ip(index);
+    samples_.resize(ip.pod<std::uint64_t>());
+    for (auto & s : samples_){
+      s.sampleID = ip.pod<std::uint64_t>();
+      s.depth	 = ip.pod<double>();
+      s.period	 = ip.pod<double>();
+      s.angle	 = ip.pod<double>();
+      s.delay	 = ip.pod<double>();
+      s.signal	 = ip.string();
+    }
+    matrices_.resize(ip.pod<std::uint64_t>());
+    for (auto & m : matrices_){
+      m.name	 = ip.string();
+      m.sampleID = ip.pod<std::uint64_t>();
+      m.rows	 = ip.pod<std::uint64_t>();
+      m.cols	 = ip.pod<std::uint64_t>();
+      m.offset	 = ip.pod<std::uint64_t>();
+    }
+  }
+
+  SampleContainerReader(const SampleContainerReader &) = delete;
+  SampleContainerReader & operator=(const SampleContainerReader &) = delete;
+
+  ~SampleContainerReader(){
+    std::fclose(file_);
+  }
+
+  const std::vector<SampleMetadata> & viewSamples() const{ return samples_; }
+  const std::vector<ContainerMatrixEntry> & viewMatrices() const{ return matrices_; }
+
+  const ContainerMatrixEntry & findMatrix(const std::string & name,
+					  const std::uint64_t sampleID) const
+  {
+    for (const auto & m : matrices_){
+      if (m.name == name and m.sampleID == sampleID) return m;
+    }
+    throw std::runtime_error("No matrix " + name + " for sample " +
+			     std::to_string(sampleID) + " in " + fileName_);
+  }
+
+  /*
+   * reads rows [r0, r1) and columns [c0, c1) of a matrix into dest,
+   * column-major with leading dimension ld. Each intersecting tile is
+   * read with one call, only for the columns in the range.
+   */
+  void readBlock(const ContainerMatrixEntry & m,
+		 const std::uint64_t r0, const std::uint64_t r1,
+		 const std::uint64_t c0, const std::uint64_t c1,
+		 double * dest, const std::uint64_t ld) const
+  {
+    if (r0 > r1 or r1 > m.rows or c0 > c1 or c1 > m.cols or ld < r1-r0){
+      throw std::runtime_error("Invalid block of matrix " + m.name + " in " + fileName_);
+    }
+
+    std::vector<double> buffer;
+    for (auto tc=c0/tileCols_; tc*tileCols_<c1; ++tc)
+    {
+      const auto tc0 = tc*tileCols_;
+      const auto width = std::min(tileCols_, m.cols - tc0);
+      const auto ja = std::max(c0, tc0) - tc0;
+      const auto jb = std::min(c1, tc0 + width) - tc0;
+
+      for (auto tr=r0/tileRows_; tr*tileRows_<r1; ++tr)
+      {
+	const auto tr0 = tr*tileRows_;
+	const auto height = std::min(tileRows_, m.rows - tr0);
+	const auto ia = std::max(r0, tr0) - tr0;
+	const auto ib = std::min(r1, tr0 + height) - tr0;
+
+	// columns ja..jb of the tile are contiguous
+	const auto tileOffset = impl::containerTileOffset(m.rows, m.cols, tileRows_, tileCols_, tr, tc);
+	buffer.resize((jb-ja)*height);
+	readBytes(m.offset + (tileOffset + ja*height)*sizeof(double),
+		  reinterpret_cast<char *>(buffer.data()), buffer.size()*sizeof(double));
+
+	for (auto j=ja; j<jb; ++j){
+	  const double * src = buffer.data() + (j-ja)*height;
+	  double * dst = dest + (tc0+j-c0)*ld + (tr0+ia-r0);
+	  std::copy(src+ia, src+ib, dst);
+	}
+      }
+    }
+  }
+
+  // reads a whole matrix into dest, column-major
+  void readMatrix(const ContainerMatrixEntry & m, double * dest) const{
+    readBlock(m, 0, m.rows, 0, m.cols, dest, m.rows);
+  }
+
+private:
+  void readBytes(const std::uint64_t offset, char * dest, const std::size_t n) const
+  {
+    std::fseek(file_, static_cast<long>(offset), SEEK_SET);
+    if (std::fread(dest, 1, n, file_) != n){
+      throw std::runtime_error("error reading sample container " + fileName_);
+    }
+  }
+};
+
+#endif
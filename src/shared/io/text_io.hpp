@@ -0,0 +1,378 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// text_io.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef TEXT_IO_HPP_
+#define TEXT_IO_HPP_
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Buffered text IO shared by the ascii writers and readers.
+ * Values are formatted as an ostream does with std::setprecision(dblFmt),
+ * i.e. "%.17g" which round-trips doubles, so files are byte-identical
+ * to the ones written with operator<<, without a flush at every row.
+ * Rows can be formatted by several threads, in blocks that are
+ * written in order. Reading loads the whole file and parses it in place.
+ */
+namespace impl
+{
+
+// threads used to format rows, see setTextIoThreads
+inline std::size_t & textIoThreads(){
+  static std::size_t numThreads = 1;
+  return numThreads;
+}
+
+// appends v formatted as std::setprecision(dblFmt) would
+inline void append_double(std::string & out, const double v)
+{
+  char buf[32];
+  const int len = std::snprintf(buf, sizeof(buf), "%.*g", dblFmt, v);
+  out.append(buf, len);
+}
+
+// calls stop when leaving the scope, also when unwinding from an exception
+template <typename stop_t>
+class WorkerJoinGuard
+{
+  stop_t & stop_;
+
+public:
+  explicit WorkerJoinGuard(stop_t & stop) : stop_(stop){}
+  WorkerJoinGuard(const WorkerJoinGuard &) = delete;
+  WorkerJoinGuard & operator=(const WorkerJoinGuard &) = delete;
+  ~WorkerJoinGuard(){ stop_(); }
+};
+
+class TextFileWriter
+{
+  // bytes buffered before each write to the file
+  static constexpr std::size_t bufferBytes_ = std::size_t(1) << 22;
+  // rows formatted as one block by a thread
+  static constexpr std::size_t blockRows_ = 1024;
+
+  std::string fileName_;
+  std::FILE * file_ = nullptr;
+  std::string buffer_;
+
+public:
+  explicit TextFileWriter(const std::string & fileName)
+    : fileName_(fileName),
+      file_(std::fopen(fileName.c_str(), "w"))
+  {
+    if (!file_){
+      throw std::runtime_error("cannot open " + fileName + " for writing");
+    }
+    buffer_.reserve(bufferBytes_ + 4096);
+  }
+
+  TextFileWriter(const TextFileWriter &) = delete;
+  TextFileWriter & operator=(const TextFileWriter &) = delete;
+
+  // only releases the file: writers call close() to find out if the data
+  // made it to the file, so that a write error cannot escape the destructor
+  ~TextFileWriter(){
+    if (file_){
+      std::fclose(file_);
+    }
+  }
+
+  void writeLine(const std::string & line){
+    buffer_ += line;
+    buffer_ += '\n';
+    flushIfFull();
+  }
+
+  /*
+   * writes numRows rows, formatRow(i, out) appends row i to out.
+   * With more than one thread, a single set of workers is started for
+   * all the rows: worker t formats blocks t, t+numThreads, ... into a ring
+   * of slots, and the calling thread appends the blocks in order as they
+   * become ready. A slot is reused once its block has been appended,
+   * so at most 2*numThreads blocks are held in memory. If formatting or
+   * writing fails, all workers are stopped and joined before the
+   * exception reaches the caller.
+   */
+  template <typename format_row_t>
+  void writeRows(const std::size_t numRows, const format_row_t & formatRow)
+  {
+    const std::size_t numThreads = std::max<std::size_t>(1, textIoThreads());
+    if (numThreads == 1 or numRows <= blockRows_){
+      for (std::size_t i=0; i<numRows; ++i){
+	formatRow(i, buffer_);
+	flushIfFull();
+      }
+      return;
+    }
+
+    const std::size_t numBlocks = (numRows + blockRows_ - 1)/blockRows_;
+    const std::size_t numSlots = 2*numThreads;
+    std::vector<std::string> slots(numSlots);
+    // block held by each slot once formatted, numBlocks if none
+    std::vector<std::size_t> readyBlock(numSlots, numBlocks);
+    // blocks appended so far, block b can use its slot once b < appended + numSlots
+    std::size_t appended = 0;
+    // set when a worker or the calling thread fails, all threads then stop
+    bool aborted = false;
+    // first exception thrown by a worker, rethrown by the calling thread
+    std::exception_ptr workerError;
+    std::mutex mutex;
+    std::condition_variable slotFreed, blockReady;
+
+    auto work = [&](const std::size_t t){
+      try{
+	for (std::size_t b=t; b<numBlocks; b+=numThreads){
+	  const auto s = b % numSlots;
+	  {
+	    std::unique_lock<std::mutex> lock(mutex);
+	    slotFreed.wait(lock, [&](){ return aborted or b < appended + numSlots; });
+	    if (aborted) return;
+	  }
+	  slots[s].clear();
+	  const auto end = std::min(numRows, (b+1)*blockRows_);
+	  for (std::size_t i=b*blockRows_; i<end; ++i){
+	    formatRow(i, slots[s]);
+	  }
+	  {
+	    std::lock_guard<std::mutex> lock(mutex);
+	    readyBlock[s] = b;
+	  }
+	  blockReady.notify_one();
+	}
+      }
+      catch (...){
+	{
+	  std::lock_guard<std::mutex> lock(mutex);
+	  if (!workerError) workerError = std::current_exception();
+	  aborted = true;
+	}
+	slotFreed.notify_all();
+	blockReady.notify_all();
+      }
+    };
+
+    // stops and joins the workers however the calling thread leaves
+    std::vector<std::thread> workers;
+    auto stopWorkers = [&](){
+      {
+	std::lock_guard<std::mutex> lock(mutex);
+	aborted = true;
+      }
+      slotFreed.notify_all();
+      blockReady.notify_all();
+      for (auto & w : workers){
+	if (w.joinable()) w.join();
+      }
+    };
+    WorkerJoinGuard<decltype(stopWorkers)> guard(stopWorkers);
+
+    for (std::size_t t=0; t<numThreads; ++t){
+      workers.emplace_back(work, t);
+    }
+
+    for (std::size_t b=0; b<numBlocks; ++b){
+      const auto s = b % numSlots;
+      {
+	std::unique_lock<std::mutex> lock(mutex);
+	blockReady.wait(lock, [&](){ return aborted or readyBlock[s] == b; });
+	if (aborted) break;
+      }
+      buffer_ += slots[s];
+      {
+	std::lock_guard<std::mutex> lock(mutex);
+	appended = b+1;
+      }
+      slotFreed.notify_all();
+      flushIfFull();
+    }
+
+    stopWorkers();
+    if (workerError){
+      std::rethrow_exception(workerError);
+    }
+  }
+
+  void flush(){
+    if (!buffer_.empty()){
+      const auto written = std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+      if (written != buffer_.size()){
+	throw std::runtime_error("error writing " + fileName_);
+      }
+      buffer_.clear();
+    }
+  }
+
+  // flushes and closes the file, throws if any of the data was not written
+  void close(){
+    flush();
+    std::FILE * file = file_;
+    file_ = nullptr;
+    if (std::fclose(file) != 0){
+      throw std::runtime_error("error writing " + fileName_);
+    }
+  }
+
+private:
+  void flushIfFull(){
+    if (buffer_.size() >= bufferBytes_){
+      flush();
+    }
+  }
+};
+
+/*
+ * Whole-file text reader: tokens are whitespace separated and
+ * parsed with strtod/strtoull directly from the loaded buffer.
+ * Readers of row-based files use nextDoubleInLine and skipLine,
+ * so that a malformed row cannot shift the values of later rows.
+ */
+class TextFileReader
+{
+  std::string data_;
+  const char * pos_ = nullptr;
+
+public:
+  explicit TextFileReader(const std::string & fileName)
+  {
+    std::FILE * file = std::fopen(fileName.c_str(), "rb");
+    if (!file){
+      throw std::runtime_error("cannot open " + fileName + " for reading");
+    }
+    std::fseek(file, 0, SEEK_END);
+    const long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    data_.resize(size > 0 ? size : 0);
+    if (size > 0 and std::fread(&data_[0], 1, size, file) != static_cast<std::size_t>(size)){
+      std::fclose(file);
+      throw std::runtime_error("error reading " + fileName);
+    }
+    std::fclose(file);
+    pos_ = data_.c_str();
+  }
+
+  // false once only whitespace is left
+  bool hasNext(){
+    skipSpaces();
+    return *pos_ != '\0';
+  }
+
+  double nextDouble(){
+    char * end = nullptr;
+    const double v = std::strtod(pos_, &end);
+    throwIfNoToken(end);
+    pos_ = end;
+    return v;
+  }
+
+  std::size_t nextSize(){
+    char * end = nullptr;
+    const auto v = std::strtoull(pos_, &end, 10);
+    throwIfNoToken(end);
+    pos_ = end;
+    return static_cast<std::size_t>(v);
+  }
+
+  // next value of the current line, throws if the line has no values left
+  double nextDoubleInLine(){
+    while (*pos_ == ' ' or *pos_ == '\t' or *pos_ == '\r'){
+      ++pos_;
+    }
+    if (*pos_ == '\n' or *pos_ == '\0'){
+      throw std::runtime_error("missing value at line " + std::to_string(currentLine())
+			       + " of text file");
+    }
+    return nextDouble();
+  }
+
+  // moves to the start of the next line, ignoring what is left of the current one
+  void skipLine(){
+    while (*pos_ != '\n' and *pos_ != '\0'){
+      ++pos_;
+    }
+    if (*pos_ == '\n'){
+      ++pos_;
+    }
+  }
+
+private:
+  // only used for error messages
+  std::size_t currentLine() const{
+    return 1 + std::count(data_.c_str(), pos_, '\n');
+  }
+
+  void skipSpaces(){
+    while (*pos_ == ' ' or *pos_ == '\n' or *pos_ == '\t' or *pos_ == '\r'){
+      ++pos_;
+    }
+  }
+
+  void throwIfNoToken(const char * end) const{
+    if (end == pos_){
+      throw std::runtime_error("invalid or missing value in text file");
+    }
+  }
+};
+
+}// impl namespace
+
+// number of threads formatting the rows of ascii output, 1 by default
+inline void setTextIoThreads(const std::size_t numThreads){
+  impl::textIoThreads() = std::max<std::size_t>(1, numThreads);
+}
+
+#endif
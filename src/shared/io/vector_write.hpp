@@ -49,6 +49,7 @@
 #ifndef VECTOR_WRITE_HPP_
 #define VECTOR_WRITE_HPP_
 
+#include "text_io.hpp"
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -79,14 +80,15 @@ void write_vector_to_ascii(const std::string fileName,
 			   size_t n,
 			   bool printSize = true)
 {
-  std::ofstream file; file.open(fileName);
+  TextFileWriter file(fileName);
   if (printSize){
-    file << n << std::endl;
+    file.writeLine(std::to_string(n));
   }
 
-  for (size_t i=0; i<n; i++){
-    file << std::setprecision(dblFmt) << A(i) << " \n";
-  }
+  file.writeRows(n, [&](const std::size_t i, std::string & out){
+		      append_double(out, A(i));
+		      out += " \n";
+		    });
   file.close();
 }
 
@@ -53,12 +53,33 @@ template <typename scalar_t>
 class MaterialModelBase
 {
 public:
+  using batch_in_t  = Kokkos::View<const scalar_t*, Kokkos::HostSpace>;
+  using batch_out_t = Kokkos::View<scalar_t*, Kokkos::HostSpace>;
+
   // evaluate density and shear velocity at target location
   // each subclass implements this in a different way
   virtual void computeAt(const scalar_t & radiusFromCenterMeters,
 			 const scalar_t & angleRadians,
 			 scalar_t & density,
 			 scalar_t & vs) const = 0;
+
+  // true if the model only depends on the radius: in that case
+  // properties are evaluated and stored once per distinct radius
+  virtual bool isRadiallySymmetric() const{ return false; }
+
+  // evaluate density and shear velocity at a batch of locations.
+  // The default simply calls computeAt for each point, subclasses
+  // can override this to evaluate the whole batch in parallel.
+  virtual void computeAtBatch(batch_in_t radiiFromCenterMeters,
+			      batch_in_t anglesRadians,
+			      batch_out_t density,
+			      batch_out_t vs) const
+  {
+    for (std::size_t i=0; i<radiiFromCenterMeters.extent(0); ++i){
+      this->computeAt(radiiFromCenterMeters(i), anglesRadians(i),
+		      density(i), vs(i));
+    }
+  }
 };
 
 #endif
@@ -54,6 +54,8 @@
 template<typename scalar_t, typename parser_t>
 class BilayerMaterialModel final : public MaterialModelBase<scalar_t>
 {
+  using typename MaterialModelBase<scalar_t>::batch_in_t;
+  using typename MaterialModelBase<scalar_t>::batch_out_t;
   using profile_params_t = typename parser_t::profile_params_t;
   using discont_depth_t  = typename parser_t::discont_depth_t;
   const discont_depth_t  & discontDepthsKm_;
@@ -99,6 +101,38 @@ public:
       vs      = vsC[0]  + vsC[1]*dM  + vsC[2]*dM*dM;
     }
   }
+
+  bool isRadiallySymmetric() const final{ return true; }
+
+  void computeAtBatch(batch_in_t radiiFromCenterMeters,
+		      batch_in_t anglesRadians,
+		      batch_out_t density,
+		      batch_out_t vs) const final
+  {
+    constexpr auto thous = constants<scalar_t>::thousand();
+
+    // local copies so that the loop body only touches plain values
+    const auto surfR     = domainSurfaceRadiusMeters_;
+    const auto discontM  = discontDepthsKm_[1]*thous;
+    const auto rhoC1 = densityParams_[0];
+    const auto vsC1  = velocityParams_[0];
+    const auto rhoC2 = densityParams_[1];
+    const auto vsC2  = velocityParams_[1];
+
+    using policy_t = Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>;
+    Kokkos::parallel_for("bilayerBatch",
+			 policy_t(0, radiiFromCenterMeters.extent(0)),
+			 [=](const std::size_t i)
+			 {
+			   const auto thisPtDepthM = surfR - radiiFromCenterMeters(i);
+			   const bool inLayer1 = thisPtDepthM < discontM;
+			   const auto dM   = inLayer1 ? thisPtDepthM : thisPtDepthM - discontM;
+			   const auto & rhoC = inLayer1 ? rhoC1 : rhoC2;
+			   const auto & vsC  = inLayer1 ? vsC1  : vsC2;
+			   density(i) = rhoC[0] + rhoC[1]*dM + rhoC[2]*dM*dM;
+			   vs(i)      = vsC[0]  + vsC[1]*dM  + vsC[2]*dM*dM;
+			 });
+  }
 };
 
 #endif
@@ -50,10 +50,13 @@
 #define MATERIAL_MODEL_PREM_HPP_
 
 #include "material_model_base.hpp"
+#include <algorithm>
 
 template<typename scalar_t, typename parser_t>
 class PremMaterialModel final : public MaterialModelBase<scalar_t>
 {
+  using typename MaterialModelBase<scalar_t>::batch_in_t;
+  using typename MaterialModelBase<scalar_t>::batch_out_t;
   using profile_params_t = typename parser_t::profile_params_t;
 
   const scalar_t premEarthCmbKm_     = static_cast<scalar_t>(3480);
@@ -86,6 +89,30 @@ and r_surface=6371 km. It seems you are using a domain/mesh that does NOT match
 		 const scalar_t & angleRadians,
 		 scalar_t & rho,
 		 scalar_t & vs) const final
+  {
+    evaluate(radiusFromCenterMeters, rho, vs);
+  }
+
+  bool isRadiallySymmetric() const final{ return true; }
+
+  void computeAtBatch(batch_in_t radiiFromCenterMeters,
+		      batch_in_t anglesRadians,
+		      batch_out_t density,
+		      batch_out_t vs) const final
+  {
+    using policy_t = Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>;
+    Kokkos::parallel_for("premBatch",
+			 policy_t(0, radiiFromCenterMeters.extent(0)),
+			 [=](const std::size_t i)
+			 {
+			   evaluate(radiiFromCenterMeters(i), density(i), vs(i));
+			 });
+  }
+
+private:
+  static void evaluate(const scalar_t & radiusFromCenterMeters,
+		       scalar_t & rho,
+		       scalar_t & vs)
   {
     // If you use the Preliminary reference Earth model (PREM)
     // for your own research, please refer to
@@ -95,79 +122,60 @@ and r_surface=6371 km. It seems you are using a domain/mesh that does NOT match
 
     // https://www.cfa.harvard.edu/~lzeng/papers/PREM.pdf
 
+    // each layer is defined by its lower radius (km), sorted ascending,
+    // and extends up to the lower radius of the next one.
+    // In each layer, rho and vs are cubic polynomials in x = r/rSurface:
+    //   p(x) = c0 + c1*x + c2*x^2 + c3*x^3
+    static constexpr int numLayers = 12;
+    static constexpr scalar_t lowerRadiusKm[numLayers] =
+      {0.0, 1221.5, 3480.0, 3630.0, 5600.0, 5701.0,
+       5771.0, 5971.0, 6151.0, 6291.0, 6346.6, 6356.0};
+
+    static constexpr scalar_t rhoC[numLayers][4] =
+      {
+       {13.0885,  0.0,     -8.8381,  0.0},    // inner core
+       {12.5815, -1.2638,  -3.6426, -5.5281}, // outer core
+       {7.9565,  -6.4761,   5.5283, -3.0807}, // lower mantle part 1
+       {7.9565,  -6.4761,   5.5283, -3.0807}, // lower mantle part 2
+       {7.9565,  -6.4761,   5.5283, -3.0807}, // lower mantle part 3
+       {5.3197,  -1.4836,   0.0,     0.0},    // transition zone
+       {11.2494, -8.0298,   0.0,     0.0},    // transition zone
+       {7.1089,  -3.8045,   0.0,     0.0},    // transition zone
+       {2.691,    0.6924,   0.0,     0.0},
+       {2.691,    0.6924,   0.0,     0.0},
+       {2.9,      0.0,      0.0,     0.0},    // crust
+       {2.6,      0.0,      0.0,     0.0}     // crust
+      };
+
+    static constexpr scalar_t vsC[numLayers][4] =
+      {
+       {3.6678,   0.0,     -4.4475,  0.0},    // inner core
+       {0.0,      0.0,      0.0,     0.0},    // outer core
+       {6.9254,   1.4672,  -2.0834,  0.9783}, // lower mantle part 1
+       {11.1671, -13.7818, 17.4575, -9.2777}, // lower mantle part 2
+       {22.3459, -17.2473, -2.0834,  0.9783}, // lower mantle part 3
+       {9.9839,  -4.9324,   0.0,     0.0},    // transition zone
+       {22.3512, -18.5856,  0.0,     0.0},    // transition zone
+       {8.9496,  -4.4597,   0.0,     0.0},    // transition zone
+       {2.1519,   2.3481,   0.0,     0.0},
+       {2.1519,   2.3481,   0.0,     0.0},
+       {3.9,      0.0,      0.0,     0.0},    // crust
+       {3.2,      0.0,      0.0,     0.0}     // crust
+      };
+
     constexpr auto thousand  = constants<scalar_t>::thousand();
+    constexpr auto surfaceKm = static_cast<scalar_t>(6371);
     const auto rKm = radiusFromCenterMeters/thousand;
-    const auto x   = rKm/premEarthSurfaceKm_;
+    const auto x   = rKm/surfaceKm;
     const auto xSq = x*x;
     const auto xCu = x*x*x;
 
-    if(rKm >= 6356.0){
-      // crust
-      rho = 2.6;
-      vs = 3.2;
-    }
-    else if(rKm >= 6346.6 and rKm < 6356.0){
-      // crust
-      rho = 2.9;
-      vs = 3.9;
-    }
-
-    else if(rKm >= 6291.0 and rKm < 6346.6){
-      rho = 2.691  + 0.6924*x;
-      vs  = 2.1519 + 2.3481*x;
-    }
-
-    else if(rKm >= 6151.0 and rKm < 6291.0){
-      rho = 2.691  + 0.6924*x;
-      vs  = 2.1519 + 2.3481*x;
-    }
-
-    else if(rKm >= 5971.0 and rKm < 6151.0){
-      // transition zone
-      rho = 7.1089 - 3.8045*x;
-      vs  = 8.9496 - 4.4597*x;
-    }
-
-    else if(rKm >= 5771.0 and rKm < 5971.0){
-      // transition zone
-      rho = 11.2494 - 8.0298*x;
-      vs  = 22.3512 - 18.5856*x;
-    }
-
-    else if(rKm >= 5701.0 and rKm < 5771.0){
-      // transition zone
-      rho = 5.3197 - 1.4836*x;
-      vs  = 9.9839 - 4.9324*x;
-    }
-
-    else if(rKm >= 5600.0 and rKm < 5701.0){
-      // lower mantle part 3
-      rho = 7.9565 - 6.4761*x  + 5.5283*xSq - 3.0807*xCu;
-      vs = 22.3459 - 17.2473*x - 2.0834*xSq + 0.9783*xCu;
-    }
-
-    else if(rKm >= 3630.0 and rKm < 5600.0){
-      // lower mantle part 2
-      rho = 7.9565 - 6.4761*x  + 5.5283*xSq  - 3.0807*xCu;
-      vs = 11.1671 - 13.7818*x + 17.4575*xSq - 9.2777*xCu;
-    }
+    // find the last layer whose lower radius is <= rKm
+    const auto it = std::upper_bound(lowerRadiusKm, lowerRadiusKm+numLayers, rKm);
+    const int iL  = (it == lowerRadiusKm) ? 0 : static_cast<int>(it - lowerRadiusKm) - 1;
 
-    else if(rKm >= 3480.0 and rKm < 3630.0){
-      // lower mantle part 1
-      rho = 7.9565 - 6.4761*x + 5.5283*xSq - 3.0807*xCu;
-      vs  = 6.9254 + 1.4672*x - 2.0834*xSq + 0.9783*xCu;
-    }
-
-    else if(rKm >= 1221.5 and rKm < 3480.0){
-      // outer core
-      rho = 12.5815 - 1.2638*x - 3.6426*xSq - 5.5281*xCu;
-      vs = 0.0;
-    }
-    else if(rKm < 1221.5){
-      // inner core
-      rho = 13.0885 - 8.8381*xSq;
-      vs  = 3.6678  - 4.4475*xSq;
-    }
+    rho = rhoC[iL][0] + rhoC[iL][1]*x + rhoC[iL][2]*xSq + rhoC[iL][3]*xCu;
+    vs  = vsC[iL][0]  + vsC[iL][1]*x  + vsC[iL][2]*xSq  + vsC[iL][3]*xCu;
 
     // convert vs from km/s to m/s
     vs *= thousand;
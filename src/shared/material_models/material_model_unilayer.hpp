@@ -54,6 +54,8 @@
 template<typename scalar_t, typename parser_t>
 class UnilayerMaterialModel final : public MaterialModelBase<scalar_t>
 {
+  using typename MaterialModelBase<scalar_t>::batch_in_t;
+  using typename MaterialModelBase<scalar_t>::batch_out_t;
   using profile_params_t = typename parser_t::profile_params_t;
   const profile_params_t & densityParams_;
   const profile_params_t & velocityParams_;
@@ -81,6 +83,29 @@ public:
     density = rhoC[0] + rhoC[1]*dM + rhoC[2]*dM*dM;
     vs	    = vsC[0] + vsC[1]*dM + vsC[2]*dM*dM;
   }
+
+  bool isRadiallySymmetric() const final{ return true; }
+
+  void computeAtBatch(batch_in_t radiiFromCenterMeters,
+		      batch_in_t anglesRadians,
+		      batch_out_t density,
+		      batch_out_t vs) const final
+  {
+    // local copies so that the loop body only touches plain values
+    const auto surfR = domainSurfaceRadiusMeters_;
+    const auto rhoC  = densityParams_[0];
+    const auto vsC   = velocityParams_[0];
+
+    using policy_t = Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>;
+    Kokkos::parallel_for("unilayerBatch",
+			 policy_t(0, radiiFromCenterMeters.extent(0)),
+			 [=](const std::size_t i)
+			 {
+			   const auto dM = surfR - radiiFromCenterMeters(i);
+			   density(i) = rhoC[0] + rhoC[1]*dM + rhoC[2]*dM*dM;
+			   vs(i)      = vsC[0] + vsC[1]*dM + vsC[2]*dM*dM;
+			 });
+  }
 };
 
 #endif
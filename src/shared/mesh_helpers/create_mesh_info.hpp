@@ -0,0 +1,171 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// create_mesh_info.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef CREATE_MESH_INFO_HPP_
+#define CREATE_MESH_INFO_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace impl{
+
+/*
+  estimates the min shear velocity (m/s) of the built-in material model
+  over the domain by evaluating it on a probe grid, since the mesh
+  resolution is not known yet
+*/
+template <typename sc_t, typename parser_t>
+sc_t estimateMinShearVelocity(const parser_t & parser,
+			      const StructuredMeshGenerator<sc_t> & domain)
+{
+  if (parser.getMaterialModelKind() == materialModelKind::custom){
+    throw std::runtime_error
+      ("Generated mesh with a custom material model needs minShearVelocity");
+  }
+
+  const MeshInfo<sc_t> domainInfo(domain);
+  const auto matObj = createMaterialModel<sc_t>(parser, domainInfo);
+
+  constexpr auto thousand = constants<sc_t>::thousand();
+  constexpr std::size_t numProbesR  = 2001;
+  const std::size_t numProbesTh = matObj->isRadiallySymmetric() ? 1 : 721;
+
+  const sc_t rMin = domain.getCmbRadiusKm()*thousand;
+  const sc_t rMax = domain.getSurfaceRadiusKm()*thousand;
+  const sc_t thMin = degToRad(domain.getThetaLeftDeg());
+  const sc_t thMax = degToRad(domain.getThetaRightDeg());
+
+  sc_t minVel = std::numeric_limits<sc_t>::max();
+  sc_t density = {};
+  sc_t vs = {};
+  for (std::size_t j=0; j<numProbesR; ++j){
+    const sc_t r = rMin + (rMax-rMin)*j/static_cast<sc_t>(numProbesR-1);
+    for (std::size_t i=0; i<numProbesTh; ++i){
+      const sc_t th = numProbesTh == 1 ? thMin :
+	thMin + (thMax-thMin)*i/static_cast<sc_t>(numProbesTh-1);
+      matObj->computeAt(r, th, density, vs);
+      minVel = std::min(minVel, vs);
+    }
+  }
+  return minVel;
+}
+
+/*
+  smallest nr, nth such that the radial spacing and the arc at the surface
+  satisfy the same criterion of checkDispersionCriterion
+*/
+template <typename sc_t>
+StructuredMeshGenerator<sc_t>
+createGeneratorForFrequency(const std::array<sc_t,4> & bounds,
+			    const sc_t & maxFreq,
+			    const sc_t & minVel)
+{
+  constexpr auto thousand = constants<sc_t>::thousand();
+
+  // max spacing in meters
+  const sc_t ratio = minVel/(static_cast<sc_t>(Nlambda) * maxFreq);
+  const sc_t rSurf = bounds[3]*thousand;
+  const sc_t lengthR  = (bounds[3]-bounds[2])*thousand;
+  const sc_t lengthTh = degToRad(bounds[1]-bounds[0])*rSurf;
+
+  auto nr  = std::max<std::size_t>(2, static_cast<std::size_t>(std::ceil(lengthR/ratio))+1);
+  auto nth = std::max<std::size_t>(2, static_cast<std::size_t>(std::ceil(lengthTh/ratio))+1);
+
+  // the spacings computed by the generator can round above the estimate
+  StructuredMeshGenerator<sc_t> gen(nr, nth, bounds[0], bounds[1], bounds[2], bounds[3]);
+  while (gen.getRadialSpacingKm()*thousand > ratio or
+	 gen.getAngularSpacing()*rSurf > ratio)
+  {
+    if (gen.getRadialSpacingKm()*thousand > ratio) ++nr;
+    if (gen.getAngularSpacing()*rSurf > ratio) ++nth;
+    gen = StructuredMeshGenerator<sc_t>(nr, nth, bounds[0], bounds[1], bounds[2], bounds[3]);
+  }
+  return gen;
+}
+}//end namespace impl
+
+/*
+  reads the mesh info from meshDir, or generates the mesh in memory
+  from the mesh node of the general section
+*/
+template <typename sc_t, typename parser_t>
+MeshInfo<sc_t> createMeshInfo(const parser_t & parser)
+{
+  if (!parser.generateMesh()){
+    return MeshInfo<sc_t>(parser.getMeshDir());
+  }
+
+  const auto & bounds = parser.viewMeshBounds();
+  if (!parser.autoMeshResolution()){
+    const StructuredMeshGenerator<sc_t> gen(parser.getMeshNumPtsAlongR(),
+					    parser.getMeshNumPtsAlongTheta(),
+					    bounds[0], bounds[1], bounds[2], bounds[3]);
+    return MeshInfo<sc_t>(gen);
+  }
+
+  const auto maxFreq = parser.getMeshMaxFrequency();
+  auto minVel = parser.getMeshMinShearVelocity();
+  if (minVel == 0){
+    // coarsest mesh over the same domain, only the bounds are used
+    const StructuredMeshGenerator<sc_t> domain(2, 2, bounds[0], bounds[1], bounds[2], bounds[3]);
+    minVel = impl::estimateMinShearVelocity(parser, domain);
+  }
+  if (minVel <= 0){
+    throw std::runtime_error("Cannot pick the mesh resolution with min shear velocity <= 0");
+  }
+
+  const auto gen = impl::createGeneratorForFrequency(bounds, maxFreq, minVel);
+  std::cout << "\nmesh resolution for maxFrequency = " << maxFreq
+	    << " and minShearVelocity = " << minVel
+	    << ": nr = " << gen.getNumPtsAlongR()
+	    << ", nth = " << gen.getNumPtsAlongTheta() << std::endl;
+  return MeshInfo<sc_t>(gen);
+}
+
+#endif
@@ -49,6 +49,8 @@
 #ifndef READ_MESH_FILE_INFO_HPP_
 #define READ_MESH_FILE_INFO_HPP_
 
+#include <memory>
+
 template <typename sc_t, bool isFullMesh = true>
 class MeshInfo;
 
@@ -85,14 +87,30 @@ private:
   ordinal_type numPtsAlongR_ = {};
   ordinal_type numPtsAlongTh_ = {};
 
+  // non-null if the mesh is generated in memory instead of read from meshDir_
+  std::shared_ptr<const StructuredMeshGenerator<sc_t>> generator_ = {};
+
 public:
   MeshInfo(const std::string & meshDir)
   : meshDir_{meshDir}{
     this->readMeshInfoFile();
   }
 
+  MeshInfo(const StructuredMeshGenerator<sc_t> & generator)
+    : generator_{std::make_shared<const StructuredMeshGenerator<sc_t>>(generator)}{
+    this->setFromGenerator();
+  }
+
   const std::string  getMeshDir() const{ return meshDir_; }
 
+  bool isGenerated() const{ return generator_ != nullptr; }
+  const StructuredMeshGenerator<sc_t> & viewGenerator() const{
+    if (!generator_){
+      throw std::runtime_error("Mesh was read from file, no generator available");
+    }
+    return *generator_;
+  }
+
   const sc_t  getAngularSpacing() const{ return dth_; }
   const sc_t  getRadialSpacing() const{ return drr_; }
   const sc_t  getAngularSpacingInverse() const{ return dthInv_; }
@@ -113,6 +131,40 @@ public:
   ordinal_type getNumSpPts() const{ return numGptSp_; }
 
 private:
+  void setFromGenerator()
+  {
+    constexpr auto one	    = constants<sc_t>::one();
+    constexpr auto thousand = constants<sc_t>::thousand();
+
+    std::cout << std::endl;
+    std::cout << "*** Generating mesh in memory ***" << std::endl;
+
+    domainBounds_[0] = generator_->getThetaLeftDeg();
+    domainBounds_[1] = generator_->getThetaRightDeg();
+    domainBounds_[2] = generator_->getCmbRadiusKm()*thousand;
+    domainBounds_[3] = generator_->getSurfaceRadiusKm()*thousand;
+    dth_    = generator_->getAngularSpacing();
+    dthInv_ = one/dth_;
+    drr_    = generator_->getRadialSpacingKm()*thousand;
+    drrInv_ = one/drr_;
+    numGptVp_ = generator_->getNumVpPts();
+    numGptSp_ = generator_->getNumSpPts();
+    numPtsAlongR_  = generator_->getNumPtsAlongR();
+    numPtsAlongTh_ = generator_->getNumPtsAlongTheta();
+
+    std::cout << std::setprecision(dblFmt)
+	      << "thetaLeft (deg) = " << domainBounds_[0] << "\n"
+	      << "thetaRight (deg) = " << domainBounds_[1] << "\n"
+	      << "minimum radius (km) = " << domainBounds_[2]/thousand << "\n"
+	      << "surface radius (km) = " << domainBounds_[3]/thousand << "\n"
+	      << "dth [rad] = " << dth_ << "\n"
+	      << "drr [km] = " << drr_/thousand << "\n"
+	      << "numGptVp = " << numGptVp_ << "\n"
+	      << "numGptSp = " << numGptSp_ << "\n"
+	      << "nth = " << numPtsAlongTh_ << "\n"
+	      << "nr = " << numPtsAlongR_ << std::endl;
+  }
+
   void readMeshInfoFile()
   {
     constexpr auto one   = constants<sc_t>::one();
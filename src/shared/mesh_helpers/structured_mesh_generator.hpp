@@ -0,0 +1,270 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// structured_mesh_generator.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef STRUCTURED_MESH_GENERATOR_HPP_
+#define STRUCTURED_MESH_GENERATOR_HPP_
+
+#include <cmath>
+#include <stdexcept>
+
+/*
+  Generates in memory the same full mesh created by meshing/create_single_mesh.py,
+  so that graphs, coordinates and stencil coefficients do not need to be read from file.
+
+  Cells are enumerated along theta first, then along r: cell k=j*nth+i has
+  a velocity point at (thL+i*dth, rCmb+j*dr), a srp point shifted by dr/2
+  if j<nr-1 and a stp point shifted by dth/2 if i<nth-1.
+  Velocity and stress gids follow the cell ordering, with srp before stp
+  within a cell. Units match the mesh files: radius in km, theta in rad
+  for coordinates and degrees for the domain bounds.
+*/
+template <typename sc_t>
+class StructuredMeshGenerator
+{
+public:
+  using ordinal_type = std::size_t;
+
+private:
+  // num of points along r and theta
+  ordinal_type nr_  = {};
+  ordinal_type nth_ = {};
+
+  // domain bounds: theta in degrees, radius in km
+  sc_t thLDeg_  = {};
+  sc_t thRDeg_  = {};
+  sc_t rCmbKm_  = {};
+  sc_t rSurfKm_ = {};
+
+  // left bound in rad and spacing: theta in rad, radius in km
+  sc_t thL_  = {};
+  sc_t dth_  = {};
+  sc_t drKm_ = {};
+
+public:
+  StructuredMeshGenerator(const ordinal_type nr,
+			  const ordinal_type nth,
+			  const sc_t thLDeg  = static_cast<sc_t>(0),
+			  const sc_t thRDeg  = static_cast<sc_t>(180),
+			  const sc_t rCmbKm  = static_cast<sc_t>(3480),
+			  const sc_t rSurfKm = static_cast<sc_t>(6371))
+    : nr_(nr), nth_(nth),
+      thLDeg_(thLDeg), thRDeg_(thRDeg),
+      rCmbKm_(rCmbKm), rSurfKm_(rSurfKm)
+  {
+    if (nr_ < 2 or nth_ < 2){
+      throw std::runtime_error("Generated mesh needs at least 2 points along r and theta");
+    }
+    if (rCmbKm_ <= 0 or rCmbKm_ >= rSurfKm_){
+      throw std::runtime_error("Generated mesh needs 0 < rCmb < rSurf");
+    }
+    if (thLDeg_ >= thRDeg_){
+      throw std::runtime_error("Generated mesh needs thetaLeft < thetaRight");
+    }
+
+    // same operations as the python script, so that coordinates match bitwise
+    const sc_t oneEighty = static_cast<sc_t>(180);
+    thL_  = thLDeg_ * M_PI / oneEighty;
+    dth_  = (thRDeg_ * M_PI / oneEighty - thL_)/static_cast<sc_t>(nth_-1);
+    drKm_ = (rSurfKm_ - rCmbKm_)/static_cast<sc_t>(nr_-1);
+  }
+
+  ordinal_type getNumPtsAlongR() const{ return nr_; }
+  ordinal_type getNumPtsAlongTheta() const{ return nth_; }
+  ordinal_type getNumVpPts() const{ return nr_*nth_; }
+  // each row but the surface has nth srp and nth-1 stp, the surface only stp
+  ordinal_type getNumSpPts() const{ return (nr_-1)*(2*nth_-1) + nth_-1; }
+
+  sc_t getThetaLeftDeg() const{ return thLDeg_; }
+  sc_t getThetaRightDeg() const{ return thRDeg_; }
+  sc_t getCmbRadiusKm() const{ return rCmbKm_; }
+  sc_t getSurfaceRadiusKm() const{ return rSurfKm_; }
+  sc_t getAngularSpacing() const{ return dth_; }
+  sc_t getRadialSpacingKm() const{ return drKm_; }
+
+  /*
+    fills the velocity graph: each row has the vp gid followed by
+    the gids of the west, north, east, south stress points
+  */
+  template <typename graph_t, typename coords_t, typename cot_t>
+  void fillGraph(const dofId dofid, graph_t & graph, coords_t & coords, cot_t & cot) const
+  {
+    if (dofid != dofId::vp){
+      throw std::runtime_error("The stress graph needs the labels");
+    }
+
+    for (ordinal_type j=0; j<nr_; ++j){
+      for (ordinal_type i=0; i<nth_; ++i)
+      {
+	const auto vpGid = j*nth_+i;
+	graph(vpGid, 0) = vpGid;
+	// west: at thetaLeft use own stp (zero coeff)
+	graph(vpGid, 1) = i>0 ? stpGid(i-1, j) : stpGid(i, j);
+	// north: at surface, use the srp below (odd reflection)
+	graph(vpGid, 2) = j<nr_-1 ? srpGid(i, j) : srpGid(i, j-1);
+	// east: at thetaRight use the west stp (zero coeff)
+	graph(vpGid, 3) = i<nth_-1 ? stpGid(i, j) : stpGid(i-1, j);
+	// south: at cmb, use own srp (odd reflection)
+	graph(vpGid, 4) = j>0 ? srpGid(i, j-1) : srpGid(i, j);
+
+	setCoordinates(vpGid, thetaAt(i), radiusAt(j), isOnSymmetryAxis(i), coords, cot);
+      }
+    }
+  }
+
+  /*
+    fills the stress graph: each row has the sp gid followed by
+    the gids of north,south (srp) or west,east (stp) velocity points.
+    Labels are 1 for srp and 2 for stp.
+  */
+  template <typename graph_t, typename coords_t, typename cot_t, typename labels_t>
+  void fillGraph(const dofId dofid, graph_t & graph, coords_t & coords,
+		 cot_t & cot, labels_t & labels) const
+  {
+    if (dofid != dofId::sp){
+      throw std::runtime_error("Labels are only defined for the stress graph");
+    }
+
+    const auto oneHalf = static_cast<sc_t>(0.5);
+    for (ordinal_type j=0; j<nr_; ++j){
+      for (ordinal_type i=0; i<nth_; ++i)
+      {
+	const auto vpGid = j*nth_+i;
+	if (j < nr_-1){
+	  const auto gid = srpGid(i, j);
+	  graph(gid, 0) = gid;
+	  graph(gid, 1) = vpGid+nth_;
+	  graph(gid, 2) = vpGid;
+	  labels(gid) = 1;
+	  setCoordinates(gid, thetaAt(i), radiusAt(j)+drKm_*oneHalf,
+			 isOnSymmetryAxis(i), coords, cot);
+	}
+
+	// stp points are never on the symmetry axis
+	if (i < nth_-1){
+	  const auto gid = stpGid(i, j);
+	  graph(gid, 0) = gid;
+	  graph(gid, 1) = vpGid;
+	  graph(gid, 2) = vpGid+1;
+	  labels(gid) = 2;
+	  setCoordinates(gid, thetaAt(i)+dth_*oneHalf, radiusAt(j),
+			 false, coords, cot);
+	}
+      }
+    }
+  }
+
+  /*
+    fills the coefficients of the velocity stencil (west, north, east, south):
+    -1 reflects the stress at the cmb and surface, all are zero on the symmetry axis
+  */
+  template <typename coeffs_t>
+  void fillCoefficients(const dofId dofid, coeffs_t & coeffs) const
+  {
+    if (dofid != dofId::vp){
+      throw std::runtime_error("Stencil coefficients are only defined for velocity");
+    }
+
+    const auto zero = static_cast<sc_t>(0);
+    const auto one  = static_cast<sc_t>(1);
+    for (ordinal_type j=0; j<nr_; ++j){
+      for (ordinal_type i=0; i<nth_; ++i)
+      {
+	const auto vpGid = j*nth_+i;
+	if (isOnSymmetryAxis(i)){
+	  for (auto k=0; k<4; ++k) coeffs(vpGid, k) = zero;
+	}
+	else{
+	  coeffs(vpGid, 0) = one;
+	  coeffs(vpGid, 1) = j<nr_-1 ? one : -one;
+	  coeffs(vpGid, 2) = one;
+	  coeffs(vpGid, 3) = j>0 ? one : -one;
+	}
+      }
+    }
+  }
+
+private:
+  sc_t thetaAt(const ordinal_type i) const{ return thL_ + i*dth_; }
+  sc_t radiusAt(const ordinal_type j) const{ return rCmbKm_ + j*drKm_; }
+  bool isOnSymmetryAxis(const ordinal_type i) const{ return i==0 or i==nth_-1; }
+
+  // number of stress points in the cells before cell (i,j)
+  ordinal_type spOffset(const ordinal_type i, const ordinal_type j) const{
+    return j*(2*nth_-1) + (j<nr_-1 ? 2*i : i);
+  }
+
+  // srp exists only for j<nr-1
+  ordinal_type srpGid(const ordinal_type i, const ordinal_type j) const{
+    return spOffset(i, j);
+  }
+
+  // stp exists only for i<nth-1, it follows srp in the same cell
+  ordinal_type stpGid(const ordinal_type i, const ordinal_type j) const{
+    return spOffset(i, j) + (j<nr_-1 ? 1 : 0);
+  }
+
+  // same convention of the graph file reader: store theta and 1/r with r in meters
+  template <typename coords_t, typename cot_t>
+  static void setCoordinates(const ordinal_type gid,
+			     const sc_t theta,
+			     const sc_t radiusKm,
+			     const bool onSymAxis,
+			     coords_t & coords,
+			     cot_t & cot)
+  {
+    constexpr auto zero	    = constants<sc_t>::zero();
+    constexpr auto one	    = constants<sc_t>::one();
+    constexpr auto thousand = constants<sc_t>::thousand();
+
+    coords(gid, 0) = theta;
+    coords(gid, 1) = one/(radiusKm*thousand);
+    cot(gid) = onSymAxis ? zero : computeCotangent(coords(gid,0));
+  }
+};
+
+#endif
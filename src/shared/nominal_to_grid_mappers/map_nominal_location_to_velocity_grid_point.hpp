@@ -52,16 +52,15 @@
 #include <iostream>
 
 template <
-  typename scalar_t, typename bounds_t, typename int_t, typename gids_list_t, typename coords_t
+  typename scalar_t, typename bounds_t, typename index_t, typename coords_t
   >
-int_t mapNominalLocationToVelocityGridPoint(const scalar_t nominalAngleDeg,
-					    const scalar_t nominalRadiusM,
-					    const bounds_t & domainBounds,
-					    const int_t numGptVp,
-					    const gids_list_t & vpGidsList,
-					    const coords_t & vpCoords)
+typename index_t::ordinal_type
+mapNominalLocationToVelocityGridPoint(const scalar_t nominalAngleDeg,
+				      const scalar_t nominalRadiusM,
+				      const bounds_t & domainBounds,
+				      const index_t & vpSpatialIndex,
+				      const coords_t & vpCoords)
 {
-  int_t result = 0;
 
   constexpr auto one	  = constants<scalar_t>::one();
   constexpr auto thousand = static_cast<scalar_t>(1000);
@@ -85,22 +84,7 @@ int_t mapNominalLocationToVelocityGridPoint(const scalar_t nominalAngleDeg,
   }
 
   // find the velocity dof grid point that is closest to desired source
-  auto trialDistance = std::numeric_limits<scalar_t>::max();
-  for (int_t iPt=0; iPt < numGptVp; ++iPt){
-    // make sure to loop over the graph and get the GID from it
-    // because when we deal with sample mesh, iPt != ptGID
-    // since one has more state points than actual residual points
-    const auto & ptGID      = vpGidsList(iPt);
-    const auto thisPtTh     = vpCoords(ptGID, 0);
-    const auto thisPtRadius = one/vpCoords(ptGID, 1);
-
-    // polar coords distance from test point to target
-    auto thisD = computePolarDistance(thisPtRadius, thisPtTh, nominalRadiusM, nominalAngleRad);
-    if ( thisD <= trialDistance ){
-      trialDistance = thisD;
-      result = ptGID;
-    }
-  }
+  const auto result = vpSpatialIndex.findClosestGid(nominalRadiusM, nominalAngleRad);
   const auto srcTh = vpCoords(result,0);
   const auto srcRR = one/vpCoords(result,1);
 
@@ -55,15 +55,14 @@ template <
   typename scalar_t,
   typename bounds_t,
   typename int_t,
-  typename gids_list_t,
+  typename index_t,
   typename coords_t
   >
 void mapPointSourceToGridPoint(const scalar_t srcAngleDeg,
 			       const scalar_t srcRadiusKm,
 			       const scalar_t srcDepthKm,
 			       const bounds_t & domainBounds,
-			       const int_t numGptVp,
-			       const gids_list_t & gidsList,
+			       const index_t & vpSpatialIndex,
 			       const coords_t & coords,
 			       const scalar_t dth,
 			       int_t & pointGid)
@@ -103,22 +102,7 @@ void mapPointSourceToGridPoint(const scalar_t srcAngleDeg,
   }
 
   // find the velocity dof grid point that is closest to desired source
-  auto trialDistance = std::numeric_limits<scalar_t>::max();
-  for (int_t iPt=0; iPt < numGptVp; ++iPt){
-    // make sure to loop over the graph and get the GID from it
-    // because when we deal with sample mesh, iPt != ptGID
-    // since one has more state points than actual residual points
-    const auto & ptGID      = gidsList(iPt);
-    const auto thisPtTh     = coords(ptGID, 0);
-    const auto thisPtRadius = one/coords(ptGID, 1);
-
-    // polar coords distance from test point to target
-    auto thisD = computePolarDistance(thisPtRadius, thisPtTh, srcRadiusKm*thousand, srcAngleRad);
-    if ( thisD <= trialDistance ){
-      trialDistance = thisD;
-      pointGid = ptGID;
-    }
-  }
+  pointGid = vpSpatialIndex.findClosestGid(srcRadiusKm*thousand, srcAngleRad);
   const auto srcTh = coords(pointGid,0);
   const auto srcRR = one/coords(pointGid,1);
 
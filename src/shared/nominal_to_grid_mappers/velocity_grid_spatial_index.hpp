@@ -0,0 +1,239 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// velocity_grid_spatial_index.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef VELOCITY_GRID_SPATIAL_INDEX_HPP_
+#define VELOCITY_GRID_SPATIAL_INDEX_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+/*
+ * Spatial index over the velocity grid points used to find the
+ * grid point closest to a target location without scanning the full mesh.
+ *
+ * Points are binned on a uniform grid in Cartesian coordinates
+ * (x = r cos(theta), y = r sin(theta)), where the polar distance
+ * is the Euclidean one. A query visits rings of bins around the
+ * target until no unvisited bin can contain a closer point.
+ * This does not assume any structure of the mesh.
+ *
+ * Distances are computed with computePolarDistance exactly like the
+ * brute-force scan, and ties are resolved the same way: among points
+ * at the same distance, the one that comes last in the gids list wins.
+ */
+template <typename scalar_t, typename gids_list_t, typename coords_t>
+class VelocityGridSpatialIndex
+{
+public:
+  using ordinal_type = typename gids_list_t::non_const_value_type;
+
+private:
+  gids_list_t gidsList_ = {};
+  coords_t coords_ = {};
+
+  // bin layout
+  std::size_t nbx_ = 0;
+  std::size_t nby_ = 0;
+  scalar_t xMin_ = {};
+  scalar_t yMin_ = {};
+  scalar_t h_    = {};
+  scalar_t rMax_ = {};
+
+  // binStart_[b] is the offset in binItems_ of the first point in bin b.
+  // binItems_ stores positions in gidsList_, in increasing order within each bin.
+  std::vector<std::size_t> binStart_ = {};
+  std::vector<std::size_t> binItems_ = {};
+
+public:
+  VelocityGridSpatialIndex() = default;
+
+  VelocityGridSpatialIndex(const gids_list_t & gidsList,
+			   const coords_t & coords,
+			   const std::size_t targetPointsPerBin = 2)
+    : gidsList_(gidsList), coords_(coords)
+  {
+    const std::size_t numPts = gidsList_.extent(0);
+    if (numPts == 0){
+      throw std::runtime_error("Cannot build spatial index with zero points");
+    }
+
+    std::vector<scalar_t> x(numPts), y(numPts);
+    auto xMax = std::numeric_limits<scalar_t>::lowest();
+    auto yMax = std::numeric_limits<scalar_t>::lowest();
+    xMin_ = std::numeric_limits<scalar_t>::max();
+    yMin_ = std::numeric_limits<scalar_t>::max();
+    rMax_ = constants<scalar_t>::zero();
+    for (std::size_t iPt=0; iPt<numPts; ++iPt){
+      scalar_t r, th;
+      polarCoordsOf(iPt, r, th);
+      x[iPt] = r*std::cos(th);
+      y[iPt] = r*std::sin(th);
+      xMin_ = std::min(xMin_, x[iPt]); xMax = std::max(xMax, x[iPt]);
+      yMin_ = std::min(yMin_, y[iPt]); yMax = std::max(yMax, y[iPt]);
+      rMax_ = std::max(rMax_, r);
+    }
+
+    // pick square bins such that on average each one
+    // holds about targetPointsPerBin points
+    const auto Lx = xMax - xMin_;
+    const auto Ly = yMax - yMin_;
+    const auto area = std::max(Lx*Ly, std::max(Lx, Ly)*std::max(Lx, Ly)/numPts);
+    h_ = std::sqrt(area*targetPointsPerBin/numPts);
+    if (!(h_ > constants<scalar_t>::zero())){
+      h_ = constants<scalar_t>::one();
+    }
+    nbx_ = static_cast<std::size_t>(Lx/h_) + 1;
+    nby_ = static_cast<std::size_t>(Ly/h_) + 1;
+
+    // count points per bin and prefix-sum into binStart_
+    std::vector<std::size_t> binOf(numPts);
+    binStart_.assign(nbx_*nby_+1, 0);
+    for (std::size_t iPt=0; iPt<numPts; ++iPt){
+      binOf[iPt] = binIndex(clampBin(x[iPt]-xMin_, nbx_), clampBin(y[iPt]-yMin_, nby_));
+      ++binStart_[binOf[iPt]+1];
+    }
+    for (std::size_t b=0; b<nbx_*nby_; ++b){
+      binStart_[b+1] += binStart_[b];
+    }
+
+    // fill bins, looping in order keeps items sorted within each bin
+    binItems_.resize(numPts);
+    std::vector<std::size_t> cursor(binStart_.begin(), binStart_.end()-1);
+    for (std::size_t iPt=0; iPt<numPts; ++iPt){
+      binItems_[cursor[binOf[iPt]]++] = iPt;
+    }
+  }
+
+  std::size_t getNumBins() const{
+    return nbx_*nby_;
+  }
+
+  // returns the gid of the grid point closest to the target
+  ordinal_type findClosestGid(const scalar_t & targetRadius,
+			      const scalar_t & targetAngleRad) const
+  {
+    const auto tx = targetRadius*std::cos(targetAngleRad);
+    const auto ty = targetRadius*std::sin(targetAngleRad);
+    const auto bx = static_cast<long long>(clampBin(tx-xMin_, nbx_));
+    const auto by = static_cast<long long>(clampBin(ty-yMin_, nby_));
+
+    // computePolarDistance uses the law of cosines, which differs from the
+    // Cartesian distance by roundoff of order sqrt(eps)*r: keep a margin
+    // so that the stopping criterion never discards a point that ties
+    const auto slack = static_cast<scalar_t>(1e-7)*std::max(rMax_, targetRadius);
+
+    auto bestD = std::numeric_limits<scalar_t>::max();
+    std::size_t bestPos = 0;
+    bool found = false;
+
+    const auto maxRing = static_cast<long long>(std::max(nbx_, nby_));
+    for (long long k=0; k<=maxRing; ++k)
+    {
+      for (long long j=by-k; j<=by+k; ++j){
+	if (j < 0 or j >= static_cast<long long>(nby_)) continue;
+	// on the top/bottom rows of the ring visit all bins, otherwise only the two sides
+	const bool fullRow = (j==by-k or j==by+k);
+	const long long step = (fullRow or k==0) ? 1 : 2*k;
+	for (long long i=bx-k; i<=bx+k; i+=step){
+	  if (i < 0 or i >= static_cast<long long>(nbx_)) continue;
+	  visitBin(binIndex(i, j), targetRadius, targetAngleRad, bestD, bestPos, found);
+	}
+      }
+
+      // all points in rings beyond k are farther than k*h from the target
+      if (found and bestD + slack < static_cast<scalar_t>(k)*h_){
+	break;
+      }
+    }
+
+    return gidsList_(bestPos);
+  }
+
+private:
+  void polarCoordsOf(const std::size_t iPt, scalar_t & r, scalar_t & th) const
+  {
+    const auto ptGID = gidsList_(iPt);
+    th = coords_(ptGID, 0);
+    r  = constants<scalar_t>::one()/coords_(ptGID, 1);
+  }
+
+  std::size_t clampBin(const scalar_t & offset, const std::size_t nb) const
+  {
+    if (!(offset > constants<scalar_t>::zero())) return 0;
+    const auto b = static_cast<std::size_t>(offset/h_);
+    return std::min(b, nb-1);
+  }
+
+  std::size_t binIndex(const std::size_t i, const std::size_t j) const{
+    return j*nbx_ + i;
+  }
+
+  void visitBin(const std::size_t b,
+		const scalar_t & targetRadius,
+		const scalar_t & targetAngleRad,
+		scalar_t & bestD,
+		std::size_t & bestPos,
+		bool & found) const
+  {
+    for (auto k=binStart_[b]; k<binStart_[b+1]; ++k){
+      const auto iPt = binItems_[k];
+      scalar_t r, th;
+      polarCoordsOf(iPt, r, th);
+      const auto d = computePolarDistance(r, th, targetRadius, targetAngleRad);
+      if (d < bestD or (d == bestD and iPt > bestPos) or !found){
+	bestD = d;
+	bestPos = iPt;
+	found = true;
+      }
+    }
+  }
+};
+
+#endif
@@ -52,21 +52,47 @@
 template <typename ...parts>
 struct InputParser : parts...
 {
+private:
+  // if true, only predict memory and time, do not run
+  bool dryRun_ = false;
+
+public:
   InputParser(int argc, char *argv[])
   {
-    if (argc != 2){
-      throw std::runtime_error
-	("Wrong # of cmd line args, should be: ./exe <path-to-inputfile>");
+    const std::string usage =
+      "./exe <path-to-inputfile> [--restart <path-to-checkpoint>] [--dry-run]";
+    if (argc < 2){
+      throw std::runtime_error("Wrong # of cmd line args, should be: " + usage);
     }
 
     const std::string inputFile = argv[1];
+
+    // optional args following the input file
+    std::string restartFile = {};
+    for (int i=2; i<argc; ++i){
+      const std::string arg = argv[i];
+      if (arg == "--restart" and i+1 < argc){
+	restartFile = argv[++i];
+      }
+      else if (arg == "--dry-run"){
+	dryRun_ = true;
+      }
+      else{
+	throw std::runtime_error("Invalid cmd line arg: " + arg + ", should be: " + usage);
+      }
+    }
+
     std::cout << "*** Parsing input file ***\n";
     this->parseGeneral(inputFile);
     this->parseIo(inputFile);
     this->parseMaterial(inputFile);
     this->parseForcing(inputFile);
     this->parseRom(inputFile);
+    this->parseCheckpoint(inputFile, restartFile);
+    this->parsePerformance(inputFile);
   }
+
+  bool dryRun() const{ return dryRun_; }
 };
 
 #endif
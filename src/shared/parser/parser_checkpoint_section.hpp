@@ -0,0 +1,115 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// parser_checkpoint_section.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef SHAXIPP_PARSER_MIXIN_CHECKPOINT_SECTION_HPP_
+#define SHAXIPP_PARSER_MIXIN_CHECKPOINT_SECTION_HPP_
+
+template <typename scalar_t>
+struct ParserCheckpointSection
+{
+private:
+  // every how many time steps to write a checkpoint, 0 disables it
+  std::size_t checkpointInterval_ = 0;
+  std::string checkpointFileName_ = "checkpoint";
+
+  // checkpoint to resume from, passed via command line
+  std::string restartFileName_	= {};
+
+public:
+  auto enableCheckpoint() const{ return checkpointInterval_ > 0; }
+  auto getCheckpointInterval() const{ return checkpointInterval_; }
+  auto getCheckpointFileName() const{ return checkpointFileName_; }
+  auto enableRestart() const{ return !restartFileName_.empty(); }
+  auto getRestartFileName() const{ return restartFileName_; }
+
+public:
+  void parseCheckpoint(const std::string & inputFile,
+		       const std::string & restartFile)
+  {
+    restartFileName_ = restartFile;
+
+    const YAML::Node node0 = YAML::LoadFile(inputFile);
+
+    // checkpoint section is optional
+    const auto node = node0["checkpoint"];
+    if (node)
+    {
+      auto entry = "interval";
+      if (node[entry]) checkpointInterval_ = node[entry].as<std::size_t>();
+      else throw std::runtime_error("Checkpoint section needs an interval");
+
+      entry = "fileName";
+      if (node[entry]) checkpointFileName_ = node[entry].as<std::string>();
+
+      this->validate();
+    }
+
+    this->print();
+  }
+
+private:
+  void validate() const{
+    if (checkpointFileName_.empty()){
+      throw std::runtime_error("Cannot have an empty checkpoint fileName");
+    }
+  }
+
+  void print() const{
+    std::cout << std::endl;
+    std::cout << "enableCheckpoint = " << std::boolalpha << enableCheckpoint() << " \n";
+    if (enableCheckpoint()){
+      std::cout << "checkpointInterval = " << checkpointInterval_ << " \n"
+		<< "checkpointFileName = " << checkpointFileName_ << " \n";
+    }
+    if (enableRestart()){
+      std::cout << "restartFrom = " << restartFileName_ << " \n";
+    }
+  }
+};
+
+#endif
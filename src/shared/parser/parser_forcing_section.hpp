@@ -60,6 +60,10 @@ class ParserForcingSection
   bool multiForcing_	= false;
   bool enableRank2Mode_	= false;
   int forcingSize_ = 1;
+  // forcingSize: auto, the problem picks it by calibration
+  bool autoForcingSize_ = false;
+  // number of rank-1 samples advanced concurrently, each by one team
+  int ensembleSize_ = 1;
 
   signalKind kind_ = {};
   std::vector<scalar_t> depths_  = {}; // km;
@@ -76,6 +80,14 @@ public:
     return forcingSize_;
   }
 
+  bool autoForcingSize() const {
+    return autoForcingSize_;
+  }
+
+  int getEnsembleSize() const {
+    return ensembleSize_;
+  }
+
   bool multiForcing() const {
     return multiForcing_;
   }
@@ -171,9 +183,29 @@ public:
 	auto n5 = node2["forcingSize"];
        	if (n5){
 	  // if forcingSize is present and >=2, then rank-2 is on
-	  forcingSize_ = n5.as<int>();
+	  // with auto, the size is set after a calibration, 1 until then
+	  if (n5.as<std::string>() == "auto"){
+	    autoForcingSize_ = true;
+	  }
+	  else{
+	    forcingSize_ = n5.as<int>();
+	    if (forcingSize_ < 1){
+	      throw std::runtime_error("forcingSize must be >= 1 or auto");
+	    }
+	  }
 	  enableRank2Mode_ = true;
 	}
+
+	auto n6 = node2["ensembleSize"];
+       	if (n6){
+	  ensembleSize_ = n6.as<int>();
+	  if (ensembleSize_ < 1){
+	    throw std::runtime_error("ensembleSize must be >= 1");
+	  }
+	  if (enableRank2Mode_ and ensembleSize_ > 1){
+	    throw std::runtime_error("ensembleSize is for rank-1 runs, it cannot be used with forcingSize");
+	  }
+	}
       }
       else{
       	throw std::runtime_error
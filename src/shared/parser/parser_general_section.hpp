@@ -51,6 +51,7 @@
 
 #include "yaml-cpp/parser.h"
 #include "yaml-cpp/yaml.h"
+#include <array>
 #include <fstream>
 #include <iostream>
 
@@ -59,6 +60,20 @@ struct ParserGeneralSection
 {
 private:
   std::string meshDirName_ = "empty";
+
+  // with a mesh node, the mesh is generated in memory instead of read from meshDir,
+  // see structured_mesh_generator.hpp and create_mesh_info.hpp
+  bool generateMesh_ = false;
+  // num of points along r and theta: 0 means picked from the dispersion criterion
+  std::size_t meshNr_  = 0;
+  std::size_t meshNth_ = 0;
+  // thetaLeft (deg), thetaRight (deg), rCmb (km), rSurf (km)
+  std::array<scalar_t,4> meshBounds_ = {0., 180., 3480., 6371.};
+  // max frequency (Hz) resolved by the generated mesh when nr, nth are not given
+  scalar_t meshMaxFreq_ = {};
+  // min shear velocity (m/s) used for the dispersion criterion,
+  // if not given it is estimated from the material model
+  scalar_t meshMinVel_ = {};
   bool checkNumDispersion_ = true;
   bool checkCfl_	   = true;
   scalar_t dt_		   = {};
@@ -66,13 +81,60 @@ private:
   std::size_t NSteps_		   = {};
   bool exploitForcingSparsity_ = true;
 
+  // backend used to apply the sparse operators, see operator_backend_enums.hpp
+  operatorBackendKind operatorBackend_ = operatorBackendKind::kokkosSparse;
+  // number of trial steps timed for each backend when autotuning
+  std::size_t autotuneSteps_ = 10;
+  // file where autotuning decisions are cached across runs
+  std::string autotuneCacheFile_ = "operator_backend_cache.txt";
+
+  // how the time loop is run, see time_loop_enums.hpp
+  timeLoopKind timeLoop_ = timeLoopKind::automatic;
+  // with timeLoop: auto, meshes with at most this many dofs use persistent
+  std::size_t persistentMaxDofs_ = 50000;
+
+  // bits of the jacobian and graph indices: 32, 64 or 0 for auto,
+  // where auto uses 32 whenever the mesh fits, see index_policy.hpp
+  std::size_t indexWidth_ = 0;
+
+  // free the data only needed to assemble the operators once they are built
+  bool leanMemory_ = false;
+
+  // first-touch states, observer buffers and jacobians with the threads
+  // that process their rows, see numa_placement.hpp
+  bool numaFirstTouch_ = false;
+  // back large host arrays with transparent huge pages
+  bool hugePages_ = false;
+
+  // keep each cell's velocity and stress DOFs next to each other
+  // in a single state array, see interleaved_layout.hpp
+  bool interleavedStates_ = false;
+
 public:
   auto getMeshDir() const{ return meshDirName_; }
+  auto generateMesh() const{ return generateMesh_; }
+  auto autoMeshResolution() const{ return generateMesh_ and meshNr_ == 0; }
+  auto getMeshNumPtsAlongR() const{ return meshNr_; }
+  auto getMeshNumPtsAlongTheta() const{ return meshNth_; }
+  const auto & viewMeshBounds() const{ return meshBounds_; }
+  auto getMeshMaxFrequency() const{ return meshMaxFreq_; }
+  auto getMeshMinShearVelocity() const{ return meshMinVel_; }
   auto checkDispersion() const{ return checkNumDispersion_; }
   auto checkCfl() const{ return checkCfl_; }
   auto getTimeStepSize() const{ return dt_; }
   auto getNumSteps() const{ return NSteps_; }
   auto exploitForcingSparsity() const{ return exploitForcingSparsity_; }
+  auto getOperatorBackend() const{ return operatorBackend_; }
+  auto autotuneOperatorBackend() const{ return operatorBackend_ == operatorBackendKind::autotune; }
+  auto getAutotuneSteps() const{ return autotuneSteps_; }
+  auto getAutotuneCacheFile() const{ return autotuneCacheFile_; }
+  auto getTimeLoop() const{ return timeLoop_; }
+  auto getPersistentMaxDofs() const{ return persistentMaxDofs_; }
+  auto getIndexWidth() const{ return indexWidth_; }
+  auto leanMemory() const{ return leanMemory_; }
+  auto numaFirstTouch() const{ return numaFirstTouch_; }
+  auto hugePages() const{ return hugePages_; }
+  auto interleavedStates() const{ return interleavedStates_; }
 
 public:
   void parseGeneral(const std::string & inputFile)
@@ -85,7 +147,17 @@ public:
     {
       auto entry = "meshDir";
       if (node[entry]) meshDirName_ = node[entry].as<std::string>();
-      else throw std::runtime_error("Empty meshDir");
+
+      entry = "mesh";
+      if (node[entry]){
+	if (node["meshDir"]){
+	  throw std::runtime_error("Choose either meshDir or mesh in the general section");
+	}
+	this->parseMesh(node[entry]);
+      }
+      else if (!node["meshDir"]){
+	throw std::runtime_error("Empty meshDir");
+      }
 
       entry = "checkNumericalDispersion";
       if (node[entry]) checkNumDispersion_ = node[entry].as<bool>();
@@ -103,6 +175,51 @@ public:
 
       entry = "exploitForcingSparsity";
       if (node[entry]) exploitForcingSparsity_ = node[entry].as<bool>();
+
+      entry = "operatorBackend";
+      if (node[entry]){
+	operatorBackend_ = stringToOperatorBackendKind(node[entry].as<std::string>());
+      }
+
+      entry = "autotuneSteps";
+      if (node[entry]) autotuneSteps_ = node[entry].as<std::size_t>();
+
+      entry = "autotuneCacheFile";
+      if (node[entry]) autotuneCacheFile_ = node[entry].as<std::string>();
+
+      entry = "timeLoop";
+      if (node[entry]){
+	timeLoop_ = stringToTimeLoopKind(node[entry].as<std::string>());
+      }
+
+      entry = "persistentMaxDofs";
+      if (node[entry]) persistentMaxDofs_ = node[entry].as<std::size_t>();
+
+      entry = "indexWidth";
+      if (node[entry]){
+	const auto width = node[entry].as<std::string>();
+	if (width == "auto")	indexWidth_ = 0;
+	else if (width == "32") indexWidth_ = 32;
+	else if (width == "64") indexWidth_ = 64;
+	else throw std::runtime_error("Invalid indexWidth: choose 32, 64 or auto");
+      }
+
+      entry = "leanMemory";
+      if (node[entry]) leanMemory_ = node[entry].as<bool>();
+
+      entry = "numaFirstTouch";
+      if (node[entry]) numaFirstTouch_ = node[entry].as<bool>();
+
+      entry = "hugePages";
+      if (node[entry]) hugePages_ = node[entry].as<bool>();
+
+      entry = "stateLayout";
+      if (node[entry]){
+	const auto layout = node[entry].as<std::string>();
+	if (layout == "separate")	  interleavedStates_ = false;
+	else if (layout == "interleaved") interleavedStates_ = true;
+	else throw std::runtime_error("Invalid stateLayout: choose separate or interleaved");
+      }
     }
     else{
       throw std::runtime_error("General section in yaml input is mandatory!");
@@ -114,7 +231,51 @@ public:
   }
 
 private:
+  void parseMesh(const YAML::Node & meshNode)
+  {
+    generateMesh_ = true;
+
+    auto entry = "nr";
+    if (meshNode[entry]) meshNr_ = meshNode[entry].as<std::size_t>();
+
+    entry = "nth";
+    if (meshNode[entry]) meshNth_ = meshNode[entry].as<std::size_t>();
+
+    entry = "thetaLeft";
+    if (meshNode[entry]) meshBounds_[0] = meshNode[entry].as<scalar_t>();
+
+    entry = "thetaRight";
+    if (meshNode[entry]) meshBounds_[1] = meshNode[entry].as<scalar_t>();
+
+    entry = "rCmb";
+    if (meshNode[entry]) meshBounds_[2] = meshNode[entry].as<scalar_t>();
+
+    entry = "rSurf";
+    if (meshNode[entry]) meshBounds_[3] = meshNode[entry].as<scalar_t>();
+
+    entry = "maxFrequency";
+    if (meshNode[entry]) meshMaxFreq_ = meshNode[entry].as<scalar_t>();
+
+    entry = "minShearVelocity";
+    if (meshNode[entry]) meshMinVel_ = meshNode[entry].as<scalar_t>();
+  }
+
   void validate() const{
+    if (generateMesh_){
+      if ((meshNr_ == 0) != (meshNth_ == 0)){
+	throw std::runtime_error("Generated mesh needs both nr and nth, or neither with maxFrequency");
+      }
+      if (meshNr_ == 0 and meshMaxFreq_ <= 0){
+	throw std::runtime_error("Generated mesh needs nr and nth, or maxFrequency > 0");
+      }
+      if (meshNr_ != 0 and meshMaxFreq_ > 0){
+	throw std::runtime_error("Generated mesh: choose either nr and nth, or maxFrequency");
+      }
+      if (meshMinVel_ < 0){
+	throw std::runtime_error("Cannot have minShearVelocity < 0");
+      }
+    }
+
     if (dt_<=0.){
       throw std::runtime_error("Cannot have dt <= 0");
     }
@@ -122,15 +283,53 @@ private:
     if (finalTime_<=0.){
       throw std::runtime_error("Cannot have finalT <= 0");
     }
+
+    if (operatorBackend_ == operatorBackendKind::unknown){
+      throw std::runtime_error("Invalid operatorBackend: choose kokkosSparse, crsFunctor, sharedSparsity or auto");
+    }
+
+    if (autotuneSteps_ == 0){
+      throw std::runtime_error("Cannot have autotuneSteps = 0");
+    }
+
+    if (timeLoop_ == timeLoopKind::unknown){
+      throw std::runtime_error("Invalid timeLoop: choose kernels, persistent or auto");
+    }
   }
 
   void print() const{
-    std::cout << "\nmeshDir = "		<< meshDirName_		<< " \n"
-	      << "checkDispersion = "	<< std::boolalpha << checkNumDispersion_  << " \n"
+    if (generateMesh_){
+      std::cout << "\nmesh = generated, ";
+      if (meshNr_ != 0){
+	std::cout << "nr = " << meshNr_ << ", nth = " << meshNth_ << " \n";
+      }
+      else{
+	std::cout << "maxFrequency = " << meshMaxFreq_ << " \n";
+      }
+    }
+    else{
+      std::cout << "\nmeshDir = " << meshDirName_ << " \n";
+    }
+    std::cout << "checkDispersion = "	<< std::boolalpha << checkNumDispersion_  << " \n"
 	      << "timeStep = "		<< dt_			<< " \n"
 	      << "finalT = "		<< finalTime_		<< " \n"
 	      << "numSteps = "		<< NSteps_		<< " \n"
-	      << "exploitForcingSparsity " << exploitForcingSparsity_ << " \n";
+	      << "exploitForcingSparsity " << exploitForcingSparsity_ << " \n"
+	      << "operatorBackend = "	<< operatorBackendKindToString(operatorBackend_) << " \n";
+    if (autotuneOperatorBackend()){
+      std::cout << "autotuneSteps = "	<< autotuneSteps_	<< " \n"
+		<< "autotuneCacheFile = " << autotuneCacheFile_ << " \n";
+    }
+    std::cout << "timeLoop = " << timeLoopKindToString(timeLoop_) << " \n";
+    if (timeLoop_ == timeLoopKind::automatic){
+      std::cout << "persistentMaxDofs = " << persistentMaxDofs_ << " \n";
+    }
+    std::cout << "indexWidth = "
+	      << (indexWidth_ == 0 ? std::string("auto") : std::to_string(indexWidth_)) << " \n"
+	      << "leanMemory = " << std::boolalpha << leanMemory_ << " \n"
+	      << "numaFirstTouch = " << std::boolalpha << numaFirstTouch_ << " \n"
+	      << "hugePages = " << std::boolalpha << hugePages_ << " \n"
+	      << "stateLayout = " << (interleavedStates_ ? "interleaved" : "separate") << " \n";
   }
 };
 
@@ -72,6 +72,18 @@ private:
   std::size_t spSnapFreq_     = 0;
   std::string vpSnapFileName_ = "snaps_vp";
   std::string spSnapFileName_ = "snaps_sp";
+  // time integration writes straight into the snapshot matrix
+  bool snapZeroCopy_	      = false;
+  // rank-2: write each realization to its own file
+  bool snapSplitRealizations_ = false;
+  // only store the dofs in a region, every stride-th one, or from a gid list
+  bool snapRestrict_	      = false;
+  std::array<scalar_t,2> snapRadiusRange_ = {{0, std::numeric_limits<scalar_t>::max()}}; // km
+  std::array<scalar_t,2> snapAngleRange_  = {{std::numeric_limits<scalar_t>::lowest(),
+					     std::numeric_limits<scalar_t>::max()}}; // degrees
+  std::size_t snapStride_     = 1;
+  std::string vpSnapGidsFile_ = {};
+  std::string spSnapGidsFile_ = {};
 
   // *** seismogram ***
   bool enableSeismo_		  = false;
@@ -79,10 +91,42 @@ private:
   std::size_t seismoFreq_	  = 0;
   std::string seismogramFileName_ = "seismogram";
   receivers_loc_t receiversLocs_  = {5,30,60,90,120,150,175};
+  bool seismoSplitRealizations_   = false;
+
+  // *** asynchronous output of multi-forcing runs ***
+  bool enableAsyncWrite_	  = false;
+  // max number of observer/seismogram buffer sets
+  std::size_t asyncWriteBuffers_  = 2;
+  // memory budget [GB] for all buffer sets, <=0 means no limit
+  double asyncWriteBudget_	  = 0.;
+
+  // threads formatting the rows of ascii files, see text_io.hpp
+  std::size_t asciiThreads_	  = 1;
+
+  // *** single-file container for all samples, see sample_container.hpp ***
+  bool enableContainer_		  = false;
+  std::string containerFileName_  = "samples.shaw";
+  std::size_t containerTileRows_  = 4096;
+  std::size_t containerTileCols_  = 64;
 
 public:
   auto enableSnapshotMatrix() const{ return enableSnapMatrix_; }
   auto writeSnapshotsBinary()  const{ return snapWriteMode_ == writeMode::binary; }
+  auto snapshotsZeroCopy()     const{ return snapZeroCopy_; }
+  auto splitSnapshotRealizations() const{ return snapSplitRealizations_; }
+  auto restrictSnapshots()     const{ return snapRestrict_; }
+  auto getSnapshotRadiusRange() const{ return snapRadiusRange_; }
+  auto getSnapshotAngleRange()  const{ return snapAngleRange_; }
+  auto getSnapshotStride()      const{ return snapStride_; }
+
+  // file with the gids to store, empty if all
+  std::string getSnapshotGidsFile(const dofId & dof) const{
+    switch(dof){
+    case dofId::vp: return vpSnapGidsFile_;
+    case dofId::sp: return spSnapGidsFile_;
+    default: return std::string();
+    }
+  }
 
   std::size_t getSnapshotFreq(const dofId & dof) const{
     switch(dof){
@@ -105,6 +149,17 @@ public:
   auto getSeismogramFileName() const{ return seismogramFileName_; }
   auto getSeismoFreq() const{ return seismoFreq_; }
   auto getSeismoReceiversAnglesDeg() const{ return receiversLocs_; }
+  auto splitSeismogramRealizations() const{ return seismoSplitRealizations_; }
+
+  auto enableAsyncWrite() const{ return enableAsyncWrite_; }
+  auto getAsyncWriteBuffers() const{ return asyncWriteBuffers_; }
+  auto getAsyncWriteMemoryBudget() const{ return asyncWriteBudget_; }
+  auto getAsciiThreads() const{ return asciiThreads_; }
+
+  auto enableContainer() const{ return enableContainer_; }
+  auto getContainerFileName() const{ return containerFileName_; }
+  auto getContainerTileRows() const{ return containerTileRows_; }
+  auto getContainerTileCols() const{ return containerTileCols_; }
 
 public:
   void parseIo(const std::string & inputFile)
@@ -130,6 +185,24 @@ public:
 	this->parseSeismoInputs(seismoNode);
       }
 
+      // async write entry node
+      const auto asyncNode = ioNode["asyncWrite"];
+      if (asyncNode){
+	enableAsyncWrite_ = true;
+	this->parseAsyncWriteInputs(asyncNode);
+      }
+
+      if (ioNode["asciiThreads"]){
+	asciiThreads_ = ioNode["asciiThreads"].as<std::size_t>();
+      }
+
+      // container entry node
+      const auto containerNode = ioNode["container"];
+      if (containerNode){
+	enableContainer_ = true;
+	this->parseContainerInputs(containerNode);
+      }
+
       this->validate();
     }
 
@@ -144,6 +217,20 @@ private:
       snapWriteMode_ = useBinary ? writeMode::binary : writeMode::ascii;
     }
 
+    if (node["zeroCopy"]){
+      snapZeroCopy_ = node["zeroCopy"].as<bool>();
+    }
+
+    if (node["splitRealizations"]){
+      snapSplitRealizations_ = node["splitRealizations"].as<bool>();
+    }
+
+    const auto restrictNode = node["restrict"];
+    if (restrictNode){
+      snapRestrict_ = true;
+      this->parseSnapshotRestrictInputs(restrictNode);
+    }
+
     const auto veloNode = node["velocity"];
     if (veloNode)
     {
@@ -180,6 +267,31 @@ private:
       throw std::runtime_error("Cannot find io inputs for stress");
   }
 
+  void parseSnapshotRestrictInputs(const YAML::Node & node)
+  {
+    if (node["radius"]){
+      const auto v = node["radius"].as<std::vector<scalar_t>>();
+      if (v.size() != 2) throw std::runtime_error("restrict radius must be [min, max]");
+      snapRadiusRange_ = {{v[0], v[1]}};
+    }
+
+    if (node["angle"]){
+      const auto v = node["angle"].as<std::vector<scalar_t>>();
+      if (v.size() != 2) throw std::runtime_error("restrict angle must be [min, max]");
+      snapAngleRange_ = {{v[0], v[1]}};
+    }
+
+    if (node["stride"]){
+      snapStride_ = node["stride"].as<std::size_t>();
+    }
+
+    const auto gidsNode = node["gidsFile"];
+    if (gidsNode){
+      if (gidsNode["velocity"]) vpSnapGidsFile_ = gidsNode["velocity"].as<std::string>();
+      if (gidsNode["stress"])   spSnapGidsFile_ = gidsNode["stress"].as<std::string>();
+    }
+  }
+
   void parseSeismoInputs(const YAML::Node & node)
   {
     if (node["binary"]){
@@ -191,6 +303,10 @@ private:
       seismogramFileName_ = node["fileName"].as<std::string>();
     }
 
+    if (node["splitRealizations"]){
+      seismoSplitRealizations_ = node["splitRealizations"].as<bool>();
+    }
+
     auto entry = "freq";
     if (node[entry]) {
       seismoFreq_ = node[entry].as<std::size_t>();
@@ -209,6 +325,29 @@ private:
     }
   }
 
+  void parseAsyncWriteInputs(const YAML::Node & node)
+  {
+    if (node["buffers"]){
+      asyncWriteBuffers_ = node["buffers"].as<std::size_t>();
+    }
+    if (node["memoryBudget"]){
+      asyncWriteBudget_ = node["memoryBudget"].as<double>();
+    }
+  }
+
+  void parseContainerInputs(const YAML::Node & node)
+  {
+    if (node["fileName"]){
+      containerFileName_ = node["fileName"].as<std::string>();
+    }
+    if (node["tileRows"]){
+      containerTileRows_ = node["tileRows"].as<std::size_t>();
+    }
+    if (node["tileCols"]){
+      containerTileCols_ = node["tileCols"].as<std::size_t>();
+    }
+  }
+
   void validate() const
   {
     if (enableSnapMatrix_){
@@ -216,9 +355,31 @@ private:
       if (spSnapFreq_<=0) throw std::runtime_error("cannot have spSnapshotsFreq <=0 ");
     }
 
+    if (enableSnapMatrix_ and snapRestrict_){
+      if (snapStride_<1) throw std::runtime_error("cannot have snapshot restrict stride <1 ");
+      if (snapRadiusRange_[0] > snapRadiusRange_[1] or snapAngleRange_[0] > snapAngleRange_[1]){
+	throw std::runtime_error("snapshot restrict bounds must be [min, max]");
+      }
+      // the time loop writes whole states into the matrix
+      if (snapZeroCopy_){
+	throw std::runtime_error("zeroCopy snapshots cannot be restricted");
+      }
+    }
+
     if (enableSeismo_){
       if (seismoFreq_<=0) throw std::runtime_error("cannot have seismoFreq <=0 ");
     }
+
+    if (enableAsyncWrite_){
+      if (asyncWriteBuffers_<1) throw std::runtime_error("cannot have asyncWrite buffers <1 ");
+    }
+
+    if (asciiThreads_<1) throw std::runtime_error("cannot have asciiThreads <1 ");
+
+    if (enableContainer_){
+      if (containerTileRows_<1) throw std::runtime_error("cannot have container tileRows <1 ");
+      if (containerTileCols_<1) throw std::runtime_error("cannot have container tileCols <1 ");
+    }
   }
 
   void print() const
@@ -230,16 +391,42 @@ private:
 		<< "vpSnapshotsFileName_ = "  << vpSnapFileName_  << " \n"
 		<< "spSnapshotsFileName_ = "  << spSnapFileName_  << " \n"
 		<< "vpSnapshotsFreq_ = "      << vpSnapFreq_	  << " \n"
-		<< "spSnapshotsFreq_ = "      << spSnapFreq_	  << " \n";
+		<< "spSnapshotsFreq_ = "      << spSnapFreq_	  << " \n"
+		<< "zeroCopy = "	      << snapZeroCopy_	  << " \n"
+		<< "splitRealizations = "     << snapSplitRealizations_ << " \n"
+		<< "restrict = "	      << snapRestrict_ << " \n";
+      if (snapRestrict_){
+	std::cout << "radius = "   << snapRadiusRange_[0] << " " << snapRadiusRange_[1] << " \n"
+		  << "angle = "    << snapAngleRange_[0]  << " " << snapAngleRange_[1]  << " \n"
+		  << "stride = "   << snapStride_ << " \n"
+		  << "vpGidsFile = " << vpSnapGidsFile_ << " \n"
+		  << "spGidsFile = " << spSnapGidsFile_ << " \n";
+      }
     }
 
     std::cout << "enableSeimogram = " << std::boolalpha << enableSeismo_ << " \n";
     if (enableSeismo_){
       std::cout << "mode = "	<< writeModeToString(seismoWriteMode_) << " \n";
       std::cout << "Freq_ = "	<< seismoFreq_			      << " \n";
+      std::cout << "splitRealizations = " << seismoSplitRealizations_  << " \n";
       std::cout << "Locations: ";
       for (const auto & it : receiversLocs_) std::cout << it << " ";
     }
+
+    std::cout << std::endl;
+    std::cout << "enableAsyncWrite = " << std::boolalpha << enableAsyncWrite_ << " \n";
+    if (enableAsyncWrite_){
+      std::cout << "buffers = "	     << asyncWriteBuffers_ << " \n";
+      std::cout << "memoryBudget[GB] = " << asyncWriteBudget_  << " \n";
+    }
+    std::cout << "asciiThreads = " << asciiThreads_ << " \n";
+
+    std::cout << "enableContainer = " << std::boolalpha << enableContainer_ << " \n";
+    if (enableContainer_){
+      std::cout << "fileName = " << containerFileName_ << " \n";
+      std::cout << "tileRows = " << containerTileRows_ << " \n";
+      std::cout << "tileCols = " << containerTileCols_ << " \n";
+    }
   }
 
 };
@@ -0,0 +1,129 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// parser_performance_section.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef SHAXIPP_PARSER_MIXIN_PERFORMANCE_SECTION_HPP_
+#define SHAXIPP_PARSER_MIXIN_PERFORMANCE_SECTION_HPP_
+
+template <typename scalar_t>
+struct ParserPerformanceSection
+{
+private:
+  // true if the performance section is present
+  bool enablePerfReport_ = false;
+
+  // fence after every phase of a time step and record per-step latencies
+  bool enableFencedTiming_ = false;
+
+  // read hardware counters during the time loop
+  bool enableHardwareCounters_ = false;
+
+  // measured STREAM triad bandwidth of the machine in GB/s, 0 if unknown
+  scalar_t streamBandwidthGBs_ = {};
+
+  // json file to write the performance report to
+  std::string perfReportFileName_ = "perf_report.json";
+
+public:
+  auto enablePerfReport() const{ return enablePerfReport_; }
+  auto enableFencedTiming() const{ return enableFencedTiming_; }
+  auto enableHardwareCounters() const{ return enableHardwareCounters_; }
+  auto getStreamBandwidth() const{ return streamBandwidthGBs_; }
+  auto getPerfReportFileName() const{ return perfReportFileName_; }
+
+public:
+  void parsePerformance(const std::string & inputFile)
+  {
+    const YAML::Node node0 = YAML::LoadFile(inputFile);
+
+    // performance section is optional
+    const auto node = node0["performance"];
+    if (node)
+    {
+      enablePerfReport_ = true;
+
+      auto entry = "fencedTiming";
+      if (node[entry]) enableFencedTiming_ = node[entry].as<bool>();
+
+      entry = "hardwareCounters";
+      if (node[entry]) enableHardwareCounters_ = node[entry].as<bool>();
+
+      entry = "streamBandwidthGBs";
+      if (node[entry]) streamBandwidthGBs_ = node[entry].as<scalar_t>();
+
+      entry = "reportFileName";
+      if (node[entry]) perfReportFileName_ = node[entry].as<std::string>();
+
+      this->validate();
+    }
+
+    this->print();
+  }
+
+private:
+  void validate() const{
+    if (streamBandwidthGBs_ < static_cast<scalar_t>(0)){
+      throw std::runtime_error("streamBandwidthGBs cannot be negative");
+    }
+    if (perfReportFileName_.empty()){
+      throw std::runtime_error("Cannot have an empty performance reportFileName");
+    }
+  }
+
+  void print() const{
+    std::cout << std::endl;
+    std::cout << "enablePerfReport = " << std::boolalpha << enablePerfReport_ << " \n";
+    if (enablePerfReport_){
+      std::cout << "fencedTiming = " << std::boolalpha << enableFencedTiming_ << " \n"
+		<< "hardwareCounters = " << std::boolalpha << enableHardwareCounters_ << " \n"
+		<< "streamBandwidthGBs = " << streamBandwidthGBs_ << " \n"
+		<< "perfReportFileName = " << perfReportFileName_ << " \n";
+    }
+  }
+};
+
+#endif
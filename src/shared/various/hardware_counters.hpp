@@ -0,0 +1,266 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// hardware_counters.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef SHAXIPP_HARDWARE_COUNTERS_HPP_
+#define SHAXIPP_HARDWARE_COUNTERS_HPP_
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace kokkosapp{
+
+/*
+  Hardware counters (instructions, cycles, last-level cache misses) read
+  via Linux perf_event_open for all threads of the process existing at
+  construction, so a thread pool created by Kokkos::initialize is covered.
+
+  DRAM traffic is estimated as LLC misses times the cache line size:
+  this misses hardware prefetches and write-backs, so it is a lower bound.
+  Counters only see host threads, so on a GPU backend they do not measure
+  the kernels.
+
+  If counters cannot be opened (non-Linux, no PMU in a VM, restrictive
+  /proc/sys/kernel/perf_event_paranoid), available() returns false and
+  status() says why: start()/stop() are then no-ops.
+*/
+class HardwareCounters
+{
+public:
+  static constexpr std::size_t numEvents = 3;
+  enum eventId : std::size_t {instructions = 0, cycles = 1, llcMisses = 2};
+
+private:
+  bool available_ = false;
+  std::string status_ = "not supported on this platform";
+
+  // one group of counters for each thread, the group leader is first
+  std::vector<std::array<int, numEvents>> fds_ = {};
+
+  // accumulated counts, scaled if the counters were multiplexed
+  std::array<double, numEvents> counts_ = {};
+  double cacheLineBytes_ = 64.;
+
+public:
+  HardwareCounters(){
+#if defined(__linux__)
+    this->openCounters();
+#endif
+  }
+
+  ~HardwareCounters(){
+    this->closeCounters();
+  }
+
+  HardwareCounters(const HardwareCounters &) = delete;
+  HardwareCounters & operator=(const HardwareCounters &) = delete;
+
+  bool available() const{ return available_; }
+  const std::string & status() const{ return status_; }
+
+  double count(const eventId id) const{ return counts_[id]; }
+  double llcMissBytes() const{ return counts_[llcMisses]*cacheLineBytes_; }
+  std::size_t numThreads() const{ return fds_.size(); }
+
+  void start()
+  {
+#if defined(__linux__)
+    for (const auto & group : fds_){
+      ioctl(group[0], PERF_EVENT_IOC_RESET,  PERF_IOC_FLAG_GROUP);
+      ioctl(group[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+  }
+
+  void stop()
+  {
+#if defined(__linux__)
+    for (const auto & group : fds_){
+      ioctl(group[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    // read format: nr, time enabled, time running, values[nr]
+    for (const auto & group : fds_){
+      std::array<std::uint64_t, 3+numEvents> buffer = {};
+      const auto bytes = sizeof(std::uint64_t)*buffer.size();
+      if (read(group[0], buffer.data(), bytes) != static_cast<ssize_t>(bytes)){
+	continue;
+      }
+
+      const double enabled = static_cast<double>(buffer[1]);
+      const double running = static_cast<double>(buffer[2]);
+      const double scale   = running > 0. ? enabled/running : 0.;
+      for (std::size_t i=0; i<numEvents; ++i){
+	counts_[i] += scale*static_cast<double>(buffer[3+i]);
+      }
+    }
+#endif
+  }
+
+private:
+#if defined(__linux__)
+  static int openEvent(const std::uint64_t config, const pid_t tid, const int groupFd)
+  {
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size	     = sizeof(attr);
+    attr.type	     = PERF_TYPE_HARDWARE;
+    attr.config	     = config;
+    attr.disabled    = groupFd == -1 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv  = 1;
+    attr.read_format = PERF_FORMAT_GROUP |
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, tid, -1, groupFd, 0));
+  }
+
+  void openCounters()
+  {
+    const std::array<std::uint64_t, numEvents> configs =
+      {PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES};
+
+#if defined(_SC_LEVEL1_DCACHE_LINESIZE)
+    const long lineSize = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+    if (lineSize > 0) cacheLineBytes_ = static_cast<double>(lineSize);
+#endif
+
+    DIR * dir = opendir("/proc/self/task");
+    if (dir == nullptr){
+      status_ = "cannot list threads in /proc/self/task";
+      return;
+    }
+
+    std::vector<pid_t> tids;
+    while (const auto * entry = readdir(dir)){
+      if (entry->d_name[0] != '.') tids.push_back(std::atoi(entry->d_name));
+    }
+    closedir(dir);
+
+    for (const auto tid : tids)
+    {
+      std::array<int, numEvents> group;
+      group.fill(-1);
+      for (std::size_t i=0; i<numEvents; ++i){
+	group[i] = openEvent(configs[i], tid, i==0 ? -1 : group[0]);
+	if (group[i] == -1){
+	  status_ = std::string("perf_event_open failed: ") + std::strerror(errno) +
+	    " (check /proc/sys/kernel/perf_event_paranoid)";
+	  for (std::size_t j=0; j<i; ++j) close(group[j]);
+	  this->closeCounters();
+	  return;
+	}
+      }
+      fds_.push_back(group);
+    }
+
+    available_ = !fds_.empty();
+    status_ = available_ ? "ok" : "no threads found";
+  }
+#endif
+
+  void closeCounters()
+  {
+#if defined(__linux__)
+    for (const auto & group : fds_){
+      for (const auto fd : group) close(fd);
+    }
+#endif
+    fds_.clear();
+  }
+};
+
+/*
+  prints measured counters next to the traffic modeled by Complexity
+  (memCostMB is the modeled traffic of one step)
+*/
+void printHardwareCounters(const HardwareCounters & counters,
+			   const std::size_t loops,
+			   const double loopTimeSec,
+			   const double memCostMB,
+			   const double streamPeakGBs)
+{
+  if (!counters.available()){
+    std::cout << "hwCounters = unavailable: " << counters.status() << std::endl;
+    return;
+  }
+
+  using ev = HardwareCounters;
+  const double instr  = counters.count(ev::instructions);
+  const double cycles = counters.count(ev::cycles);
+  const double measuredGB = counters.llcMissBytes()/1024./1024./1024.;
+  const double modeledGB  = memCostMB*loops/1024.;
+
+  printf("hwThreads = %zu \n", counters.numThreads());
+  printf("hwInstructions = %.6e \n", instr);
+  printf("hwCycles = %.6e \n", cycles);
+  printf("hwIPC = %7.4lf \n", cycles > 0. ? instr/cycles : 0.);
+  printf("hwLlcMisses = %.6e \n", counters.count(ev::llcMisses));
+  printf("measuredMemGB = %10.4lf \n", measuredGB);
+  printf("modeledMemGB = %10.4lf \n", modeledGB);
+  printf("measuredOverModeledMem = %7.4lf \n", modeledGB > 0. ? measuredGB/modeledGB : 0.);
+  printf("measuredBandwidth(GB/s) = %8.2lf \n", measuredGB/loopTimeSec);
+  if (streamPeakGBs > 0.){
+    printf("fractionOfStreamPeak = %7.4lf \n", measuredGB/loopTimeSec/streamPeakGBs);
+  }
+}
+
+}//end namespace kokkosapp
+#endif
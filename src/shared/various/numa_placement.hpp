@@ -0,0 +1,259 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// numa_placement.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef SHAXIPP_NUMA_PLACEMENT_HPP_
+#define SHAXIPP_NUMA_PLACEMENT_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace kokkosapp{
+
+/*
+ * On NUMA machines a page is placed on the socket of the thread that
+ * first writes it. The helpers below allocate large arrays without
+ * initialization and zero them with a static partition of the rows,
+ * i.e. the same partition used by the range kernels that later process
+ * those rows (jacobian assembly, crsFunctor backend, snapshot copies),
+ * so that each thread mostly reads memory local to its socket.
+ * Threads must stay where they touched the pages: pin them, e.g. with
+ * OMP_PROC_BIND=spread OMP_PLACES=threads.
+ */
+
+template <typename view_t>
+constexpr bool isHostAccessible(){
+  return Kokkos::SpaceAccessibility<Kokkos::HostSpace,
+				    typename view_t::memory_space>::accessible;
+}
+
+// asks the kernel to back [ptr, ptr+bytes) with transparent huge pages
+inline void adviseHugePages(void * ptr, const std::size_t bytes)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  // only whole pages inside the range can be advised
+  const auto pageSize = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+  const auto begin = (reinterpret_cast<std::uintptr_t>(ptr) + pageSize - 1) & ~(pageSize - 1);
+  const auto end   = reinterpret_cast<std::uintptr_t>(ptr) + bytes;
+  if (end > begin){
+    madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);
+  }
+#endif
+}
+
+// zeroes all entries of row i, works for views of rank 1 to 3
+template <typename view_t>
+struct FirstTouchRows
+{
+  using value_t = typename view_t::non_const_value_type;
+  view_t v_;
+
+  FirstTouchRows(view_t v) : v_(v){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const std::size_t i) const{
+    for (std::size_t j=0; j<v_.extent(1); ++j){
+      for (std::size_t k=0; k<v_.extent(2); ++k){
+	v_.access(i, j, k) = value_t{};
+      }
+    }
+  }
+};
+
+template <typename exe_space, typename view_t>
+void firstTouch(const view_t & v, const bool hugePages)
+{
+  if (hugePages and isHostAccessible<view_t>()){
+    adviseHugePages(v.data(), v.span()*sizeof(typename view_t::value_type));
+  }
+  using policy_t = Kokkos::RangePolicy<exe_space, Kokkos::Schedule<Kokkos::Static>>;
+  Kokkos::parallel_for("firstTouch", policy_t(0, v.extent(0)), FirstTouchRows<view_t>(v));
+  exe_space().fence();
+}
+
+/*
+ * Allocates a zero-filled view. If firstTouchRows or hugePages are set,
+ * the memory is not initialized by the constructor but first-touched
+ * row by row by the threads of exe_space, optionally backed by huge pages.
+ */
+template <
+  typename view_t,
+  typename exe_space = typename view_t::execution_space,
+  typename ...Args
+  >
+view_t allocateWithPlacement(const std::string & label,
+			     const bool firstTouchRows,
+			     const bool hugePages,
+			     Args && ... extents)
+{
+  if (!firstTouchRows and !hugePages){
+    return view_t(label, std::forward<Args>(extents)...);
+  }
+
+  view_t v(Kokkos::view_alloc(Kokkos::WithoutInitializing, label),
+	   std::forward<Args>(extents)...);
+  firstTouch<exe_space>(v, hugePages);
+  return v;
+}
+
+template <typename view_t, typename parser_t, typename ...Args>
+view_t allocateWithPlacement(const parser_t & parser,
+			     const std::string & label,
+			     Args && ... extents)
+{
+  return allocateWithPlacement<view_t>(label, parser.numaFirstTouch(), parser.hugePages(),
+				       std::forward<Args>(extents)...);
+}
+
+/*
+ * Startup report of where the pages of the large arrays live:
+ * a sample of the pages of each array is queried with move_pages
+ * and the fraction on each NUMA node is printed.
+ */
+class PagePlacementReport
+{
+  // for each array: pages found on each node, last entry counts
+  // the pages whose node could not be determined
+  std::vector<std::pair<std::string, std::vector<std::size_t>>> rows_ = {};
+
+public:
+  template <typename view_t>
+  void add(const std::string & name, const view_t & v,
+	   const std::size_t maxSamples = 4096)
+  {
+    if (!isHostAccessible<view_t>() or v.span() == 0){
+      return;
+    }
+    const auto bytes = v.span()*sizeof(typename view_t::value_type);
+    add(name, reinterpret_cast<const char *>(v.data()), bytes, maxSamples);
+  }
+
+  void print() const
+  {
+    std::cout << "\n*** Page placement (fraction of sampled pages per NUMA node) ***"
+	      << std::endl;
+    for (const auto & it : rows_){
+      const auto & counts = it.second;
+      std::size_t total = 0;
+      for (auto c : counts){ total += c; }
+
+      std::cout << it.first << ":";
+      for (std::size_t n=0; n+1<counts.size(); ++n){
+	if (counts[n] > 0){
+	  std::cout << " node" << n << " = " << std::fixed << std::setprecision(1)
+		    << 100.*counts[n]/total << "%";
+	}
+      }
+      if (counts.back() > 0){
+	std::cout << " unknown = " << std::fixed << std::setprecision(1)
+		  << 100.*counts.back()/total << "%";
+      }
+      std::cout << std::endl;
+    }
+
+    if (std::getenv("OMP_PROC_BIND") == nullptr){
+      std::cout << "warning: OMP_PROC_BIND is not set, threads can migrate away "
+		<< "from the pages they first touched" << std::endl;
+    }
+  }
+
+private:
+  void add(const std::string & name, const char * data,
+	   const std::size_t bytes, const std::size_t maxSamples)
+  {
+    std::vector<std::size_t> counts(1, 0);
+#if defined(__linux__) && defined(SYS_move_pages)
+    const auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const auto numPages = (bytes + pageSize - 1)/pageSize;
+    const auto stride   = std::max<std::size_t>(1, numPages/maxSamples);
+
+    std::vector<void*> pages;
+    for (std::size_t p=0; p<numPages; p+=stride){
+      pages.push_back(const_cast<char *>(data) + p*pageSize);
+    }
+    std::vector<int> status(pages.size(), -1);
+
+    // with nodes = nullptr, move_pages only reports the node of each page
+    const long ierr = syscall(SYS_move_pages, 0, pages.size(), pages.data(),
+			      nullptr, status.data(), 0);
+    if (ierr == 0){
+      for (auto s : status){
+	if (s >= 0){
+	  const auto node = static_cast<std::size_t>(s);
+	  if (node+1 >= counts.size()){
+	    counts.insert(counts.end()-1, node+2-counts.size(), 0);
+	  }
+	  ++counts[node];
+	}
+	else{
+	  ++counts.back();
+	}
+      }
+    }
+    else{
+      counts.back() = pages.size();
+    }
+#else
+    counts.back() = 1;
+#endif
+    rows_.emplace_back(name, std::move(counts));
+  }
+};
+
+}//end namespace kokkosapp
+#endif
@@ -0,0 +1,438 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+// perf_report.hpp
+//                     		Pressio/SHAW
+//                         Copyright 2019
+// National Technology & Engineering Solutions of Sandia, LLC (NTESS)
+//
+// Under the terms of Contract DE-NA0003525 with NTESS, the
+// U.S. Government retains certain rights in this software.
+//
+// Pressio is licensed under BSD-3-Clause terms of use:
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+// contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+// IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Francesco Rizzi (fnrizzi@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef SHAXIPP_PERF_REPORT_HPP_
+#define SHAXIPP_PERF_REPORT_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace kokkosapp{
+
+// peak resident set size of the process in MB, negative if not available
+inline double peakResidentMemoryMB()
+{
+#if defined(__unix__) || defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0){
+#if defined(__APPLE__)
+    // ru_maxrss is in bytes on macOS
+    return static_cast<double>(usage.ru_maxrss)/1024./1024.;
+#else
+    // ru_maxrss is in kilobytes on Linux
+    return static_cast<double>(usage.ru_maxrss)/1024.;
+#endif
+  }
+#endif
+  return -1.;
+}
+
+// current resident set size of the process in MB, negative if not available
+inline double currentResidentMemoryMB()
+{
+#if defined(__linux__)
+  // second field of statm is the number of resident pages
+  std::ifstream statm("/proc/self/statm");
+  long pages = 0, residentPages = 0;
+  if (statm >> pages >> residentPages){
+    return static_cast<double>(residentPages)*sysconf(_SC_PAGESIZE)/1024./1024.;
+  }
+#endif
+  return -1.;
+}
+
+/*
+  collects the latencies (in seconds) of one phase over all time steps
+  in bounded memory: count, sum, min and max are exact, the histogram
+  has fixed log-spaced bins and the percentiles come from a uniform
+  reservoir of the samples, so they are exact until it fills up
+*/
+class LatencySamples
+{
+  // bins cover [1e-8, 1e2] seconds with 4 bins per decade,
+  // latencies outside are counted in the first or last bin
+  static constexpr int lowestDecade_  = -8;
+  static constexpr int binsPerDecade_ = 4;
+  static constexpr std::size_t numBins_ = 10*binsPerDecade_;
+  static constexpr std::size_t reservoirCapacity_ = 100000;
+
+  std::size_t count_ = 0;
+  double total_ = 0.;
+  double min_ = 0.;
+  double max_ = 0.;
+  std::array<std::size_t, numBins_> counts_ = {};
+  std::vector<double> reservoir_ = {};
+  // fixed seed: the same run always keeps the same samples
+  std::mt19937_64 engine_{20210617};
+
+public:
+  void add(const double seconds)
+  {
+    min_ = count_ == 0 ? seconds : std::min(min_, seconds);
+    max_ = count_ == 0 ? seconds : std::max(max_, seconds);
+    ++count_;
+    total_ += seconds;
+    counts_[binOf(seconds)]++;
+
+    if (reservoir_.size() < reservoirCapacity_){
+      reservoir_.push_back(seconds);
+    }
+    else{
+      // keep each of the count_ samples with equal probability
+      std::uniform_int_distribution<std::size_t> dist(0, count_-1);
+      const auto k = dist(engine_);
+      if (k < reservoirCapacity_) reservoir_[k] = seconds;
+    }
+  }
+
+  std::size_t size() const{ return count_; }
+
+  template <typename stream_t>
+  void writeJson(stream_t & os) const
+  {
+    std::vector<double> sorted(reservoir_);
+    std::sort(sorted.begin(), sorted.end());
+
+    os << "{\"count\": " << count_
+       << ", \"total\": " << total_
+       << ", \"mean\": "  << (count_>0 ? total_/count_ : 0.)
+       << ", \"min\": "   << min_
+       << ", \"p50\": "   << percentile(sorted, 50.)
+       << ", \"p90\": "   << percentile(sorted, 90.)
+       << ", \"p99\": "   << percentile(sorted, 99.)
+       << ", \"max\": "   << max_
+       << ", \"percentileSamples\": " << sorted.size();
+
+    // only the bins between the first and last non-empty ones are written
+    std::size_t first = 0, last = 0;
+    for (std::size_t i=0; i<numBins_; ++i){
+      if (counts_[i] == 0) continue;
+      if (counts_[first] == 0) first = i;
+      last = i;
+    }
+    os << ", \"histogram\": {\"edges\": [";
+    for (std::size_t i=first; i<=last+1 and count_>0; ++i){
+      os << (i>first ? ", " : "") << binEdge(i);
+    }
+    os << "], \"counts\": [";
+    for (std::size_t i=first; i<=last and count_>0; ++i){
+      os << (i>first ? ", " : "") << counts_[i];
+    }
+    os << "]}}";
+  }
+
+private:
+  static double binEdge(const std::size_t i){
+    return std::pow(10., lowestDecade_ + static_cast<double>(i)/binsPerDecade_);
+  }
+
+  static std::size_t binOf(const double seconds)
+  {
+    if (!(seconds > 0.)) return 0;
+    const auto pos = (std::log10(seconds) - lowestDecade_)*binsPerDecade_;
+    if (pos < 0.) return 0;
+    return std::min(static_cast<std::size_t>(pos), numBins_-1);
+  }
+
+  // nearest-rank percentile of sorted data
+  static double percentile(const std::vector<double> & sorted, const double p)
+  {
+    if (sorted.empty()) return 0.;
+    const auto rank = static_cast<std::size_t>(std::ceil(p/100.*sorted.size()));
+    return sorted[std::min(std::max(rank, std::size_t(1)), sorted.size())-1];
+  }
+};
+
+/*
+  machine-readable performance report: wall times of setup and output, per-step latencies
+  of each phase (only when fenced timing is on), complexity-based
+  bandwidth/GFlops estimates and peak memory, written to a json file
+*/
+class PerfReport
+{
+  bool enabled_ = false;
+  bool fencedTiming_ = false;
+  bool hardwareCounters_ = false;
+  double streamPeakGBs_ = 0.;
+  std::string fileName_ = {};
+
+  std::vector<std::pair<std::string, std::string>> info_ = {};
+  std::vector<std::pair<std::string, double>> wallTimes_ = {};
+  std::vector<std::pair<std::string, LatencySamples>> phases_ = {};
+
+  std::size_t numRuns_	    = 0;
+  std::size_t numSteps_	    = 0;
+  double loopTime_	    = 0.;
+  double dataCollectionTime_ = 0.;
+  // min, max, total of the compute time of one step
+  std::array<double, 3> perfTimes_ = {1e32, 0., 0.};
+  // false if a run did not measure these, e.g. the persistent time loop,
+  // in which case they are written as null
+  bool dataCollectionTimed_ = true;
+  bool stepExtremaTimed_ = true;
+  double memCostMB_ = 0.;
+  double flops_	    = 0.;
+
+  // hardware counters accumulated over all runs
+  std::string hwStatus_ = "disabled";
+  std::array<double, HardwareCounters::numEvents> hwCounts_ = {};
+  double hwMissBytes_ = 0.;
+  std::size_t hwThreads_ = 0;
+
+public:
+  PerfReport() = default;
+
+  template <typename parser_t>
+  explicit PerfReport(const parser_t & parser)
+    : enabled_(parser.enablePerfReport()),
+      fencedTiming_(parser.enableFencedTiming()),
+      hardwareCounters_(parser.enableHardwareCounters()),
+      streamPeakGBs_(parser.getStreamBandwidth()),
+      fileName_(parser.getPerfReportFileName())
+  {}
+
+  bool enabled() const{ return enabled_; }
+  bool fencedTiming() const{ return fencedTiming_; }
+  bool hardwareCounters() const{ return hardwareCounters_; }
+  double streamPeakGBs() const{ return streamPeakGBs_; }
+
+  template <typename T>
+  void addInfo(const std::string & key, const T & value){
+    info_.emplace_back(key, toJson(value));
+  }
+
+  // adds to the total wall time of a phase happening outside the time loop
+  void accumulateTime(const std::string & name, const double seconds)
+  {
+    for (auto & it : wallTimes_){
+      if (it.first == name){
+	it.second += seconds;
+	return;
+      }
+    }
+    wallTimes_.emplace_back(name, seconds);
+  }
+
+  // returns the id to use to record latencies of the phase
+  std::size_t registerPhase(const std::string & name)
+  {
+    for (std::size_t i=0; i<phases_.size(); ++i){
+      if (phases_[i].first == name) return i;
+    }
+    phases_.emplace_back(name, LatencySamples());
+    return phases_.size()-1;
+  }
+
+  void recordLatency(const std::size_t phaseId, const double seconds){
+    phases_[phaseId].second.add(seconds);
+  }
+
+  // dataCollectionTime and the min, max step times are NaN if not measured
+  void recordRun(const std::size_t numSteps,
+		 const double loopTime,
+		 const double dataCollectionTime,
+		 const std::array<double,3> & perfTimes,
+		 const double memCostMB,
+		 const double flops)
+  {
+    ++numRuns_;
+    numSteps_ += numSteps;
+    loopTime_ += loopTime;
+    if (std::isnan(dataCollectionTime)){
+      dataCollectionTimed_ = false;
+    }
+    else{
+      dataCollectionTime_ += dataCollectionTime;
+    }
+    if (std::isnan(perfTimes[0]) or std::isnan(perfTimes[1])){
+      stepExtremaTimed_ = false;
+    }
+    else{
+      perfTimes_[0] = std::min(perfTimes_[0], perfTimes[0]);
+      perfTimes_[1] = std::max(perfTimes_[1], perfTimes[1]);
+    }
+    perfTimes_[2] += perfTimes[2];
+    memCostMB_ = memCostMB;
+    flops_     = flops;
+  }
+
+  void recordCounters(const HardwareCounters & counters)
+  {
+    hwStatus_ = counters.status();
+    if (!counters.available()) return;
+
+    for (std::size_t i=0; i<HardwareCounters::numEvents; ++i){
+      hwCounts_[i] += counters.count(static_cast<HardwareCounters::eventId>(i));
+    }
+    hwMissBytes_ += counters.llcMissBytes();
+    hwThreads_ = counters.numThreads();
+  }
+
+  void write() const
+  {
+    std::ofstream os(fileName_);
+    if (!os.is_open()){
+      throw std::runtime_error("Cannot open performance report file: " + fileName_);
+    }
+    os << std::setprecision(10);
+
+    os << "{\n  \"info\": {";
+    for (std::size_t i=0; i<info_.size(); ++i){
+      os << (i>0 ? ", " : "") << "\"" << info_[i].first << "\": " << info_[i].second;
+    }
+    os << "},\n";
+
+    os << "  \"fencedTiming\": " << std::boolalpha << fencedTiming_ << ",\n";
+
+    os << "  \"wallTimes\": {";
+    for (std::size_t i=0; i<wallTimes_.size(); ++i){
+      os << (i>0 ? ", " : "") << "\"" << wallTimes_[i].first << "\": " << wallTimes_[i].second;
+    }
+    os << "},\n";
+
+    os << "  \"runs\": " << numRuns_ << ",\n"
+       << "  \"steps\": " << numSteps_ << ",\n"
+       << "  \"loopTime\": " << loopTime_ << ",\n"
+       << "  \"dataCollectionTime\": "
+       << (dataCollectionTimed_ ? toJson(dataCollectionTime_) : std::string("null")) << ",\n";
+
+    os << "  \"phases\": {";
+    for (std::size_t i=0; i<phases_.size(); ++i){
+      os << (i>0 ? ",\n    " : "\n    ") << "\"" << phases_[i].first << "\": ";
+      phases_[i].second.writeJson(os);
+    }
+    os << "\n  },\n";
+
+    // same figures as printPerf, based on the compute time of one step
+    const auto aveTime   = numSteps_>0 ? perfTimes_[2]/numSteps_ : 0.;
+    const auto memCostGB = memCostMB_/1024.;
+    const auto notTimed  = std::numeric_limits<double>::quiet_NaN();
+    const auto minTime   = stepExtremaTimed_ ? perfTimes_[0] : notTimed;
+    const auto maxTime   = stepExtremaTimed_ ? perfTimes_[1] : notTimed;
+    os << "  \"complexity\": {"
+       << "\"memMB\": " << memCostMB_
+       << ", \"flops\": " << flops_
+       << ", \"flopsPerByte\": " << toJson(flops_/(memCostMB_*1024.*1024.))
+       << ", \"aveBandwidthGBs\": " << toJson(memCostGB/aveTime)
+       << ", \"minBandwidthGBs\": " << toJson(memCostGB/maxTime)
+       << ", \"maxBandwidthGBs\": " << toJson(memCostGB/minTime)
+       << ", \"aveGFlops\": " << toJson(flops_/aveTime/1e9)
+       << ", \"minGFlops\": " << toJson(flops_/maxTime/1e9)
+       << ", \"maxGFlops\": " << toJson(flops_/minTime/1e9)
+       << "},\n";
+
+    // measured traffic is compared to the modeled one over the whole time loop
+    using ev = HardwareCounters;
+    const auto measuredGB = hwMissBytes_/1024./1024./1024.;
+    const auto modeledGB  = memCostGB*numSteps_;
+    const auto measuredBw = measuredGB/loopTime_;
+    os << "  \"hardwareCounters\": {"
+       << "\"status\": " << toJson(hwStatus_);
+    if (hwThreads_ > 0){
+      os << ", \"threads\": " << hwThreads_
+	 << ", \"instructions\": " << hwCounts_[ev::instructions]
+	 << ", \"cycles\": " << hwCounts_[ev::cycles]
+	 << ", \"ipc\": " << toJson(hwCounts_[ev::instructions]/hwCounts_[ev::cycles])
+	 << ", \"llcMisses\": " << hwCounts_[ev::llcMisses]
+	 << ", \"measuredMemGB\": " << measuredGB
+	 << ", \"modeledMemGB\": " << modeledGB
+	 << ", \"measuredOverModeledMem\": " << toJson(measuredGB/modeledGB)
+	 << ", \"measuredBandwidthGBs\": " << toJson(measuredBw);
+    }
+    os << ", \"streamPeakGBs\": " << streamPeakGBs_;
+    if (streamPeakGBs_ > 0.){
+      os << ", \"modeledFractionOfStreamPeak\": " << toJson(memCostGB/aveTime/streamPeakGBs_);
+      if (hwThreads_ > 0){
+	os << ", \"measuredFractionOfStreamPeak\": " << toJson(measuredBw/streamPeakGBs_);
+      }
+    }
+    os << "},\n";
+
+    os << "  \"peakMemoryMB\": " << peakResidentMemoryMB() << "\n}\n";
+    os.close();
+
+    std::cout << "Performance report written to " << fileName_ << std::endl;
+  }
+
+private:
+  static std::string toJson(const std::string & value){ return "\"" + value + "\""; }
+  static std::string toJson(const char * value){ return toJson(std::string(value)); }
+
+  // non-finite values (e.g. rates when nothing was timed) are not valid json
+  static std::string toJson(const double value){
+    if (!std::isfinite(value)) return "null";
+    std::ostringstream ss;
+    ss << std::setprecision(10) << value;
+    return ss.str();
+  }
+
+  template <typename T>
+  static std::string toJson(const T & value){
+    std::ostringstream ss;
+    ss << std::setprecision(17) << value;
+    return ss.str();
+  }
+};
+
+}//end namespace kokkosapp
+#endif
@@ -50,10 +50,12 @@
 #define SHAXIPP_KOKKOS_PRINT_PERF_HPP_
 
 #include <array>
+#include <cmath>
 #include <iostream>
 
 namespace kokkosapp{
 
+// min and max times are NaN if the steps were not timed one by one
 void printPerf(std::size_t loops,
 	       const std::array<double,3> perfTimes, // times are in seconds
 	       const double memCostMB,
@@ -64,23 +66,42 @@ void printPerf(std::size_t loops,
   const auto totalTimeSec = perfTimes[2];
   const auto aveTimeSec   = totalTimeSec/(double)loops;
   const double memCostGB  = memCostMB/1024.;
+  const bool extremaTimed = !std::isnan(minTimeSec) and !std::isnan(maxTimeSec);
 
   std::cout << "flops = " << flops << std::endl;
   std::cout << "memMB = " << memCostMB << std::endl;
   std::cout << "flops/bytes = " << flops/(memCostMB*1024.*1024.) << std::endl;
 
   printf("aveBandwidth(GB/s) = %8.2lf \n", memCostGB/aveTimeSec);
-  printf("minBandwidth(GB/s) = %8.2lf \n", memCostGB/maxTimeSec);
-  printf("maxBandwidth(GB/s) = %8.2lf \n", memCostGB/minTimeSec);
+  if (extremaTimed){
+    printf("minBandwidth(GB/s) = %8.2lf \n", memCostGB/maxTimeSec);
+    printf("maxBandwidth(GB/s) = %8.2lf \n", memCostGB/minTimeSec);
+  }
+  else{
+    printf("minBandwidth(GB/s) = n/a \n");
+    printf("maxBandwidth(GB/s) = n/a \n");
+  }
 
   printf("aveGFlop = %7.4lf \n", flops/aveTimeSec/1e9);
-  printf("minGFlop = %7.4lf \n", flops/maxTimeSec/1e9);
-  printf("maxGFlop = %7.4lf \n", flops/minTimeSec/1e9);
+  if (extremaTimed){
+    printf("minGFlop = %7.4lf \n", flops/maxTimeSec/1e9);
+    printf("maxGFlop = %7.4lf \n", flops/minTimeSec/1e9);
+  }
+  else{
+    printf("minGFlop = n/a \n");
+    printf("maxGFlop = n/a \n");
+  }
 
   printf("totTime(se) = %7.4lf \n", perfTimes[2]);
   printf("aveTime(ms) = %7.4lf \n", aveTimeSec*1000);
-  printf("maxTime(ms) = %7.4lf \n", maxTimeSec*1000);
-  printf("minTime(ms) = %7.4lf \n",  minTimeSec*1000);
+  if (extremaTimed){
+    printf("maxTime(ms) = %7.4lf \n", maxTimeSec*1000);
+    printf("minTime(ms) = %7.4lf \n",  minTimeSec*1000);
+  }
+  else{
+    printf("maxTime(ms) = n/a \n");
+    printf("minTime(ms) = n/a \n");
+  }
 }
 
 }// end namespace
@@ -2,6 +2,7 @@
 #include "CLI11.hpp"
 #include "Eigen/Dense"
 #include "../shared/constants.hpp"
+#include "../shared/io/sample_container.hpp"
 
 namespace
 {
@@ -196,52 +197,93 @@ void doThinSVDm1(T & A,
   std::cout << "----------------" << std::endl;
 }
 
+// snapshot matrix of sample 0 of a dof in the container of each dir,
+// like snaps_<dof>_0 for the other formats, read straight into the
+// columns of the result
+snap_t loadSnapshotsFromContainers(const std::string & dofName,
+				   const std::vector<std::string> & dirs,
+				   const std::string & containerFileName)
+{
+  const std::string name = "snaps_" + dofName;
+
+  // the indices give the extents, so the result is allocated once
+  std::vector<std::unique_ptr<SampleContainerReader>> containers;
+  std::vector<ContainerMatrixEntry> entries;
+  std::size_t numRows = 0;
+  std::size_t numCols = 0;
+  for (const auto & dirName : dirs){
+    const auto file = dirName + "/" + containerFileName;
+    std::cout << "\nReading snapshots: " << file << " " << name << "_0" << std::endl;
+    containers.emplace_back(new SampleContainerReader(file));
+    entries.push_back(containers.back()->findMatrix(name, 0));
+    if (numCols > 0 and entries.back().rows != numRows){
+      throw std::runtime_error("Mismatching # rows of current data with previous");
+    }
+    numRows = entries.back().rows;
+    numCols += entries.back().cols;
+  }
+
+  snap_t allSnaps(numRows, numCols);
+  std::size_t col = 0;
+  for (std::size_t i=0; i<containers.size(); ++i){
+    containers[i]->readMatrix(entries[i], allSnaps.data() + col*numRows);
+    col += entries[i].cols;
+  }
+  return allSnaps;
+}
+
 void processDirs(std::string dofName,
 		 const std::vector<std::string> & dirs,
 		 const std::string & outputFormat,
 		 const std::string & inputFormat,
+		 const std::string & containerFileName,
 		 const int method)
 {
   // the matrix containing all snapshots for this dof
   snap_t allSnaps;
 
-  // loop over dirs
   auto startTime1 = std::chrono::high_resolution_clock::now();
-  for (std::size_t iDir=0; iDir<dirs.size(); ++iDir)
-  {
-    const auto dirName = dirs[iDir];
-    const std::string file = dirName + "/snaps_"+dofName+"_0";
-    std::cout << "\nReading snapshots: " << file << std::endl;
-
-    // load curren snapshot matrix
-    std::size_t numRows  = {};
-    std::size_t numSnaps = {};
-    auto snaps = loadTargetSnapshotMatrix(file, numRows, numSnaps, inputFormat);
-
-    if (iDir == 0){
-      // when iDir == 0, needs to full resize allSnaps
-      allSnaps.resize(numRows, numSnaps);
-      allSnaps = snaps;
-    }
-    else{
-      // we need to increase size to make space for new snapshots but
-      // making sure the currently read snapshot matrix has
-      // the same number of rows otherwise something is wrong.
-
-      // current number of rows in allSnaps
-      const auto currNRowsAllSnaps = allSnaps.rows();
-      if (numRows != currNRowsAllSnaps){
-	throw std::runtime_error("Mismatching # rows of current data with previous");
+  if (inputFormat == "container"){
+    allSnaps = loadSnapshotsFromContainers(dofName, dirs, containerFileName);
+  }
+  else{
+    // loop over dirs
+    for (std::size_t iDir=0; iDir<dirs.size(); ++iDir)
+    {
+      const auto dirName = dirs[iDir];
+      const std::string file = dirName + "/snaps_"+dofName+"_0";
+      std::cout << "\nReading snapshots: " << file << std::endl;
+
+      // load curren snapshot matrix
+      std::size_t numRows  = {};
+      std::size_t numSnaps = {};
+      auto snaps = loadTargetSnapshotMatrix(file, numRows, numSnaps, inputFormat);
+
+      if (iDir == 0){
+	// when iDir == 0, needs to full resize allSnaps
+	allSnaps.resize(numRows, numSnaps);
+	allSnaps = snaps;
       }
-
-      // current number of cols in allSnaps
-      const auto currNColsAllSnaps = allSnaps.cols();
-      // resize to make space for current data
-      allSnaps.conservativeResize(numRows, currNColsAllSnaps+numSnaps);
-      // copy current snapshot matrix into allSnaps
-      allSnaps.block(0, currNColsAllSnaps, numRows, numSnaps) = snaps;
-    }
-  }//loop over dirs
+      else{
+	// we need to increase size to make space for new snapshots but
+	// making sure the currently read snapshot matrix has
+	// the same number of rows otherwise something is wrong.
+
+	// current number of rows in allSnaps
+	const auto currNRowsAllSnaps = allSnaps.rows();
+	if (numRows != currNRowsAllSnaps){
+	  throw std::runtime_error("Mismatching # rows of current data with previous");
+	}
+
+	// current number of cols in allSnaps
+	const auto currNColsAllSnaps = allSnaps.cols();
+	// resize to make space for current data
+	allSnaps.conservativeResize(numRows, currNColsAllSnaps+numSnaps);
+	// copy current snapshot matrix into allSnaps
+	allSnaps.block(0, currNColsAllSnaps, numRows, numSnaps) = snaps;
+      }
+    }//loop over dirs
+  }
 
   std::cout << "Final snapshot matrix size: "
 	    << allSnaps.rows() << " "
@@ -281,11 +323,14 @@ int main(int argc, char *argv[])
   std::vector<std::string> dirs = {};
   std::string outputFormat = {};
   std::string inputFormat = {};
+  std::string containerFileName = "samples.shaw";
   int method = -1;
   app.add_option("--dirs", dirs,
 		 "Directories")->required();
   app.add_option("--informat", inputFormat,
-		 "Inputformat: binary/ascii")->required();
+		 "Inputformat: binary/ascii/container")->required();
+  app.add_option("--container", containerFileName,
+		 "Container file in each directory, default samples.shaw");
   app.add_option("--outformat", outputFormat,
 		 "Outputformat: binary/ascii")->required();
   app.add_option("--method", method,
@@ -299,8 +344,8 @@ int main(int argc, char *argv[])
     throw std::runtime_error("Invalid method");
   }
 
-  processDirs("vp", dirs, inputFormat, outputFormat, method);
-  processDirs("sp", dirs, inputFormat, outputFormat, method);
+  processDirs("vp", dirs, outputFormat, inputFormat, containerFileName, method);
+  processDirs("sp", dirs, outputFormat, inputFormat, containerFileName, method);
 
   return 0;
 }
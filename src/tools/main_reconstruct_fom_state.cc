@@ -26,11 +26,15 @@ struct CmdArgs
   std::size_t samplingFreq = {};
   std::string outputFormat = {};
   std::string outFileAppend = {};
+  // matrix and sample to read when the ROM snaps are in a container
+  std::string containerMatrix = "snaps_vp";
+  std::size_t sampleID = 0;
 
   std::string podFilePath;
   bool podIsBinary;
   std::string romSnapFile;
   bool romSnapBinary;
+  bool romSnapContainer;
 
   // on input, we have the time steps so we need to convert
   // from time steps to indices of the snapsshopt matrix
@@ -50,7 +54,13 @@ struct CmdArgs
 		   "Pair: fullpath_POD_modes binary/ascii")->required();
 
     app.add_option("--romsnaps", romSnaps,
-		   "Pair: fullpath_ROM_snaps binary/ascii")->required();
+		   "Pair: fullpath_ROM_snaps binary/ascii/container")->required();
+
+    app.add_option("--containermatrix", containerMatrix,
+		   "Name of the ROM snaps in the container, default snaps_vp");
+
+    app.add_option("--sample", sampleID,
+		   "Sample of the ROM snaps in the container, default 0");
 
     app.add_option("--samplingfreq", samplingFreq,
 		   "Sampling freq used to save snapshot")->required();
@@ -78,6 +88,7 @@ struct CmdArgs
     podIsBinary   = std::get<1>(podModes)=="binary";
     romSnapFile   = std::get<0>(romSnaps);
     romSnapBinary = std::get<1>(romSnaps)=="binary";
+    romSnapContainer = std::get<1>(romSnaps)=="container";
     for (auto it : timeSteps){
       targetIndices.push_back( it / samplingFreq );
     }
@@ -91,6 +102,11 @@ struct CmdArgs
 	      << std::get<0>(romSnaps) << " "
 	      << std::get<1>(romSnaps) << std::endl;
 
+    if (romSnapContainer){
+      std::cout << "ROM snaps matrix = " << containerMatrix
+		<< " sample = " << sampleID << std::endl;
+    }
+
     std::cout << "ROM size = " << romSize << std::endl;
     std::cout << "Size of f = " << fSize << std::endl;
 
@@ -141,7 +157,10 @@ void execute_rank1(const CmdArgs & args, PhiType phi)
   // load ROM snaps
   using snap_t = Kokkos::View<scalar_type**, kll, exe_space>;
   snap_t snapsRom("snapsRom", 1, 1);
-  if (args.romSnapBinary){
+  if (args.romSnapContainer){
+    fillMatrixFromContainer(args.romSnapFile, args.containerMatrix, args.sampleID, snapsRom);
+  }
+  else if (args.romSnapBinary){
     fillMatrixFromBinary(args.romSnapFile, snapsRom, true);
   }
   else{
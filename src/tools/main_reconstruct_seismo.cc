@@ -99,6 +99,9 @@ int main(int argc, char *argv[])
   std::size_t fSize = {};
   std::string outputFormat = {};
   std::string outFileAppend = {};
+  // matrix and sample to read when the ROM snaps are in a container
+  std::string containerMatrix = "snaps_vp";
+  std::size_t sampleID = 0;
 
   app.add_option("--romsize", romSize,
 		 "ROM size")->required();
@@ -107,7 +110,13 @@ int main(int argc, char *argv[])
 		 "Pair: fullpath_POD_modes binary/ascii")->required();
 
   app.add_option("--romsnaps", romSnaps,
-		 "Pair: fullpath_ROM_snaps binary/ascii")->required();
+		 "Pair: fullpath_ROM_snaps binary/container")->required();
+
+  app.add_option("--containermatrix", containerMatrix,
+		 "Name of the ROM snaps in the container, default snaps_vp");
+
+  app.add_option("--sample", sampleID,
+		 "Sample of the ROM snaps in the container, default 0");
 
   app.add_option("--gridids", targetGridPoints,
 		 "List of grid pts IDs where to compute seismo")->required();
@@ -143,6 +152,7 @@ int main(int argc, char *argv[])
   const bool podIsBinary = std::get<1>(podModes)=="binary";
   const auto romSnapFile   = std::get<0>(romSnaps);
   const bool romSnapBinary = std::get<1>(romSnaps)=="binary";
+  const bool romSnapContainer = std::get<1>(romSnaps)=="container";
 
   Kokkos::initialize (argc, argv);
   {
@@ -162,7 +172,10 @@ int main(int argc, char *argv[])
       // *** load ROM states ***
       using snap_t = Kokkos::View<sc_t**, kll, exe_space>;
       snap_t snapsRom("snapsRom", 1, 1);
-      if (romSnapBinary){
+      if (romSnapContainer){
+	fillMatrixFromContainer(romSnapFile, containerMatrix, sampleID, snapsRom);
+      }
+      else if (romSnapBinary){
 	fillMatrixFromBinary(romSnapFile, snapsRom, true);
       }
       else{
@@ -0,0 +1,393 @@
+
+// include order below matters
+
+// common things
+#include "CLI11.hpp"
+#include "../shared/all.hpp"
+#include "../kokkos/types.hpp"
+#include "../kokkos/shwavepp.hpp"
+#include "../kokkos/fom_update_kernels.hpp"
+#include "KokkosBlas2_gemv.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+
+/*
+  Micro-benchmarks of the kernels of the time loop on a structured mesh
+  generated in memory: FOM velocity/stress updates (spmv for rank-1, spmm
+  for rank-2), the ROM gemv and the device-to-host copy done by the observer.
+  For each kernel, achieved bandwidth is computed from the Complexity model.
+
+  Threads are fixed by Kokkos::initialize, so to sweep thread counts
+  and pin threads use bash_scripts/run_shaw_bench.sh.
+*/
+
+// constant material: only the sparsity and values' magnitude matter here
+template <typename scalar_t>
+class BenchMaterialModel final : public MaterialModelBase<scalar_t>
+{
+public:
+  void computeAt(const scalar_t & radiusFromCenterInMeters,
+		 const scalar_t & angleRadians,
+		 scalar_t & density,
+		 scalar_t & vs) const final
+  {
+    density = static_cast<scalar_t>(4000);
+    vs	    = static_cast<scalar_t>(6000);
+  }
+
+  bool isRadiallySymmetric() const final{ return true; }
+};
+
+// forcing with the interface needed by updateVelocity
+template <typename scalar_t, typename state_d_t>
+struct BenchForcing
+{
+  using f_d_t	 = Kokkos::View<scalar_t*, typename state_d_t::memory_space>;
+  using gids_d_t = Kokkos::View<std::size_t*, typename state_d_t::memory_space>;
+
+  f_d_t f_d_;
+  gids_d_t gids_d_;
+
+  BenchForcing(const std::size_t nVp, const std::size_t fSize)
+    : f_d_("benchF", fSize == 1 ? nVp : fSize),
+      gids_d_("benchGids", fSize)
+  {
+    // all sources are at the same grid point in the middle of the mesh
+    Kokkos::deep_copy(gids_d_, nVp/2);
+  }
+
+  f_d_t viewForcingDevice() const{ return f_d_; }
+  gids_d_t getVpGidsDevice() const{ return gids_d_; }
+};
+
+struct BenchResult
+{
+  std::string kernel  = {};
+  std::size_t fSize   = {};
+  std::size_t rows    = {};
+  double memMB	      = {};
+  double flops	      = {};
+  std::vector<double> times = {};
+
+  double minTime() const{ return *std::min_element(times.begin(), times.end()); }
+  double medianTime() const{
+    auto sorted = times;
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[sorted.size()/2];
+  }
+  double meanTime() const{
+    return std::accumulate(times.begin(), times.end(), 0.)/times.size();
+  }
+};
+
+template <typename kernel_t>
+std::vector<double> timeKernel(kernel_t && kernel, const int warmup, const int reps)
+{
+  for (int i=0; i<warmup; ++i) kernel();
+  Kokkos::fence();
+
+  Kokkos::Timer timer;
+  std::vector<double> times(reps);
+  for (int i=0; i<reps; ++i){
+    timer.reset();
+    kernel();
+    Kokkos::fence();
+    times[i] = timer.seconds();
+  }
+  return times;
+}
+
+template <typename sc_t, typename mem_t>
+void allocateState(Kokkos::View<sc_t*, mem_t> & x, const std::size_t n, const std::size_t){
+  x = Kokkos::View<sc_t*, mem_t>("x", n);
+}
+
+template <typename sc_t, typename mem_t>
+void allocateState(Kokkos::View<sc_t**, mem_t> & x, const std::size_t n, const std::size_t fSize){
+  x = Kokkos::View<sc_t**, mem_t>("x", n, fSize);
+}
+
+template <typename snaps_t, typename x_t>
+typename std::enable_if<is_kokkos_1dview<x_t>::value>::type
+copyToSnapshotColumn(snaps_t snaps, x_t x, const std::size_t col){
+  Kokkos::deep_copy(Kokkos::subview(snaps, Kokkos::ALL(), col, 0), x);
+}
+
+template <typename snaps_t, typename x_t>
+typename std::enable_if<is_kokkos_2dview<x_t>::value>::type
+copyToSnapshotColumn(snaps_t snaps, x_t x, const std::size_t col){
+  Kokkos::deep_copy(Kokkos::subview(snaps, Kokkos::ALL(), col, Kokkos::ALL()), x);
+}
+
+template <typename state_d_t, typename app_t>
+void benchFom(const app_t & appObj,
+	      const std::size_t fSize,
+	      const std::size_t numSnaps,
+	      const int warmup,
+	      const int reps,
+	      std::vector<BenchResult> & results)
+{
+  using sc_t  = typename app_t::scalar_type;
+  using ord_t = typename app_t::jacobian_ord_type;
+  using comp_t = Complexity<sc_t>;
+  constexpr bool isRankOne = is_kokkos_1dview<state_d_t>::value;
+
+  const auto jacVp_d = appObj.viewJacobianDevice(dofId::vp);
+  const auto jacSp_d = appObj.viewJacobianDevice(dofId::sp);
+  const std::size_t nVp = jacVp_d.numRows();
+  const std::size_t nSp = jacSp_d.numRows();
+  const auto rhoInvVp_d = appObj.viewInvDensityDevice(dofId::vp);
+  const auto nnzVp = appObj.getJacobianNNZ(dofId::vp);
+  const auto nnzSp = appObj.getJacobianNNZ(dofId::sp);
+
+  state_d_t xVp_d, xSp_d;
+  allocateState(xVp_d, nVp, fSize);
+  allocateState(xSp_d, nSp, fSize);
+  Kokkos::deep_copy(xVp_d, constants<sc_t>::one());
+  Kokkos::deep_copy(xSp_d, constants<sc_t>::one());
+
+  // small dt so that repeated updates do not grow the states
+  const sc_t dt = static_cast<sc_t>(1e-12);
+  BenchForcing<sc_t, state_d_t> forcing(nVp, fSize);
+
+  BenchResult velo{"updateVelocity", fSize, nVp};
+  double memMB = {}, flops = {};
+  if (isRankOne){
+    comp_t::template spmv<ord_t>(nnzVp, nVp, velo.memMB, velo.flops);
+    comp_t::mult_beta_one(nVp, memMB, flops);
+  }
+  else{
+    comp_t::template spmm<ord_t>(nnzVp, nVp, fSize, velo.memMB, velo.flops);
+    memMB = 4.*fSize*sizeof(sc_t)/1024./1024.;
+    flops = 3.*fSize;
+  }
+  velo.memMB += memMB;
+  velo.flops += flops;
+  velo.times = timeKernel([&](){
+      kokkosapp::updateVelocity(dt, xVp_d, xSp_d, jacVp_d, rhoInvVp_d, forcing);
+    }, warmup, reps);
+  results.push_back(velo);
+
+  BenchResult stress{"updateStress", fSize, nSp};
+  if (isRankOne){
+    comp_t::template spmv<ord_t>(nnzSp, nSp, stress.memMB, stress.flops);
+  }
+  else{
+    comp_t::template spmm<ord_t>(nnzSp, nSp, fSize, stress.memMB, stress.flops);
+  }
+  stress.times = timeKernel([&](){
+      kokkosapp::updateStress(dt, xSp_d, xVp_d, jacSp_d);
+    }, warmup, reps);
+  results.push_back(stress);
+
+  // same copies done in runFom and observer: device to host mirror,
+  // then into the column of the snapshot matrix
+  if (numSnaps > 0){
+    auto xVp_h = Kokkos::create_mirror_view(xVp_d);
+    Kokkos::View<sc_t***, Kokkos::LayoutLeft, Kokkos::HostSpace> snaps_h("snaps", nVp, numSnaps, fSize);
+    std::size_t col = 0;
+
+    BenchResult obs{"observerCopy", fSize, nVp};
+    // read+write for each copy, the mirror is not a copy on host backends
+    using mem_t = typename state_d_t::memory_space;
+    const double copies =
+      Kokkos::SpaceAccessibility<Kokkos::HostSpace, mem_t>::accessible ? 1. : 2.;
+    obs.memMB = copies*2.*nVp*fSize*sizeof(sc_t)/1024./1024.;
+    obs.times = timeKernel([&](){
+	Kokkos::deep_copy(xVp_h, xVp_d);
+	copyToSnapshotColumn(snaps_h, xVp_h, col);
+	col = (col+1) % numSnaps;
+      }, warmup, reps);
+    results.push_back(obs);
+  }
+}
+
+void benchRomGemv(const std::size_t numModes,
+		  const int warmup,
+		  const int reps,
+		  std::vector<BenchResult> & results)
+{
+  using types  = kokkosapp::rank1TypesRom;
+  using sc_t   = types::scalar_type;
+  using comp_t = Complexity<sc_t>;
+
+  typename types::rom_jac_d_type romJ_d("romJ", numModes, numModes);
+  typename types::state_d_type xVp_d("xVp", numModes);
+  typename types::state_d_type xSp_d("xSp", numModes);
+  Kokkos::deep_copy(romJ_d, static_cast<sc_t>(1e-3));
+  Kokkos::deep_copy(xSp_d, constants<sc_t>::one());
+
+  const char ct_N = 'N';
+  const sc_t dt = static_cast<sc_t>(1e-12);
+  BenchResult gemv{"romGemv", 1, numModes};
+  comp_t::gemv_beta_one(numModes, numModes, gemv.memMB, gemv.flops);
+  gemv.times = timeKernel([&](){
+      KokkosBlas::gemv(&ct_N, dt, romJ_d, xSp_d, constants<sc_t>::one(), xVp_d);
+    }, warmup, reps);
+  results.push_back(gemv);
+}
+
+struct BenchInfo
+{
+  std::size_t nr = {};
+  std::size_t nth = {};
+  std::size_t nVp = {};
+  std::size_t nSp = {};
+  int threads = {};
+  int reps = {};
+  double streamGBs = {};
+  double peakGFlops = {};
+};
+
+// fraction of the roofline bound min(peak, intensity*stream), 0 if unknown
+double rooflineFraction(const BenchResult & r, const BenchInfo & info)
+{
+  if (info.streamGBs <= 0.) return 0.;
+  const double intensity = r.flops/(r.memMB*1024.*1024.);
+  double bound = intensity*info.streamGBs;
+  if (info.peakGFlops > 0.) bound = std::min(bound, info.peakGFlops);
+  return bound > 0. ? r.flops/r.medianTime()/1e9/bound : 0.;
+}
+
+void writeCsv(const std::string & fileName,
+	      const std::vector<BenchResult> & results,
+	      const BenchInfo & info)
+{
+  std::ofstream os(fileName);
+  os << "kernel,nr,nth,nVp,nSp,fSize,rows,threads,reps,modelMB,modelFlops,"
+     << "flopsPerByte,minTime,medianTime,meanTime,maxGBs,medianGBs,medianGFlops,"
+     << "fractionOfStream,fractionOfRoofline\n";
+  os << std::setprecision(8);
+  for (const auto & r : results){
+    const double gb = r.memMB/1024.;
+    os << r.kernel << "," << info.nr << "," << info.nth << ","
+       << info.nVp << "," << info.nSp << "," << r.fSize << "," << r.rows << ","
+       << info.threads << "," << info.reps << ","
+       << r.memMB << "," << r.flops << "," << r.flops/(r.memMB*1024.*1024.) << ","
+       << r.minTime() << "," << r.medianTime() << "," << r.meanTime() << ","
+       << gb/r.minTime() << "," << gb/r.medianTime() << ","
+       << r.flops/r.medianTime()/1e9 << ","
+       << (info.streamGBs > 0. ? gb/r.medianTime()/info.streamGBs : 0.) << ","
+       << rooflineFraction(r, info) << "\n";
+  }
+}
+
+void writeJson(const std::string & fileName,
+	       const std::vector<BenchResult> & results,
+	       const BenchInfo & info)
+{
+  std::ofstream os(fileName);
+  os << std::setprecision(8);
+  os << "{\n  \"nr\": " << info.nr << ", \"nth\": " << info.nth
+     << ", \"nVp\": " << info.nVp << ", \"nSp\": " << info.nSp
+     << ", \"threads\": " << info.threads << ", \"reps\": " << info.reps
+     << ", \"executionSpace\": \"" << Kokkos::DefaultExecutionSpace::name() << "\""
+     << ", \"streamGBs\": " << info.streamGBs
+     << ", \"peakGFlops\": " << info.peakGFlops << ",\n  \"results\": [";
+  for (std::size_t i=0; i<results.size(); ++i){
+    const auto & r = results[i];
+    const double gb = r.memMB/1024.;
+    os << (i>0 ? ",\n    " : "\n    ")
+       << "{\"kernel\": \"" << r.kernel << "\", \"fSize\": " << r.fSize
+       << ", \"rows\": " << r.rows
+       << ", \"modelMB\": " << r.memMB << ", \"modelFlops\": " << r.flops
+       << ", \"flopsPerByte\": " << r.flops/(r.memMB*1024.*1024.)
+       << ", \"minTime\": " << r.minTime() << ", \"medianTime\": " << r.medianTime()
+       << ", \"meanTime\": " << r.meanTime()
+       << ", \"maxGBs\": " << gb/r.minTime() << ", \"medianGBs\": " << gb/r.medianTime()
+       << ", \"medianGFlops\": " << r.flops/r.medianTime()/1e9
+       << ", \"fractionOfRoofline\": " << rooflineFraction(r, info) << "}";
+  }
+  os << "\n  ]\n}\n";
+}
+
+int main(int argc, char *argv[])
+{
+  CLI::App app{"Benchmark the kernels of the time loop on a structured mesh generated in memory"};
+  app.allow_extras();
+
+  std::size_t nr = 200;
+  std::size_t nth = 800;
+  std::vector<std::size_t> fSizes = {1, 4, 8, 16};
+  std::size_t romModes = 256;
+  std::size_t numSnaps = 16;
+  int warmup = 10;
+  int reps = 100;
+  double streamGBs = 0.;
+  double peakGFlops = 0.;
+  std::string outFormat = "csv";
+  std::string outFile = {};
+
+  app.add_option("--nr", nr, "Number of grid points along r");
+  app.add_option("--nth", nth, "Number of grid points along theta");
+  app.add_option("--fsizes", fSizes, "Forcing sizes to sweep: 1 = rank-1, >1 = rank-2");
+  app.add_option("--rommodes", romModes, "Number of modes for the ROM gemv, 0 disables it");
+  app.add_option("--snaps", numSnaps, "Snapshot columns for the observer copy, 0 disables it");
+  app.add_option("--warmup", warmup, "Warmup runs for each kernel");
+  app.add_option("--reps", reps, "Timed repetitions for each kernel");
+  app.add_option("--stream", streamGBs, "Measured STREAM bandwidth in GB/s for roofline");
+  app.add_option("--peakgflops", peakGFlops, "Peak GFlops for roofline");
+  app.add_option("--outformat", outFormat, "Output format: csv/json");
+  app.add_option("--outfile", outFile, "Output file, default: shaw_bench.<outformat>");
+
+  CLI11_PARSE(app, argc, argv);
+  if (outFormat != "csv" and outFormat != "json"){
+    std::cout << "Invalid --outformat, must be csv or json" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (reps < 1 or warmup < 0){
+    std::cout << "Need --reps >= 1 and --warmup >= 0" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (outFile.empty()) outFile = "shaw_bench." + outFormat;
+
+  // extra args, e.g. --kokkos-threads, are passed to kokkos
+  Kokkos::initialize(argc, argv);
+  {
+    using types = kokkosapp::rank1Types;
+    using scalar_t = types::scalar_type;
+    using mesh_info_t = types::mesh_info_type;
+
+    // build operators once for all kernels
+    mesh_info_t meshInfo(StructuredMeshGenerator<scalar_t>(nr, nth));
+    BenchMaterialModel<scalar_t> material;
+    kokkosapp::ShWavePP<types> appObj(meshInfo, material);
+
+    BenchInfo info{nr, nth, meshInfo.getNumVpPts(), meshInfo.getNumSpPts(),
+		   Kokkos::DefaultExecutionSpace().concurrency(), reps, streamGBs, peakGFlops};
+
+    std::vector<BenchResult> results;
+    for (const auto fSize : fSizes){
+      if (fSize == 1){
+	benchFom<typename kokkosapp::rank1Types::state_d_type>(appObj, fSize, numSnaps,
+							       warmup, reps, results);
+      }
+      else if (fSize > 1){
+	benchFom<typename kokkosapp::rank2Types::state_d_type>(appObj, fSize, numSnaps,
+							       warmup, reps, results);
+      }
+    }
+    if (romModes > 0){
+      benchRomGemv(romModes, warmup, reps, results);
+    }
+
+    std::cout << std::endl;
+    for (const auto & r : results){
+      printf("%-16s fSize = %4zu  median(ms) = %10.5lf  GB/s = %8.2lf  GFlops = %8.3lf\n",
+	     r.kernel.c_str(), r.fSize, r.medianTime()*1000.,
+	     r.memMB/1024./r.medianTime(), r.flops/r.medianTime()/1e9);
+    }
+
+    if (outFormat == "csv"){
+      writeCsv(outFile, results, info);
+    }
+    else{
+      writeJson(outFile, results, info);
+    }
+    std::cout << "Results written to " << outFile << std::endl;
+  }
+  Kokkos::finalize();
+
+  return 0;
+}
@@ -0,0 +1,70 @@
+include(FindUnixCommands)
+
+set(OUTPUTS "snaps_vp_0 snaps_sp_0 seismogram_0 snaps_vp_1 snaps_sp_1 seismogram_1 snaps_vp_2 snaps_sp_2 seismogram_2")
+
+macro(run_fom ARGS)
+  execute_process(COMMAND ${BASH} -c "${CMD_FOM} ${ARGS}" RESULT_VARIABLE RES)
+  if(RES)
+    message(FATAL_ERROR "Fom run failed: ${ARGS}")
+  endif()
+endmacro()
+
+macro(compare_sample RID)
+  foreach(FF snaps_vp snaps_sp seismogram)
+    set(tol 1e-13)
+    if(${FF} MATCHES "snaps_sp")
+      set(tol 1e-10)
+    endif()
+
+    set(finalArg 1)
+    if(${FF} MATCHES "seismogram")
+      set(finalArg 0)
+    endif()
+
+    set(CMD "python compare.py ${FF}_${RID} ${FF}_${RID}_gold ${tol} ${finalArg}")
+    execute_process(COMMAND ${BASH} -c ${CMD} RESULT_VARIABLE RES)
+    if(RES)
+      message(FATAL_ERROR "Diff for ${FF}_${RID} is not clean")
+    endif()
+  endforeach()
+endmacro()
+
+# remove possibly existing outputs and checkpoints
+execute_process(COMMAND ${BASH} -c "rm -rf ${OUTPUTS} checkpoint_multi checkpoint_single")
+
+# 1. multi-forcing run writing checkpoints, results must not be affected
+run_fom("input.yaml")
+if(NOT EXISTS ${CMAKE_CURRENT_BINARY_DIR}/checkpoint_multi)
+  message(FATAL_ERROR "No checkpoint written")
+endif()
+foreach(RID 0 1 2)
+  compare_sample(${RID})
+endforeach()
+
+# 2. restart in the middle of the last sample: the first two are skipped
+execute_process(COMMAND ${BASH} -c "rm -rf ${OUTPUTS}")
+run_fom("input.yaml --restart checkpoint_multi")
+foreach(FF snaps_vp_0 snaps_vp_1 seismogram_0 seismogram_1)
+  if(EXISTS ${CMAKE_CURRENT_BINARY_DIR}/${FF})
+    message(FATAL_ERROR "${FF} was rerun after restart")
+  endif()
+endforeach()
+compare_sample(2)
+
+# 3. restart in the middle of the first and only sample
+execute_process(COMMAND ${BASH} -c "rm -rf ${OUTPUTS}")
+run_fom("input_single.yaml")
+execute_process(COMMAND ${BASH} -c "rm -rf ${OUTPUTS}")
+run_fom("input_single.yaml --restart checkpoint_single")
+compare_sample(0)
+
+# 4. an ensemble cannot resume from a checkpoint, the run must be rejected
+#    rather than restarting every sample from the first step
+execute_process(COMMAND ${BASH} -c "${CMD_FOM} input_ensemble.yaml --restart checkpoint_multi"
+  RESULT_VARIABLE RES ERROR_VARIABLE ERR OUTPUT_VARIABLE OUT)
+if(NOT RES)
+  message(FATAL_ERROR "Restart with ensembleSize > 1 was not rejected")
+endif()
+if(NOT "${OUT}${ERR}" MATCHES "not supported with ensembleSize > 1")
+  message(FATAL_ERROR "Restart with ensembleSize > 1 failed for another reason:\n${OUT}${ERR}")
+endif()
@@ -0,0 +1,48 @@
+include(FindUnixCommands)
+
+# remove possibly existing container and extracted files
+execute_process(COMMAND ${BASH} -c "rm -rf samples.shaw")
+execute_process(COMMAND ${BASH} -c "rm -rf snaps_vp_0 snaps_sp_0 seismogram_0")
+execute_process(COMMAND ${BASH} -c "rm -rf snaps_vp_1 snaps_sp_1 seismogram_1")
+execute_process(COMMAND ${BASH} -c "rm -rf snaps_vp_2 snaps_sp_2 seismogram_2")
+
+# first run the exe
+execute_process(COMMAND ${CMD_FOM} ${INPUT_FNAME} RESULT_VARIABLE CMD_RESULT)
+message(${CMD_RESULT})
+if(CMD_RESULT)
+  message(FATAL_ERROR "Fom run failed")
+endif()
+
+# no per-sample file is written next to the container
+if(EXISTS ${CMAKE_CURRENT_BINARY_DIR}/snaps_vp_0)
+  message(FATAL_ERROR "snaps_vp_0 written with io: container")
+endif()
+
+execute_process(COMMAND ${CMD_UNPACK} samples.shaw
+  RESULT_VARIABLE CMD_RESULT OUTPUT_VARIABLE CMD_OUTPUT)
+message(${CMD_OUTPUT})
+if(CMD_RESULT OR NOT CMD_OUTPUT MATCHES "PASS")
+  message(FATAL_ERROR "Reading the container failed")
+endif()
+
+set(FILES "snaps_vp;snaps_sp;seismogram")
+set(IDS 0 1 2)
+foreach(FF IN LISTS FILES)
+  foreach(RID IN LISTS IDS)
+    set(tol 1e-13)
+    if(${FF} MATCHES "snaps_sp")
+      set(tol 1e-10)
+    endif()
+
+    set(finalArg 1)
+    if(${FF} MATCHES "seismogram")
+      set(finalArg 0)
+    endif()
+
+    set(CMD "python compare.py ${FF}_${RID} ${FF}_${RID}_gold ${tol} ${finalArg}")
+    execute_process(COMMAND ${BASH} -c ${CMD} RESULT_VARIABLE RES)
+    if(RES)
+      message(FATAL_ERROR "Diff for ${FF} is not clean")
+    endif()
+  endforeach()
+endforeach()
@@ -0,0 +1,57 @@
+
+#include "./shared/all.hpp"
+
+// writes each matrix of the container to <name>_<sample> as the
+// multi-forcing run does, and checks the metadata and block reads
+int main(int argc, char *argv[])
+{
+  Kokkos::initialize (argc, argv);
+  {
+    using mat_t = Kokkos::View<double**, Kokkos::LayoutLeft, Kokkos::HostSpace>;
+    const std::string fileName = argv[1];
+    const SampleContainerReader container(fileName);
+
+    std::vector<bool> vb;
+    const std::vector<double> periods = {40., 45., 50.};
+    const auto & samples = container.viewSamples();
+    vb.push_back(samples.size() == periods.size());
+    for (std::size_t i=0; i<samples.size() and vb.back(); ++i){
+      vb.push_back(samples[i].sampleID == i);
+      vb.push_back(samples[i].period == periods[i]);
+      vb.push_back(samples[i].depth == 720. and samples[i].delay == 10.);
+      vb.push_back(samples[i].signal == "ricker");
+    }
+    vb.push_back(container.viewMatrices().size() == 3*periods.size());
+
+    for (const auto & m : container.viewMatrices())
+    {
+      mat_t M("M", 1, 1);
+      fillMatrixFromContainer(fileName, m.name, m.sampleID, M);
+
+      // a block crossing tile boundaries matches the whole matrix
+      const std::size_t r0 = m.rows/3, r1 = m.rows - 1;
+      const std::size_t c0 = 1, c1 = m.cols;
+      mat_t B("B", r1-r0, c1-c0);
+      container.readBlock(m, r0, r1, c0, c1, B.data(), B.extent(0));
+      for (std::size_t i=r0; i<r1; ++i){
+	for (std::size_t j=c0; j<c1; ++j){
+	  if (B(i-r0, j-c0) != M(i,j)) { vb.push_back(false); }
+	}
+      }
+
+      // the seismogram file has no extents
+      const bool writeExtents = m.name != "seismogram";
+      writeToFile(m.name + "_" + std::to_string(m.sampleID), M, false, writeExtents);
+    }
+
+    if (std::none_of(vb.begin(), vb.end(), std::logical_not<bool>())){
+      std::puts("PASS");
+    }
+    else{
+      std::puts("FAILED");
+    }
+  }
+  Kokkos::finalize();
+
+  return 0;
+}
@@ -0,0 +1,101 @@
+
+#include "./shared/all.hpp"
+#include "./kokkos/types.hpp"
+#include "./kokkos/shwavepp.hpp"
+#include "./kokkos/dry_run.hpp"
+
+double findBytes(const std::vector<std::pair<std::string, double>> & mem,
+		 const std::string & name)
+{
+  for (const auto & it : mem){
+    if (it.first == name) return it.second;
+  }
+  return -1.;
+}
+
+int main(int argc, char *argv[])
+{
+  Kokkos::initialize (argc, argv);
+  {
+    using types_t = kokkosapp::rank2Types;
+    using sc_t = typename types_t::scalar_type;
+    using parser_t = typename types_t::parser_type;
+    using mesh_info_t = typename types_t::mesh_info_type;
+    using ord_t = typename types_t::jacobian_ord_type;
+    using size_type = typename types_t::jacobian_d_type::size_type;
+
+    parser_t parser(argc, argv);
+    mesh_info_t meshInfo(parser.getMeshDir());
+    const auto mem = kokkosapp::dryRun<types_t>(parser, meshInfo);
+
+    std::vector<bool> vb;
+    vb.push_back(parser.dryRun());
+
+    // predictions must match what is actually allocated
+    auto matObj = createMaterialModel<sc_t>(parser, meshInfo);
+    kokkosapp::ShWavePP<types_t> appObj(meshInfo, *matObj);
+    const auto jVp = appObj.viewJacobianDevice(dofId::vp);
+    const auto jSp = appObj.viewJacobianDevice(dofId::sp);
+    const double jacBytes =
+      1.*(jVp.nnz() + jSp.nnz())*(sizeof(sc_t) + sizeof(ord_t))
+      + 1.*(jVp.graph.row_map.extent(0) + jSp.graph.row_map.extent(0))*sizeof(size_type);
+    vb.push_back(findBytes(mem, "jacobians") == jacBytes);
+
+    const auto fSize = parser.getForcingSize();
+    typename types_t::observer_type observer(meshInfo.getNumVpPts(),
+					     meshInfo.getNumSpPts(), parser, fSize);
+    const auto & Avp = observer.viewSnapshotMatrix(dofId::vp);
+    const auto & Asp = observer.viewSnapshotMatrix(dofId::sp);
+    vb.push_back(findBytes(mem, "observer") == 1.*(Avp.span() + Asp.span())*sizeof(sc_t));
+
+    typename types_t::seismogram_type seismo(parser, meshInfo, appObj, fSize);
+    vb.push_back(findBytes(mem, "seismogram") ==
+		 1.*parser.getSeismoReceiversAnglesDeg().size()*20*fSize*sizeof(sc_t));
+
+    // no rom in this input
+    vb.push_back(findBytes(mem, "romBasis") < 0.);
+
+    // 4 output buffers requested, but the memory budget only fits 2
+    {
+      char exeName[] = "dry_run";
+      char inputName[] = "input_async.yaml";
+      char dryRunArg[] = "--dry-run";
+      char * args[] = {exeName, inputName, dryRunArg};
+      parser_t asyncParser(3, args);
+      const auto asyncMem = kokkosapp::dryRun<types_t>(asyncParser, meshInfo);
+      vb.push_back(findBytes(asyncMem, "observer") == 2.*findBytes(mem, "observer"));
+      vb.push_back(findBytes(asyncMem, "seismogram") == 2.*findBytes(mem, "seismogram"));
+    }
+
+    // rank-1 ensemble of 2: one observer, seismogram and forcing per member
+    {
+      using r1_types_t = kokkosapp::rank1Types;
+      char exeName[] = "dry_run";
+      char inputName[] = "input_ensemble.yaml";
+      char dryRunArg[] = "--dry-run";
+      char * args[] = {exeName, inputName, dryRunArg};
+      parser_t r1Parser(3, args);
+      const auto r1Mem = kokkosapp::dryRun<r1_types_t>(r1Parser, meshInfo);
+
+      typename r1_types_t::observer_type r1Observer(meshInfo.getNumVpPts(),
+						    meshInfo.getNumSpPts(), r1Parser, 1);
+      const auto & r1Avp = r1Observer.viewSnapshotMatrix(dofId::vp);
+      const auto & r1Asp = r1Observer.viewSnapshotMatrix(dofId::sp);
+      vb.push_back(findBytes(r1Mem, "observer") == 2.*(r1Avp.span() + r1Asp.span())*sizeof(sc_t));
+      vb.push_back(findBytes(r1Mem, "seismogram") ==
+		   2.*r1Parser.getSeismoReceiversAnglesDeg().size()*20*sizeof(sc_t));
+      vb.push_back(findBytes(r1Mem, "forcing") ==
+		   2.*(r1Parser.getNumSteps() + meshInfo.getNumVpPts())*sizeof(sc_t));
+    }
+
+    if (std::none_of(vb.begin(), vb.end(), std::logical_not<bool>())){
+      std::puts("PASS");
+    }
+    else{
+      std::puts("FAILED");
+    }
+  }
+  Kokkos::finalize();
+
+  return 0;
+}
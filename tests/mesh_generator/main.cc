@@ -0,0 +1,80 @@
+
+#include "./shared/all.hpp"
+#include "./kokkos/types.hpp"
+#include "./kokkos/shwavepp.hpp"
+
+template <typename a_t, typename b_t>
+bool sameHostValues(const a_t & a, const b_t & b)
+{
+  auto a_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), a);
+  auto b_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), b);
+  if (a_h.span() != b_h.span()) return false;
+  for (std::size_t i=0; i<a_h.span(); ++i){
+    if (a_h.data()[i] != b_h.data()[i]) return false;
+  }
+  return true;
+}
+
+template <typename jac_t>
+bool sameJacobian(const jac_t & a, const jac_t & b)
+{
+  return sameHostValues(a.graph.row_map, b.graph.row_map)
+    and sameHostValues(a.graph.entries, b.graph.entries)
+    and sameHostValues(a.values, b.values);
+}
+
+int main(int argc, char *argv[])
+{
+  Kokkos::initialize (argc, argv);
+  {
+    std::string sentinel = "PASS";
+
+    using sc_t = typename kokkosapp::commonTypes::scalar_type;
+    using parser_t = typename kokkosapp::commonTypes::parser_type;
+    using mesh_info_t = typename kokkosapp::commonTypes::mesh_info_type;
+
+    parser_t parser(argc, argv);
+
+    // mesh read from file
+    mesh_info_t meshInfo(parser.getMeshDir());
+    auto matObj = createMaterialModel<sc_t>(parser, meshInfo);
+    kokkosapp::ShWavePP<kokkosapp::commonTypes> appObj(meshInfo, *matObj);
+
+    // same mesh generated in memory
+    StructuredMeshGenerator<sc_t> generator(meshInfo.getNumPtsAlongR(),
+					    meshInfo.getNumPtsAlongTheta());
+    mesh_info_t genMeshInfo(generator);
+    kokkosapp::ShWavePP<kokkosapp::commonTypes> genAppObj(genMeshInfo, *matObj);
+
+    std::vector<bool> vb;
+
+    // mesh info
+    vb.push_back(genMeshInfo.isGenerated() and !meshInfo.isGenerated());
+    vb.push_back(genMeshInfo.getNumVpPts() == meshInfo.getNumVpPts());
+    vb.push_back(genMeshInfo.getNumSpPts() == meshInfo.getNumSpPts());
+    vb.push_back(genMeshInfo.getAngularSpacing() == meshInfo.getAngularSpacing());
+    vb.push_back(genMeshInfo.getRadialSpacing() == meshInfo.getRadialSpacing());
+    vb.push_back(genMeshInfo.viewDomainBounds() == meshInfo.viewDomainBounds());
+
+    // graphs, coordinates and labels must be identical
+    vb.push_back(sameHostValues(genAppObj.viewVelocityGraphHost(), appObj.viewVelocityGraphHost()));
+    vb.push_back(sameHostValues(genAppObj.viewStressGraphHost(), appObj.viewStressGraphHost()));
+    vb.push_back(sameHostValues(genAppObj.viewCoordsHost(dofId::vp), appObj.viewCoordsHost(dofId::vp)));
+    vb.push_back(sameHostValues(genAppObj.viewCoordsHost(dofId::sp), appObj.viewCoordsHost(dofId::sp)));
+    vb.push_back(sameHostValues(genAppObj.viewLabelsHost(dofId::sp), appObj.viewLabelsHost(dofId::sp)));
+
+    // and so must the jacobians
+    vb.push_back(sameJacobian(genAppObj.viewJacobianDevice(dofId::vp), appObj.viewJacobianDevice(dofId::vp)));
+    vb.push_back(sameJacobian(genAppObj.viewJacobianDevice(dofId::sp), appObj.viewJacobianDevice(dofId::sp)));
+
+    if (std::none_of(vb.begin(), vb.end(), std::logical_not<bool>())){
+      std::puts(sentinel.c_str());
+    }
+    else{
+      std::puts("FAILED");
+    }
+  }
+  Kokkos::finalize();
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+
+#include "./shared/all.hpp"
+#include "./kokkos/types.hpp"
+#include "./kokkos/shwavepp.hpp"
+#include "./kokkos/fom_operator_autotune.hpp"
+
+template <typename state_t>
+void fillState(state_t x)
+{
+  auto x_h = Kokkos::create_mirror_view(x);
+  for (std::size_t i=0; i<x_h.span(); ++i){
+    x_h.data()[i] = std::sin(0.1*i) + 0.5;
+  }
+  Kokkos::deep_copy(x, x_h);
+}
+
+template <typename state_t>
+bool closeStates(const state_t a, const state_t b)
+{
+  auto a_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), a);
+  auto b_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), b);
+  for (std::size_t i=0; i<a_h.span(); ++i){
+    const auto va = a_h.data()[i];
+    const auto vb = b_h.data()[i];
+    if (std::abs(va-vb) > 1e-12*std::max(1., std::abs(vb))) return false;
+  }
+  return true;
+}
+
+// apply both jacobians with both backends, results must match
+template <typename state_t, typename app_t>
+bool backendsMatch(const app_t & appObj, const std::size_t fSize)
+{
+  using namespace kokkosapp;
+  const auto jacVp_d = appObj.viewJacobianDevice(dofId::vp);
+  const auto jacSp_d = appObj.viewJacobianDevice(dofId::sp);
+  const double alpha = 0.7;
+
+  auto xSp  = createTrialState<state_t>("xSp",  jacSp_d.numRows(), fSize);
+  auto xVp  = createTrialState<state_t>("xVp",  jacVp_d.numRows(), fSize);
+  auto yVp1 = createTrialState<state_t>("yVp1", jacVp_d.numRows(), fSize);
+  auto yVp2 = createTrialState<state_t>("yVp2", jacVp_d.numRows(), fSize);
+  auto ySp1 = createTrialState<state_t>("ySp1", jacSp_d.numRows(), fSize);
+  auto ySp2 = createTrialState<state_t>("ySp2", jacSp_d.numRows(), fSize);
+  fillState(xSp); fillState(xVp);
+  fillState(yVp1); fillState(yVp2);
+  fillState(ySp1); fillState(ySp2);
+
+  applyOperator(operatorBackendKind::kokkosSparse, alpha, jacVp_d, xSp, yVp1);
+  applyOperator(operatorBackendKind::crsFunctor,   alpha, jacVp_d, xSp, yVp2);
+  applyOperator(operatorBackendKind::kokkosSparse, alpha, jacSp_d, xVp, ySp1);
+  applyOperator(operatorBackendKind::crsFunctor,   alpha, jacSp_d, xVp, ySp2);
+  return closeStates(yVp1, yVp2) and closeStates(ySp1, ySp2);
+}
+
+// the shared-sparsity operator must reproduce the CRS products for
+// rank-1 and rank-2 states. This frees the CRS matrices, so it runs last
+template <typename state1_t, typename state2_t, typename app_t>
+bool sharedSparsityMatches(app_t & appObj)
+{
+  using namespace kokkosapp;
+  const auto jacVp_d = appObj.viewJacobianDevice(dofId::vp);
+  const auto jacSp_d = appObj.viewJacobianDevice(dofId::sp);
+  const auto nVp = jacVp_d.numRows();
+  const auto nSp = jacSp_d.numRows();
+  const double alpha = 0.7;
+
+  auto xSp1 = createTrialState<state1_t>("xSp1", nSp, 1);
+  auto xVp1 = createTrialState<state1_t>("xVp1", nVp, 1);
+  auto xSp2 = createTrialState<state2_t>("xSp2", nSp, 3);
+  auto xVp2 = createTrialState<state2_t>("xVp2", nVp, 3);
+  auto yVp1 = createTrialState<state1_t>("yVp1", nVp, 1);
+  auto ySp1 = createTrialState<state1_t>("ySp1", nSp, 1);
+  auto yVp2 = createTrialState<state2_t>("yVp2", nVp, 3);
+  auto ySp2 = createTrialState<state2_t>("ySp2", nSp, 3);
+  auto refVp1 = createTrialState<state1_t>("refVp1", nVp, 1);
+  auto refSp1 = createTrialState<state1_t>("refSp1", nSp, 1);
+  auto refVp2 = createTrialState<state2_t>("refVp2", nVp, 3);
+  auto refSp2 = createTrialState<state2_t>("refSp2", nSp, 3);
+  fillState(xSp1); fillState(xVp1); fillState(xSp2); fillState(xVp2);
+  fillState(yVp1); fillState(ySp1); fillState(yVp2); fillState(ySp2);
+  fillState(refVp1); fillState(refSp1); fillState(refVp2); fillState(refSp2);
+
+  applyOperator(operatorBackendKind::kokkosSparse, alpha, jacVp_d, xSp1, refVp1);
+  applyOperator(operatorBackendKind::kokkosSparse, alpha, jacSp_d, xVp1, refSp1);
+  applyOperator(operatorBackendKind::kokkosSparse, alpha, jacVp_d, xSp2, refVp2);
+  applyOperator(operatorBackendKind::kokkosSparse, alpha, jacSp_d, xVp2, refSp2);
+
+  appObj.setOperatorBackend(operatorBackendKind::sharedSparsity);
+  const auto backend = appObj.getOperatorBackend();
+  const auto opVp = appObj.viewOperatorDevice(dofId::vp);
+  const auto opSp = appObj.viewOperatorDevice(dofId::sp);
+  applyOperator(backend, alpha, opVp, xSp1, yVp1);
+  applyOperator(backend, alpha, opSp, xVp1, ySp1);
+  applyOperator(backend, alpha, opVp, xSp2, yVp2);
+  applyOperator(backend, alpha, opSp, xVp2, ySp2);
+
+  return closeStates(yVp1, refVp1) and closeStates(ySp1, refSp1)
+    and closeStates(yVp2, refVp2) and closeStates(ySp2, refSp2)
+    and appObj.getJacobianNNZ(dofId::vp) == jacVp_d.nnz()
+    and appObj.getJacobianNNZ(dofId::sp) == jacSp_d.nnz();
+}
+
+int main(int argc, char *argv[])
+{
+  Kokkos::initialize (argc, argv);
+  {
+    using sc_t = typename kokkosapp::commonTypes::scalar_type;
+    using parser_t = typename kokkosapp::commonTypes::parser_type;
+    using mesh_info_t = typename kokkosapp::commonTypes::mesh_info_type;
+    using state1_t = typename kokkosapp::rank1Types::state_d_type;
+    using state2_t = typename kokkosapp::rank2Types::state_d_type;
+
+    parser_t parser(argc, argv);
+    mesh_info_t meshInfo(parser.getMeshDir());
+    auto matObj = createMaterialModel<sc_t>(parser, meshInfo);
+    kokkosapp::ShWavePP<kokkosapp::commonTypes> appObj(meshInfo, *matObj);
+
+    std::vector<bool> vb;
+    vb.push_back(parser.autotuneOperatorBackend());
+    vb.push_back(parser.getAutotuneSteps() == 3);
+    vb.push_back(backendsMatch<state1_t>(appObj, 1));
+    vb.push_back(backendsMatch<state2_t>(appObj, 4));
+
+    // first call runs the trials and writes the cache,
+    // the second one must find the same decision in the cache
+    const std::string cacheFile = "test_backend_cache.txt";
+    std::remove(cacheFile.c_str());
+    const auto b1 = kokkosapp::autotuneOperatorBackend<state2_t>(appObj, 4, parser.getAutotuneSteps(), cacheFile);
+    const auto b2 = kokkosapp::autotuneOperatorBackend<state2_t>(appObj, 4, parser.getAutotuneSteps(), cacheFile);
+    vb.push_back(b1 == b2);
+    vb.push_back(b1 == operatorBackendKind::kokkosSparse or
+		 b1 == operatorBackendKind::crsFunctor);
+
+    std::ifstream cacheIn(cacheFile);
+    std::string line;
+    std::size_t numLines = 0;
+    while (std::getline(cacheIn, line)){ ++numLines; }
+    vb.push_back(numLines == 1);
+
+    appObj.setOperatorBackend(b1);
+    vb.push_back(appObj.getOperatorBackend() == b1);
+
+    vb.push_back(sharedSparsityMatches<state1_t, state2_t>(appObj));
+
+    if (std::none_of(vb.begin(), vb.end(), std::logical_not<bool>())){
+      std::puts("PASS");
+    }
+    else{
+      std::puts("FAILED");
+    }
+  }
+  Kokkos::finalize();
+
+  return 0;
+}
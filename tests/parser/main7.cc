@@ -0,0 +1,29 @@
+
+#include "./shared/all.hpp"
+#include "./kokkos/types.hpp"
+
+int main(int argc, char *argv[])
+{
+  Kokkos::initialize (argc, argv);
+  {
+    using parser_t = kokkosapp::commonTypes::parser_type;
+    parser_t parser(argc, argv);
+
+    std::vector<bool> vb;
+
+    // checkpoint
+    vb.push_back(parser.enableCheckpoint());
+    vb.push_back(parser.getCheckpointInterval() == 250);
+    vb.push_back(parser.getCheckpointFileName() == "myckp");
+    vb.push_back(parser.enableRestart());
+    vb.push_back(parser.getRestartFileName() == "myckp");
+
+    if (std::none_of(vb.begin(), vb.end(), std::logical_not<bool>()))
+      std::puts("PASS");
+    else
+      std::puts("FAIL");
+  }
+  Kokkos::finalize();
+
+  return 0;
+}
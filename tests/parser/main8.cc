@@ -0,0 +1,30 @@
+
+#include "./shared/all.hpp"
+#include "./kokkos/types.hpp"
+
+int main(int argc, char *argv[])
+{
+  Kokkos::initialize (argc, argv);
+  {
+    using parser_t = kokkosapp::commonTypes::parser_type;
+    parser_t parser(argc, argv);
+
+    std::vector<bool> vb;
+
+    // performance
+    vb.push_back(parser.enablePerfReport());
+    vb.push_back(parser.enableFencedTiming());
+    vb.push_back(parser.enableHardwareCounters());
+    vb.push_back(parser.getStreamBandwidth() == 85.5);
+    vb.push_back(parser.getPerfReportFileName() == "myperf.json");
+    vb.push_back(!parser.enableCheckpoint());
+
+    if (std::none_of(vb.begin(), vb.end(), std::logical_not<bool>()))
+      std::puts("PASS");
+    else
+      std::puts("FAIL");
+  }
+  Kokkos::finalize();
+
+  return 0;
+}
@@ -0,0 +1,28 @@
+
+#include "./shared/all.hpp"
+#include "./kokkos/types.hpp"
+
+int main(int argc, char *argv[])
+{
+  Kokkos::initialize (argc, argv);
+  {
+    using parser_t = kokkosapp::commonTypes::parser_type;
+    parser_t parser(argc, argv);
+
+    std::vector<bool> vb;
+
+    // forcingSize: auto enables rank-2 with size 1 until calibrated
+    vb.push_back(parser.multiForcing());
+    vb.push_back(parser.rank2Enabled());
+    vb.push_back(parser.autoForcingSize());
+    vb.push_back(parser.getForcingSize() == 1);
+
+    if (std::none_of(vb.begin(), vb.end(), std::logical_not<bool>()))
+      std::puts("PASS");
+    else
+      std::puts("FAIL");
+  }
+  Kokkos::finalize();
+
+  return 0;
+}
@@ -0,0 +1,33 @@
+import numpy as np
+import sys
+
+# the gold is a rank-2 file with 3 realizations stored one after
+# the other, the first file of the ragged run has the first 2
+# and the second file has the last one
+
+if __name__== "__main__":
+  print('Argument List:', str(sys.argv))
+
+  file0 = str(sys.argv[1])
+  file1 = str(sys.argv[2])
+  gold  = str(sys.argv[3])
+  tol   = float(sys.argv[4])
+  hasExtents = int(sys.argv[5])
+
+  skip = 1 if hasExtents else 0
+  d0 = np.loadtxt(file0, skiprows=skip)
+  d1 = np.loadtxt(file1, skiprows=skip)
+  dg = np.loadtxt(gold,  skiprows=skip)
+
+  nRows = dg.shape[0]//3
+  assert(d0.shape[0] == 2*nRows)
+  assert(d1.shape[0] == nRows)
+  assert(np.isnan(d0).all() == False)
+  assert(np.isnan(d1).all() == False)
+  assert(np.allclose(d0, dg[:2*nRows], atol=tol))
+  assert(np.allclose(d1, dg[2*nRows:], atol=tol))
+
+  if hasExtents:
+    assert(np.allclose(np.loadtxt(file0, max_rows=1), [nRows, d0.shape[1], 2]))
+    assert(np.allclose(np.loadtxt(file1, max_rows=1), [nRows, d1.shape[1]]))
+  print("All good")
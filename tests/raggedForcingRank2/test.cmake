@@ -0,0 +1,30 @@
+include(FindUnixCommands)
+
+# remove possibly existing snapshots
+execute_process(COMMAND ${BASH} -c "rm -rf snaps_vp_0 snaps_sp_0 seismogram_0 snaps_vp_1 snaps_sp_1 seismogram_1")
+
+# first run the exe: 3 samples with forcingSize 2 gives a set of 2 and a set of 1
+execute_process(COMMAND ${CMD_FOM} ${INPUT_FNAME} RESULT_VARIABLE CMD_RESULT)
+message(${CMD_RESULT})
+if(CMD_RESULT)
+  message(FATAL_ERROR "Fom run failed")
+endif()
+
+set(FILES "snaps_vp;snaps_sp;seismogram")
+foreach(FF IN LISTS FILES)
+  set(tol 1e-13)
+  if(${FF} MATCHES "snaps_sp")
+    set(tol 1e-10)
+  endif()
+
+  set(hasExtents 1)
+  if(${FF} MATCHES "seismogram")
+    set(hasExtents 0)
+  endif()
+
+  set(CMD "python compare_ragged.py ${FF}_0 ${FF}_1 ${FF}_gold ${tol} ${hasExtents}")
+  execute_process(COMMAND ${BASH} -c ${CMD} RESULT_VARIABLE RES)
+  if(RES)
+    message(FATAL_ERROR "Diff for ${FF} is not clean")
+  endif()
+endforeach()
@@ -0,0 +1,76 @@
+
+#include "./shared/all.hpp"
+#include "./kokkos/types.hpp"
+#include "./kokkos/shwavepp.hpp"
+#include <random>
+
+template <typename sc_t, typename gids_t, typename coords_t>
+std::size_t bruteForceClosest(const sc_t radius, const sc_t angle,
+			      const gids_t & gids, const coords_t & coords)
+{
+  std::size_t result = 0;
+  auto trialDistance = std::numeric_limits<sc_t>::max();
+  for (std::size_t iPt=0; iPt<gids.extent(0); ++iPt){
+    const auto ptGID = gids(iPt);
+    const auto d = computePolarDistance(1./coords(ptGID,1), coords(ptGID,0), radius, angle);
+    if (d <= trialDistance){
+      trialDistance = d;
+      result = ptGID;
+    }
+  }
+  return result;
+}
+
+int main(int argc, char *argv[])
+{
+  Kokkos::initialize (argc, argv);
+  {
+    std::string sentinel = "PASS";
+
+    using sc_t = typename kokkosapp::commonTypes::scalar_type;
+    using parser_t = typename kokkosapp::commonTypes::parser_type;
+    using mesh_info_t = typename kokkosapp::commonTypes::mesh_info_type;
+
+    parser_t parser(argc, argv);
+    mesh_info_t meshInfo(parser.getMeshDir());
+
+    auto matObj = createMaterialModel<sc_t>(parser, meshInfo);
+    kokkosapp::ShWavePP<kokkosapp::commonTypes> appObj(meshInfo, *matObj);
+
+    const auto & index = appObj.viewVelocitySpatialIndex();
+    const auto gids    = appObj.viewGidListHost(dofId::vp);
+    const auto coords  = appObj.viewCoordsHost(dofId::vp);
+
+    // grid points themselves and midpoints between consecutive
+    // points, the latter check that ties are resolved like the full scan
+    for (std::size_t i=0; i+1<gids.extent(0); ++i){
+      const sc_t r1 = 1./coords(i,1), th1 = coords(i,0);
+      const sc_t r2 = 1./coords(i+1,1), th2 = coords(i+1,0);
+      if (index.findClosestGid(r1, th1) != bruteForceClosest(r1, th1, gids, coords)){
+	sentinel = "FAIL";
+      }
+      const sc_t rm = 0.5*(r1+r2), thm = 0.5*(th1+th2);
+      if (index.findClosestGid(rm, thm) != bruteForceClosest(rm, thm, gids, coords)){
+	sentinel = "FAIL";
+      }
+    }
+
+    // random locations, including some slightly outside the domain
+    const auto bounds = meshInfo.viewDomainBounds();
+    std::mt19937 gen(3451);
+    std::uniform_real_distribution<sc_t> rDist(bounds[2]-1e5, bounds[3]+1e5);
+    std::uniform_real_distribution<sc_t> thDist(degToRad(bounds[0])-0.1, degToRad(bounds[1])+0.1);
+    for (int i=0; i<5000; ++i){
+      const auto r = rDist(gen);
+      const auto th = thDist(gen);
+      if (index.findClosestGid(r, th) != bruteForceClosest(r, th, gids, coords)){
+	sentinel = "FAIL";
+      }
+    }
+
+    std::puts(sentinel.c_str());
+  }
+  Kokkos::finalize();
+
+  return 0;
+}
@@ -0,0 +1,138 @@
+
+#include "./shared/all.hpp"
+#include <sstream>
+
+std::string readFile(const std::string & fileName)
+{
+  std::ifstream in(fileName);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+// what the ascii writers produced with operator<< and std::endl
+template <typename mat_t>
+std::string streamMatrix(const mat_t & A)
+{
+  std::ostringstream os;
+  os << A.extent(0) << " " << A.extent(1) << std::endl;
+  for (std::size_t i=0; i<A.extent(0); i++){
+    for (std::size_t j=0; j<A.extent(1); j++){
+      os << std::setprecision(dblFmt) << A(i,j) << " ";
+    }
+    os << std::endl;
+  }
+  return os.str();
+}
+
+template <typename mat_t>
+std::string stream3d(const mat_t & A)
+{
+  std::ostringstream os;
+  os << A.extent(0) << " " << A.extent(1) << " " << A.extent(2) << std::endl;
+  for (std::size_t k=0; k<A.extent(2); k++){
+    for (std::size_t i=0; i<A.extent(0); i++){
+      for (std::size_t j=0; j<A.extent(1); j++){
+	os << std::setprecision(dblFmt) << A(i,j,k) << " ";
+      }
+      os << std::endl;
+    }
+  }
+  return os.str();
+}
+
+template <typename vec_t>
+std::string streamVector(const vec_t & v)
+{
+  std::ostringstream os;
+  os << v.extent(0) << std::endl;
+  for (std::size_t i=0; i<v.extent(0); i++){
+    os << std::setprecision(dblFmt) << v(i) << " \n";
+  }
+  return os.str();
+}
+
+// values with short and long representations, signs and exponents
+double testValue(const std::size_t i)
+{
+  switch (i % 5){
+  case 0:  return 0.1*i;
+  case 1:  return -std::sin(0.37*i)*1e-7;
+  case 2:  return static_cast<double>(i);
+  case 3:  return std::exp(0.01*i)*1e12;
+  default: return 1./(i+1);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  Kokkos::initialize (argc, argv);
+  {
+    using mat_t = Kokkos::View<double**, Kokkos::LayoutLeft, Kokkos::HostSpace>;
+    using mat3_t = Kokkos::View<double***, Kokkos::LayoutLeft, Kokkos::HostSpace>;
+    using vec_t = Kokkos::View<double*, Kokkos::HostSpace>;
+
+    // more rows than a formatting block, so that threads share the work
+    mat_t A("A", 5000, 7);
+    mat3_t B("B", 3000, 3, 2);
+    vec_t v("v", 4001);
+    for (std::size_t k=0; k<A.span(); ++k){ A.data()[k] = testValue(k); }
+    for (std::size_t k=0; k<B.span(); ++k){ B.data()[k] = testValue(k+7); }
+    for (std::size_t k=0; k<v.span(); ++k){ v.data()[k] = testValue(k+3); }
+
+    std::vector<bool> vb;
+    for (const std::size_t numThreads : {1, 4})
+    {
+      setTextIoThreads(numThreads);
+      writeToFile("A.txt", A, false);
+      writeToFile("B.txt", B, false);
+      writeToFile("v.txt", v, false);
+      vb.push_back(readFile("A.txt") == streamMatrix(A));
+      vb.push_back(readFile("B.txt") == stream3d(B));
+      vb.push_back(readFile("v.txt") == streamVector(v));
+    }
+
+    // %.17g round-trips, so the values read back are identical
+    mat_t A2("A2", 1, 1);
+    fillMatrixFromAscii("A.txt", A2, true);
+    vec_t v2("v2", 1);
+    readAsciiVectorWithSize("v.txt", v2);
+    vb.push_back(A2.extent(0) == A.extent(0) and A2.extent(1) == A.extent(1));
+    vb.push_back(v2.extent(0) == v.extent(0));
+    for (std::size_t i=0; i<A.extent(0) and vb.back(); ++i){
+      for (std::size_t j=0; j<A.extent(1); ++j){
+	if (A2(i,j) != A(i,j)) { vb.push_back(false); break; }
+      }
+    }
+    for (std::size_t i=0; i<v.extent(0) and vb.back(); ++i){
+      if (v2(i) != v(i)) { vb.push_back(false); break; }
+    }
+
+    // one row per line: extra values are ignored, a short row throws
+    {
+      std::ofstream("rows.txt") << "2 2\n1 2 9\n3 4\n";
+      std::ofstream("short.txt") << "2 2\n1\n3 4\n";
+    }
+    mat_t R("R", 1, 1);
+    fillMatrixFromAscii("rows.txt", R, true);
+    vb.push_back(R(0,0) == 1. and R(0,1) == 2. and R(1,0) == 3. and R(1,1) == 4.);
+    bool threw = false;
+    try{
+      fillMatrixFromAscii("short.txt", R, true);
+    }
+    catch (const std::runtime_error &){
+      threw = true;
+    }
+    vb.push_back(threw);
+
+    if (std::none_of(vb.begin(), vb.end(), std::logical_not<bool>())){
+      std::puts("PASS");
+    }
+    else{
+      std::puts("FAILED");
+    }
+  }
+  Kokkos::finalize();
+
+  return 0;
+}